@@ -4,6 +4,7 @@
   cmake,
   pkg-config,
   wrapQtAppsHook,
+  zlib,
 }:
 stdenv.mkDerivation {
   pname = "Stacklook";
@@ -11,6 +12,6 @@ stdenv.mkDerivation {
 
   src = ./.;
 
-  buildInputs = [modif-kshark];
+  buildInputs = [modif-kshark zlib];
   nativeBuildInputs = [pkg-config cmake wrapQtAppsHook];
 }
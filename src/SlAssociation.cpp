@@ -0,0 +1,310 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlAssociation.cpp
+ * @brief   Defines collection of Stacklook-relevant events and their
+ *          association with kernel stack entries.
+*/
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+#include "libkshark-plugin.h"
+
+// Plugin
+#include "SlAssociation.hpp"
+#include "SlSelfTrace.h"
+
+// Static variables
+
+///
+/// @brief Entries associated by one task of a parallel association.
+static constexpr ssize_t ASSOCIATION_CHUNK = 1 << 16;
+
+// Static functions
+
+/**
+ * @brief Gets the PID of the task an entry belongs to, even if some plugin
+ * changed the entry's PID before.
+ *
+ * @param entry: entry whose task's PID we want
+ *
+ * @returns PID of the entry's task.
+ *
+ * @note Changed entries need libkshark to read their PID, which isn't
+ * thread-safe, i.e. it may only be called on the thread owning the stream.
+ */
+static int _owner_pid(const kshark_entry* entry) {
+    return (entry->visible & KS_PLUGIN_UNTOUCHED_MASK) ?
+        entry->pid :
+        // "Emergency get" if some plugins messed around with the entry before
+        kshark_get_pid(entry);
+}
+
+/**
+ * @brief Finds the `ftrace/kernel_stack` event entry of an entry whose
+ * task's PID is already known.
+ *
+ * @param kstack_owner: entry whose kernel stack trace we want to find
+ * @param owner_pid: PID of the task of the entry
+ * @param kstack_event_id: numerical id of the stream's kernel stack event
+ *
+ * @returns Pointer to the `ftrace/kernel_stack` event entry if it was
+ * found, nullptr otherwise.
+ */
+static const kshark_entry* _find_kstack_entry(const kshark_entry* kstack_owner,
+                                              int owner_pid,
+                                              int kstack_event_id) {
+    const kshark_entry* kstack_entry = kstack_owner;
+    bool is_kstack = (kstack_entry->event_id == kstack_event_id);
+    bool is_correct_task = (owner_pid == kstack_entry->pid);
+    
+    // This loop will usually stop either after one or two iterations.
+    // This will be the case unless some plugin aggressively reorders
+    // and changes innards of entries.
+    while (!(is_kstack && is_correct_task)) {
+        // Move onto next entry on the same CPU
+        // Kernelstack trace will be on the same CPU as the event
+        // directly after which it is made.
+        kstack_entry = kstack_entry->next;
+        if (kstack_entry == nullptr)
+            return nullptr;
+        // Update conditions
+        is_kstack = (kstack_entry->event_id == kstack_event_id);
+        is_correct_task = (owner_pid == kstack_entry->pid);
+    }
+
+    return kstack_entry;
+}
+
+/**
+ * @brief Stores kernel stack entry pointers to the field of a range of
+ * entries in the container and, if wanted, their user stack entries.
+ *
+ * @param dct: sorted data container of Stacklook-relevant entries
+ * @param begin: index of the first entry of the range
+ * @param end: index after the last entry of the range
+ * @param owner_pids: PIDs of the tasks of the container's entries, by
+ * container index, nullptr to read them from the entries
+ * @param kstack_event_id: numerical id of the stream's kernel stack event
+ * @param user_stacks: user stacks to fill in for the range, nullptr
+ * if they aren't wanted
+ *
+ * @returns True if any kernel stack entry was found, false otherwise.
+ *
+ * @note With PIDs given, no libkshark function is called, so ranges
+ * may be associated on any thread.
+ */
+static bool _associate_range(kshark_data_container* dct, ssize_t begin,
+                             ssize_t end, const int* owner_pids,
+                             int kstack_event_id, SlUserStacks* user_stacks) {
+    bool found_at_least_one = false;
+
+    for (ssize_t i = begin; i < end; ++i) {
+        kshark_data_field_int64* sl_relevant = dct->data[i];
+        const int owner_pid = (owner_pids != nullptr) ?
+            owner_pids[i] : _owner_pid(sl_relevant->entry);
+        const kshark_entry* kstack_entry = _find_kstack_entry(sl_relevant->entry,
+                                                              owner_pid,
+                                                              kstack_event_id);
+        if (kstack_entry != nullptr) {
+            sl_relevant->field = (int64_t)(kstack_entry);
+            found_at_least_one = true;
+
+            // The walk continues right where the kernel stack was found
+            if (user_stacks != nullptr) {
+                user_stacks->entries[i] = find_ustack_entry(kstack_entry,
+                                                            user_stacks->event_id);
+            }
+        }
+    }
+
+    return found_at_least_one;
+}
+
+// Global functions
+
+/**
+ * @brief Finds numerical ids of the events Stacklook works with and of
+ * the events to collect, e.g. those of the configuration's event registry.
+ *
+ * @param stream: KernelShark's data stream
+ * @param collected_events: full names of the events to collect, e.g.
+ * `sched/sched_switch`
+ *
+ * @returns Event ids, `-1` for events the stream doesn't have. Events
+ * to collect which the stream doesn't have are left out.
+ */
+SlEventIds find_event_ids(kshark_data_stream* stream,
+                          const std::vector<std::string>& collected_events) {
+    SlEventIds ids{
+        kshark_find_event_id(stream, "sched/sched_switch"),
+        kshark_find_event_id(stream, "sched/sched_waking"),
+        kshark_find_event_id(stream, "ftrace/kernel_stack"),
+        kshark_find_event_id(stream, "ftrace/user_stack"),
+        {}
+    };
+
+    for (const std::string& name : collected_events) {
+        const int event_id = kshark_find_event_id(stream, name.c_str());
+        if (event_id >= 0 && std::find(ids.collected.begin(), ids.collected.end(),
+                                       event_id) == ids.collected.end())
+            ids.collected.push_back(event_id);
+    }
+    return ids;
+}
+
+/**
+ * @brief Collects entries of the events to collect from loaded entries
+ * into a new container, the way the plugin's event handlers do during
+ * loading. Fields are set to `-1`, meaning that no kernel stack was
+ * associated yet.
+ *
+ * @param rows: loaded entries of a stream
+ * @param count: number of the entries
+ * @param ids: event ids of the stream
+ *
+ * @returns New container owned by the caller, nullptr if it couldn't be
+ * allocated.
+ */
+kshark_data_container* collect_events(kshark_entry** rows, size_t count,
+                                      const SlEventIds& ids) {
+    kshark_data_container* dct = kshark_init_data_container();
+    if (dct == nullptr)
+        return nullptr;
+
+    // Indexed by event id, so that each entry costs one array access
+    std::vector<bool> is_collected;
+    for (int event_id : ids.collected) {
+        if ((size_t)event_id >= is_collected.size())
+            is_collected.resize((size_t)event_id + 1, false);
+        is_collected[event_id] = true;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        kshark_entry* entry = rows[i];
+        if (entry->event_id >= 0 && (size_t)entry->event_id < is_collected.size()
+            && is_collected[entry->event_id])
+            kshark_data_container_append(dct, entry, (int64_t)-1);
+    }
+
+    return dct;
+}
+
+/**
+ * @brief Finds the `ftrace/kernel_stack` event entry if it was
+ * recorded in the trace and is directly after the event entry on
+ * the same CPU and belongs to the same task.
+ * 
+ * @param kstack_owner: entry whose kernel stack trace we want to find
+ * @param kstack_event_id: numerical id of the stream's kernel stack event
+ * 
+ * @returns Pointer to the `ftrace/kernel_stack` event entry if it was
+ * found, nullptr otherwise.
+ */
+const kshark_entry* find_kstack_entry(const kshark_entry* kstack_owner,
+                                      int kstack_event_id) {
+    if (kstack_owner == nullptr)
+        return nullptr;
+
+    return _find_kstack_entry(kstack_owner, _owner_pid(kstack_owner),
+                              kstack_event_id);
+}
+
+/**
+ * @brief Finds the `ftrace/user_stack` event entry recorded along with
+ * a kernel stack. The kernel writes the user stack of an event right after
+ * its kernel stack, so only the entry directly after the kernel stack on
+ * the same CPU is checked.
+ * 
+ * @param kstack_entry: kernel stack entry of an event
+ * @param ustack_event_id: numerical id of the stream's user stack event
+ * 
+ * @returns Pointer to the `ftrace/user_stack` event entry if it was
+ * found, nullptr otherwise.
+ */
+const kshark_entry* find_ustack_entry(const kshark_entry* kstack_entry,
+                                      int ustack_event_id) {
+    if (kstack_entry == nullptr || ustack_event_id < 0)
+        return nullptr;
+
+    const kshark_entry* ustack_entry = kstack_entry->next;
+    const bool is_ustack = ustack_entry != nullptr
+                           && ustack_entry->event_id == ustack_event_id
+                           && ustack_entry->pid == kstack_entry->pid;
+
+    return is_ustack ? ustack_entry : nullptr;
+}
+
+/**
+ * @brief Stores kernel stack entry pointers to the field of entries in
+ * the container. Entries without a kernel stack keep their field. User
+ * stacks, if wanted, are found in the same pass, as they directly follow
+ * kernel stacks.
+ * 
+ * @note The container gets sorted first, so that container indices
+ * of the entries stay the same afterwards and can be used by indices
+ * built over the container.
+ * 
+ * @note With a task group, large containers are split into chunks
+ * associated on the thread pool. PIDs of the entries' tasks are read
+ * on the calling thread before, as libkshark isn't thread-safe. The call
+ * still returns only once the group has no pending tasks. Chunks skipped
+ * because of cancellation keep their fields.
+ * 
+ * @param dct: data container of Stacklook-relevant entries
+ * @param kstack_event_id: numerical id of the stream's kernel stack event
+ * @param group: task group to run chunks in, nullptr to associate on the
+ * calling thread only
+ * @param user_stacks: user stacks to fill in, by container index, nullptr
+ * if they aren't wanted
+ * 
+ * @returns True if any kernel stack entry was found, false otherwise.
+ */
+bool associate_kstacks(kshark_data_container* dct, int kstack_event_id,
+                       SlTaskGroup* group, SlUserStacks* user_stacks) {
+    SL_TRACE_SCOPE("associate_kstacks");
+
+    if (user_stacks != nullptr)
+        user_stacks->entries.clear();
+
+    if (dct == nullptr || dct->size == 0)
+        return false;
+    
+    if (!dct->sorted)
+        kshark_data_container_sort(dct);
+
+    // Chunks fill disjoint parts, so it is sized up front
+    if (user_stacks != nullptr)
+        user_stacks->entries.assign((size_t)dct->size, nullptr);
+
+    if (group == nullptr || dct->size <= ASSOCIATION_CHUNK
+        || SlThreadPool::get_instance().size() < 2)
+        return _associate_range(dct, 0, dct->size, nullptr, kstack_event_id,
+                                user_stacks);
+
+    // Read here, chunks on other threads mustn't call into libkshark
+    std::vector<int> owner_pids((size_t)dct->size);
+    for (ssize_t i = 0; i < dct->size; ++i) {
+        owner_pids[i] = _owner_pid(dct->data[i]->entry);
+    }
+
+    std::atomic<bool> found_at_least_one{false};
+
+    for (ssize_t begin = 0; begin < dct->size; begin += ASSOCIATION_CHUNK) {
+        const ssize_t end = std::min(begin + ASSOCIATION_CHUNK, dct->size);
+        group->run([dct, begin, end, &owner_pids, kstack_event_id, user_stacks,
+                    &found_at_least_one]() {
+            if (_associate_range(dct, begin, end, owner_pids.data(),
+                                 kstack_event_id, user_stacks))
+                found_at_least_one.store(true, std::memory_order_relaxed);
+        });
+    }
+    group->wait();
+
+    return found_at_least_one.load(std::memory_order_relaxed);
+}
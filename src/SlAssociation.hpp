@@ -0,0 +1,76 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlAssociation.hpp
+ * @brief   Declares collection of Stacklook-relevant events and their
+ *          association with `ftrace/kernel_stack` entries and, if recorded,
+ *          `ftrace/user_stack` entries. Depends only on libkshark, so it
+ *          serves the plugin as well as headless tools.
+ *
+ * @note    Definitions in `SlAssociation.cpp`.
+*/
+
+#ifndef _SL_ASSOCIATION_HPP
+#define _SL_ASSOCIATION_HPP
+
+// C
+#include <stddef.h>
+
+// C++
+#include <string>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlThreadPool.hpp"
+
+/**
+ * @brief Numerical ids of the events Stacklook works with in a stream.
+ * An id is `-1` if the stream doesn't have the event.
+ */
+struct SlEventIds {
+    ///
+    /// @brief Numerical id of `sched/sched_switch`.
+    int sswitch;
+    ///
+    /// @brief Numerical id of `sched/sched_waking`.
+    int swaking;
+    ///
+    /// @brief Numerical id of `ftrace/kernel_stack`.
+    int kstack;
+    ///
+    /// @brief Numerical id of `ftrace/user_stack`.
+    int ustack;
+    /// @brief Numerical ids of the events to collect, only those the
+    /// stream has.
+    std::vector<int> collected;
+};
+
+/**
+ * @brief User stacks of collected events, associated in the same pass
+ * as their kernel stacks.
+ */
+struct SlUserStacks {
+    ///
+    /// @brief Numerical id of the stream's `ftrace/user_stack` event.
+    int event_id;
+    /// @brief User stack entry of each collected event, by container
+    /// index, nullptr if the event has none.
+    std::vector<const kshark_entry*> entries;
+};
+
+SlEventIds find_event_ids(kshark_data_stream* stream,
+                          const std::vector<std::string>& collected_events);
+kshark_data_container* collect_events(kshark_entry** rows, size_t count,
+                                      const SlEventIds& ids);
+const kshark_entry* find_kstack_entry(const kshark_entry* kstack_owner,
+                                      int kstack_event_id);
+const kshark_entry* find_ustack_entry(const kshark_entry* kstack_entry,
+                                      int ustack_event_id);
+bool associate_kstacks(kshark_data_container* dct, int kstack_event_id,
+                       SlTaskGroup* group = nullptr,
+                       SlUserStacks* user_stacks = nullptr);
+
+#endif
@@ -6,6 +6,9 @@
  *          buttons as well as plot object reactions to mouse events.
 */
 
+// C
+#include <stdlib.h>
+
 // C++
 #include <string>
 #include <array>
@@ -21,7 +24,9 @@
 #include "SlDetailedView.hpp"
 #include "SlButton.hpp"
 #include "SlConfig.hpp"
+#include "SlEventRegistry.hpp"
 #include "SlPrevState.hpp"
+#include "SlSelfTrace.h"
 
 // Usings
 ///
@@ -31,7 +36,24 @@ using top_3_stack_t = std::array<QString, 3>;
 // Static functions
 
 /**
- * @brief Adds text to a Stacklook button of a sched_switch event - text shows
+ * @brief Finds the descriptor of an entry's event in the event registry
+ * of its stream.
+ * 
+ * @param entry: entry whose event's descriptor to find
+ * 
+ * @returns Pointer to the descriptor, nullptr if the event isn't collected.
+*/
+static const SlEventDescriptor* _find_descriptor(const kshark_entry* entry) {
+    plugin_stacklook_ctx* ctx = __get_context(entry->stream_id);
+    if (ctx == nullptr || ctx->event_registry == nullptr)
+        return nullptr;
+
+    return ctx->event_registry->find(entry->event_id);
+}
+
+/**
+ * @brief Adds text to a Stacklook button of a sched_switch event, i.e. one
+ * whose specific info is decoded as prev_state - text shows
  * "(PREV_STATE)", where PREV_STATE is a letter representing what state the task
  * was in before it was switched. Text box with the new text is then also placed under
  * the always-present "STACK" text.
@@ -46,8 +68,8 @@ using top_3_stack_t = std::array<QString, 3>;
 static void _add_sched_switch_prev_state_text(const kshark_entry* event_entry,
                                               const KsPlot::TextBox& orig_text,
                                               const ksplot_point triangle_position) {
-    plugin_stacklook_ctx* ctx = __get_context(event_entry->stream_id);
-    if (event_entry->event_id == ctx->sswitch_event_id) {
+    const SlEventDescriptor* descriptor = _find_descriptor(event_entry);
+    if (descriptor != nullptr && descriptor->decoder == SlInfoDecoder::PREV_STATE) {
         // Get the state indicator
         const std::string prev_state_base = get_switch_prev_state(event_entry);
         const std::string prev_state = "(" + prev_state_base + ")";
@@ -76,37 +98,6 @@ static void _add_sched_switch_prev_state_text(const kshark_entry* event_entry,
     }
 }
 
-/**
- * @brief Gets text (specific info) to be displayed in the detailed window.
- * Has a dummy value if there is no specific info.
- * 
- * @param entry: which entry's specific info to get
- * 
- * @returns Const standard string with specific info or message informing
- * of there being no specific info.
- */
-static const std::string _get_specific_info(const kshark_entry* entry) {
-    static const std::string NO_MAP_VAL{"No specific info for event."};
-    
-    plugin_stacklook_ctx* ctx = __get_context(entry->stream_id);
-    const std::map<int32_t, const std::string> SPECIFIC_INFO_MAP{{
-        { ctx->sswitch_event_id, "Task was in state " },
-        { ctx->swaking_event_id, "Task has woken up." }
-    }};
-
-    const int32_t entry_event_id = kshark_get_event_id(entry);
-    const bool not_mapped = (SPECIFIC_INFO_MAP.count(entry_event_id) == 0);
-    
-    std::string spec_info{ (not_mapped) ?
-        NO_MAP_VAL : SPECIFIC_INFO_MAP.at(entry_event_id)};
-    
-    if (entry_event_id == ctx->sswitch_event_id) {
-        spec_info = spec_info.append(get_longer_prev_state(entry) + ".");
-    }
-
-    return spec_info;
-}
-
 /**
  * @brief Function which calculates (absolute value of) the area of a trigon using
  * the [shoelace formula](https://en.wikipedia.org/wiki/Shoelace_formula).
@@ -166,26 +157,41 @@ double SlTriangleButton::distance(int x, int y) const {
 
 /**
  * @brief Action on mouse double clicking on the plugin's plot object event.
- * Spawns a window with the info field of the next entry after the entry the
- * button is displayed above.
+ * Shows the info field of the next entry after the entry the button is
+ * displayed above in a tab of the inspector window. If a user stack was
+ * recorded along with the kernel stack, it is shown below it.
  * 
  * @note In the case of this plugin, the next entry always has to be an `ftrace/kernel_stack`
  * event entry, with the field being the kernel's stack trace. Otherwise, an error message
  * will be shown in the window instead.
 */
 void SlTriangleButton::_doubleClick() const {
+    SL_TRACE_SCOPE("open_detailed_view");
     constexpr const char error_msg[] = "ERROR: No info field found!";                          
     const char* window_labeltext = kshark_get_task(_event_entry);
     
-    const char* kstack_string_ptr = (_kstack_entry != nullptr) ?
+    // Info strings are allocated by KernelShark, freed once copied
+    char* kstack_string_ptr = (_kstack_entry != nullptr) ?
         kshark_get_info(_kstack_entry) : nullptr;
     
-    const char* window_text = (kstack_string_ptr != nullptr) ? 
-        kstack_string_ptr : error_msg;
-    const std::string specific_entry_info{_get_specific_info(_event_entry)};
+    std::string window_text{(kstack_string_ptr != nullptr) ? 
+        kstack_string_ptr : error_msg};
+
+    const kshark_entry* ustack_entry = get_ustack_entry(_kstack_entry);
+    char* ustack_string_ptr = (ustack_entry != nullptr) ?
+        kshark_get_info(ustack_entry) : nullptr;
+    if (kstack_string_ptr != nullptr && ustack_string_ptr != nullptr) {
+        window_text.append("\n").append(ustack_string_ptr);
+    }
+    free(kstack_string_ptr);
+    free(ustack_string_ptr);
 
-    auto new_view = new SlDetailedView(window_labeltext, specific_entry_info.c_str(), window_text);
-    new_view->show();
+    const std::string specific_entry_info{get_specific_info(_event_entry)};
+
+    SlDetailedView* inspector = get_detailed_view();
+    if (inspector != nullptr)
+        inspector->inspect(_event_entry, window_labeltext,
+                           specific_entry_info.c_str(), window_text.c_str());
 }
 
 /**
@@ -205,3 +211,22 @@ void SlTriangleButton::_draw(const KsPlot::Color&, float) const {
     _add_sched_switch_prev_state_text(_event_entry, _text, text_position);
 }
 
+// Global functions
+
+/**
+ * @brief Gets text (specific info) to be displayed in the detailed window,
+ * decoded as the descriptor of the entry's event says. Has a dummy value
+ * if there is no specific info.
+ * 
+ * @param entry: which entry's specific info to get
+ * 
+ * @returns Standard string with specific info or message informing
+ * of there being no specific info.
+ */
+std::string get_specific_info(const kshark_entry* entry) {
+    static const std::string NO_MAP_VAL{"No specific info for event."};
+    
+    const SlEventDescriptor* descriptor = _find_descriptor(entry);
+    return (descriptor == nullptr) ?
+        NO_MAP_VAL : decode_specific_info(*descriptor, entry);
+}
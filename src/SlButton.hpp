@@ -5,12 +5,17 @@
  * @brief   Declares a special plot object class holding components
  *          of the button and its mouse interaction reactions.
  * 
- * @note    Definitions in `SlButton.cpp`.
+ * @note    Definitions in `SlButton.cpp`, except for `make_sl_button`,
+ *          which is defined in `Stacklook.cpp`.
 */
 
 #ifndef _SL_BUTTON_HPP
 #define _SL_BUTTON_HPP
 
+// C++
+#include <string>
+#include <vector>
+
 // KernelShark
 #include "libkshark.h"
 #include "KsPlotTools.hpp"
@@ -79,4 +84,11 @@ private: // Functions
     void _draw(const KsPlot::Color&, float) const override;
 };
 
+// Global functions
+SlTriangleButton* make_sl_button(std::vector<const KsPlot::Graph*> graph,
+                                 std::vector<int> bin,
+                                 std::vector<kshark_data_field_int64*> data,
+                                 KsPlot::Color col, float size);
+std::string get_specific_info(const kshark_entry* entry);
+
 #endif
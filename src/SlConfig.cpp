@@ -9,27 +9,290 @@
 // C
 #include <stdint.h>
 
+// C++
+#include <algorithm>
+#include <atomic>
+#include <regex>
+
 // KernelShark
 #include "KsPlotTools.hpp"
 #include "libkshark.h"
 
 // Plugin
 #include "SlConfig.hpp"
+#include "SlKallsyms.hpp"
+#include "SlThreadPool.hpp"
+
+// Static variables
+
+///
+/// @brief Currently published configuration snapshot.
+/// @note libstdc++ guards it with a spin lock in the pointer rather than
+/// making it lock-free. Publishing is rare and readers take one snapshot
+/// per draw or button, so the lock is held for a reference count update
+/// at a time.
+static std::atomic<std::shared_ptr<const SlConfig>> current_config{
+    std::make_shared<const SlConfig>()};
+
+// Static functions
+
+/**
+ * @brief Converts a color to its JSON form, a `#rrggbb` string.
+ * 
+ * @param color: color to convert
+ * 
+ * @returns JSON value of the color.
+ */
+static QJsonValue _color_to_json(const KsPlot::Color& color) {
+    return QColor(color.r(), color.g(), color.b()).name();
+}
+
+/**
+ * @brief Converts a color from its JSON form.
+ * 
+ * @param value: JSON value of the color, a `#rrggbb` string
+ * @param fallback: color used if the value isn't a valid color
+ * 
+ * @returns The converted color.
+ */
+static KsPlot::Color _json_to_color(const QJsonValue& value,
+                                    const KsPlot::Color& fallback) {
+    const QColor color(value.toString());
+    if (!color.isValid())
+        return fallback;
+    return {(uint8_t)color.red(), (uint8_t)color.green(), (uint8_t)color.blue()};
+}
+
+/**
+ * @brief Finds the descriptor of an event by its name.
+ * 
+ * @param events: descriptors to search
+ * @param name: full name of the event
+ * 
+ * @returns Pointer to the descriptor, nullptr if the event isn't listed.
+ */
+static SlEventDescriptor* _find_event(events_meta_t& events,
+                                      const std::string& name) {
+    auto found = std::find_if(events.begin(), events.end(),
+        [&name](const SlEventDescriptor& event) { return event.name == name; });
+    return (found == events.end()) ? nullptr : &(*found);
+}
+
+/**
+ * @brief Merges a persisted event descriptor into descriptors. An unlisted
+ * event is listed, with its specific information being its info field
+ * unless the persisted descriptor says otherwise.
+ * 
+ * @param events: descriptors to merge into
+ * @param name: full name of the event
+ * @param value: persisted descriptor, either an object or, as in older
+ * files, only the enabled flag
+ */
+static void _merge_event(events_meta_t& events, const QString& name,
+                         const QJsonValue& value) {
+    const std::string event_name = name.trimmed().toStdString();
+    if (event_name.empty())
+        return;
+
+    SlEventDescriptor* descriptor = _find_event(events, event_name);
+    if (descriptor == nullptr) {
+        events.push_back({event_name, "", SlInfoDecoder::EVENT_INFO, true});
+        descriptor = &events.back();
+    }
+
+    if (value.isBool()) {
+        descriptor->enabled = value.toBool();
+        return;
+    }
+
+    const QJsonObject object = value.toObject();
+    descriptor->enabled = object.value("enabled").toBool(descriptor->enabled);
+    descriptor->label = object.value("label")
+        .toString(descriptor->label.c_str()).toStdString();
+    parse_info_decoder(object.value("decoder").toString().toStdString(),
+                       descriptor->decoder);
+}
 
 // Configuration object functions
 
 /**
- * @brief Get the configuration object as a read-only reference.
- * Utilizes Meyers singleton creation (static local variable), which
- * also ensures the same address when taking a pointer.
+ * @brief Publishes a configuration as the new current snapshot, with
+ * a generation one higher than the current one.
+ * 
+ * @param config: configuration to publish
+ * 
+ * @note Only the configuration window publishes, from the GUI thread.
+ */
+void SlConfig::_publish(SlConfig&& config) {
+    config._generation = current_config.load()->_generation + 1;
+    current_config.store(std::make_shared<const SlConfig>(std::move(config)));
+}
+
+/**
+ * @brief Gets the current configuration snapshot. Safe on any thread,
+ * the snapshot stays valid and unchanged for as long as it is held.
+ * 
+ * @returns Shared pointer to the current snapshot.
+ */
+std::shared_ptr<const SlConfig> SlConfig::get_snapshot()
+{ return current_config.load(); }
+
+/**
+ * @brief Gets the path of the persisted configuration file.
+ * 
+ * @returns `$XDG_CONFIG_HOME/stacklook/config.json`, with the usual
+ * fallback if the variable isn't set.
+ */
+QString SlConfig::persisted_path() {
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+        + "/stacklook/config.json";
+}
+
+/**
+ * @brief Publishes the persisted configuration. Values missing from
+ * the file keep their current ones, events missing from the list are
+ * listed.
+ * 
+ * @param error: output location for the description of a failure
  * 
- * @returns Const reference to the configuration object.
+ * @returns True if the file was read or doesn't exist, false otherwise.
  */
-SlConfig& SlConfig::get_instance() {
-    static SlConfig instance;
-    return instance;
+bool SlConfig::load_persisted(std::string& error) {
+    QFile file(persisted_path());
+    if (!file.exists())
+        return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString().toStdString();
+        return false;
+    }
+
+    QJsonParseError parse_error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(),
+                                                           &parse_error);
+    if (!document.isObject()) {
+        error = persisted_path().toStdString() + ": "
+                + parse_error.errorString().toStdString();
+        return false;
+    }
+    const QJsonObject root = document.object();
+
+    SlConfig cfg = *get_snapshot();
+    cfg._histo_entries_limit = root.value("histo_entries_limit")
+        .toInt(cfg._histo_entries_limit);
+    cfg._density_strip = root.value("density_strip").toBool(cfg._density_strip);
+    cfg._sampled_buttons = (uint32_t)std::max(0, root.value("sampled_buttons")
+        .toInt((int)cfg._sampled_buttons));
+    cfg._default_btn_col = _json_to_color(root.value("default_button_color"),
+                                          cfg._default_btn_col);
+    cfg._button_outline_col = _json_to_color(root.value("button_outline_color"),
+                                             cfg._button_outline_col);
+
+    const QJsonValue events = root.value("events");
+    if (events.isArray()) {
+        for (const QJsonValue& event : events.toArray()) {
+            _merge_event(cfg._events_meta,
+                         event.toObject().value("name").toString(), event);
+        }
+    } else {
+        const QJsonObject events_by_name = events.toObject();
+        for (auto it = events_by_name.begin(); it != events_by_name.end(); ++it) {
+            _merge_event(cfg._events_meta, it.key(), it.value());
+        }
+    }
+
+    const QJsonObject filter = root.value("stack_filter").toObject();
+    SlStackFilterSpec& spec = cfg._stack_filter;
+    spec.symbol_glob = filter.value("symbol_glob")
+        .toString(spec.symbol_glob.c_str()).toStdString();
+    spec.symbol_regex = filter.value("symbol_regex")
+        .toString(spec.symbol_regex.c_str()).toStdString();
+    spec.above_frame = filter.value("above_frame")
+        .toString(spec.above_frame.c_str()).toStdString();
+    spec.below_frame = filter.value("below_frame")
+        .toString(spec.below_frame.c_str()).toStdString();
+    spec.min_depth = (uint32_t)filter.value("min_depth").toInt((int)spec.min_depth);
+    try {
+        [[maybe_unused]] const std::regex test{spec.symbol_regex};
+    } catch (const std::regex_error&) {
+        spec.symbol_regex.clear();
+    }
+
+    cfg._worker_threads = (uint32_t)std::max(0, root.value("worker_threads")
+        .toInt((int)cfg._worker_threads));
+    cfg._inspector_entries = (uint32_t)std::max(1, root.value("inspector_entries")
+        .toInt((int)cfg._inspector_entries));
+    cfg._kallsyms_path = root.value("kallsyms_path")
+        .toString(cfg._kallsyms_path.c_str()).toStdString();
+
+    SlThreadPool::get_instance().resize(cfg._worker_threads);
+    _publish(std::move(cfg));
+    return true;
 }
 
+/**
+ * @brief Writes the current configuration to the persisted configuration
+ * file, creating its directory if needed.
+ * 
+ * @param error: output location for the description of a failure
+ * 
+ * @returns True if the file was written, false otherwise.
+ */
+bool SlConfig::save_persisted(std::string& error) {
+    const std::shared_ptr<const SlConfig> cfg = get_snapshot();
+
+    QJsonArray events;
+    for (const SlEventDescriptor& descriptor : cfg->_events_meta) {
+        QJsonObject event;
+        event["name"] = QString::fromStdString(descriptor.name);
+        event["label"] = QString::fromStdString(descriptor.label);
+        event["decoder"] = info_decoder_name(descriptor.decoder);
+        event["enabled"] = descriptor.enabled;
+        events.append(event);
+    }
+
+    QJsonObject filter;
+    filter["symbol_glob"] = QString::fromStdString(cfg->_stack_filter.symbol_glob);
+    filter["symbol_regex"] = QString::fromStdString(cfg->_stack_filter.symbol_regex);
+    filter["above_frame"] = QString::fromStdString(cfg->_stack_filter.above_frame);
+    filter["below_frame"] = QString::fromStdString(cfg->_stack_filter.below_frame);
+    filter["min_depth"] = (int)cfg->_stack_filter.min_depth;
+
+    QJsonObject root;
+    root["histo_entries_limit"] = cfg->_histo_entries_limit;
+    root["density_strip"] = cfg->_density_strip;
+    root["sampled_buttons"] = (int)cfg->_sampled_buttons;
+    root["default_button_color"] = _color_to_json(cfg->_default_btn_col);
+    root["button_outline_color"] = _color_to_json(cfg->_button_outline_col);
+    root["events"] = events;
+    root["stack_filter"] = filter;
+    root["worker_threads"] = (int)cfg->_worker_threads;
+    root["inspector_entries"] = (int)cfg->_inspector_entries;
+    root["kallsyms_path"] = QString::fromStdString(cfg->_kallsyms_path);
+
+    const QString path = persisted_path();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = path.toStdString() + ": " + file.errorString().toStdString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    if (!file.commit()) {
+        error = path.toStdString() + ": " + file.errorString().toStdString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the generation of the snapshot, which differs between
+ * snapshots published one after another.
+ * 
+ * @returns Generation of the snapshot.
+ */
+uint64_t SlConfig::get_generation() const
+{ return _generation; }
+
 /**
  * @brief Gets the currently set limit of entries in the histogram.
  * 
@@ -38,6 +301,24 @@ SlConfig& SlConfig::get_instance() {
 int32_t SlConfig::get_histo_limit() const
 { return _histo_entries_limit; }
 
+/**
+ * @brief Gets whether graphs with more entries than the limit get
+ * a density strip.
+ * 
+ * @returns True if the strip is drawn, false otherwise.
+ */
+bool SlConfig::get_density_strip() const
+{ return _density_strip; }
+
+/**
+ * @brief Gets how many sampled buttons graphs with more entries than
+ * the limit get at most.
+ * 
+ * @returns Maximal number of sampled buttons, `0` for none.
+ */
+uint32_t SlConfig::get_sampled_buttons() const
+{ return _sampled_buttons; }
+
 /**
  * @brief Gets the default color of Stacklook buttons.
  * Uses KernelShark's color type.
@@ -57,8 +338,8 @@ const KsPlot::Color SlConfig::get_button_outline_col() const
 { return _button_outline_col; }
 
 /**
- * @brief Gets const reference to the events meta of the configuration
- * object.
+ * @brief Gets const reference to the descriptors of collected events
+ * of the configuration object.
  *  
  * @returns Const reference to the events meta.
  */
@@ -66,19 +347,36 @@ const events_meta_t& SlConfig::get_events_meta() const
 { return _events_meta; }
 
 /**
- * @brief Returns whether an event is allowed to have a Stacklook)
- * button above itself.
+ * @brief Gets the criteria of the kernel stack filter.
  * 
- * @param entry: entry whose event type we want to check
+ * @returns Const reference to the stack filter specification.
+ */
+const SlStackFilterSpec& SlConfig::get_stack_filter() const
+{ return _stack_filter; }
+
+/**
+ * @brief Gets the number of workers of the shared thread pool.
  * 
- * @returns True if event is allowed, false otherwise.
-*/
-bool SlConfig::is_event_allowed(const kshark_entry* entry) const {
-    const std::string evt_name{kshark_get_event_name(entry)};
-    return (_events_meta.count(evt_name) == 0) ?
-        false
-        : _events_meta.at(evt_name);
-}
+ * @returns Number of workers, `0` meaning one per core.
+ */
+uint32_t SlConfig::get_worker_threads() const
+{ return _worker_threads; }
+
+/**
+ * @brief Gets how many kernel stacks the inspector window keeps.
+ * 
+ * @returns Number of kept stacks, at least one.
+ */
+uint32_t SlConfig::get_inspector_entries() const
+{ return _inspector_entries; }
+
+/**
+ * @brief Gets the path of the saved kernel symbol table.
+ * 
+ * @returns Path of the table, empty if none is configured.
+ */
+const std::string& SlConfig::get_kallsyms_path() const
+{ return _kallsyms_path; }
 
 // Window
 // Static functions
@@ -172,7 +470,8 @@ static void _setup_colorchange(QWidget* parent,
 /**
  * @brief Constructor for the configuration window.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It uses the main window pointer kept by 'SlConfig' and reads the
+ * current configuration snapshot.
  */
 SlConfigWindow::SlConfigWindow()
     : QWidget(SlConfig::main_w_ptr), // Configuration access here
@@ -182,6 +481,23 @@ SlConfigWindow::SlConfigWindow()
     _btn_outline_preview(this),
     _histo_label("Entries on histogram until Stacklook buttons appear: "),
     _histo_limit(this),
+    _density_strip("Above the limit, show where kernel stacks are", this),
+    _sampled_label("Above the limit, sampled buttons per graph at most: "),
+    _sampled_buttons(this),
+    _workers_label("Worker threads for parallel work: "),
+    _workers(this),
+    _inspector_label("Kernel stacks kept open in the stack window: "),
+    _inspector_entries(this),
+    _kallsyms_label("Kernel symbols for raw stack addresses: "),
+    _kallsyms_path(this),
+    _kallsyms_browse("Browse", this),
+    _new_event(this),
+    _add_event_button("Add event", this),
+    _filter_glob(this),
+    _filter_regex(this),
+    _filter_above(this),
+    _filter_below(this),
+    _filter_min_depth(this),
     _close_button("Close", this),
     _apply_button("Apply", this)
 {
@@ -189,11 +505,15 @@ SlConfigWindow::SlConfigWindow()
     // Set window flags to make header buttons
     setWindowFlags(Qt::Dialog | Qt::WindowMinimizeButtonHint
                    | Qt::WindowCloseButtonHint);
-    setMaximumHeight(300);
+    setMaximumHeight(500);
 
     setup_histo_section();
+    setup_workers_section();
+    setup_inspector_section();
+    setup_kallsyms_section();
     // Configuration access here
-    const SlConfig& cfg = SlConfig::get_instance();
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
 
     // Setup colors
     const KsPlot::Color curr_def_btn_col = cfg._default_btn_col;
@@ -213,6 +533,10 @@ SlConfigWindow::SlConfigWindow()
 
     // Events meta
     setup_events_meta_widget();
+    setup_add_event_section();
+
+    // Stack filter
+    setup_stack_filter_section();
 
     // Create the layout
     setup_layout();
@@ -222,7 +546,8 @@ SlConfigWindow::SlConfigWindow()
  * @brief Update the configuration object's values with the values
  * from the configuration window.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It publishes a new configuration snapshot, edited from a copy of
+ * the current one.
  */
 void SlConfigWindow::update_cfg() {
     // If changing the events meta was a success
@@ -231,8 +556,8 @@ void SlConfigWindow::update_cfg() {
     // For BOTH color changes
     int r, g, b;
     
-    // Configuration access here
-    SlConfig& cfg = SlConfig::get_instance();
+    // Changes go to a copy, published as a whole at the end
+    SlConfig cfg = *SlConfig::get_snapshot();
 
     _def_btn_col.getRgb(&r, &g, &b);
     cfg._default_btn_col = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
@@ -241,11 +566,45 @@ void SlConfigWindow::update_cfg() {
     cfg._button_outline_col = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
 
     cfg._histo_entries_limit = _histo_limit.value();
+    cfg._density_strip = _density_strip.isChecked();
+    cfg._sampled_buttons = (uint32_t)_sampled_buttons.value();
+
+    cfg._worker_threads = (uint32_t)_workers.value();
+    cfg._inspector_entries = (uint32_t)_inspector_entries.value();
+
+    // Stack filter, an invalid regular expression keeps the old one
+    bool stack_filter_change = true;
+    SlStackFilterSpec new_filter;
+    new_filter.symbol_glob = _filter_glob.text().trimmed().toStdString();
+    new_filter.symbol_regex = _filter_regex.text().trimmed().toStdString();
+    new_filter.above_frame = _filter_above.text().trimmed().toStdString();
+    new_filter.below_frame = _filter_below.text().trimmed().toStdString();
+    new_filter.min_depth = (uint32_t)_filter_min_depth.value();
+    try {
+        [[maybe_unused]] const std::regex test{new_filter.symbol_regex};
+    } catch (const std::regex_error&) {
+        new_filter.symbol_regex = cfg._stack_filter.symbol_regex;
+        stack_filter_change = false;
+    }
+    cfg._stack_filter = new_filter;
+
+    // Kernel symbol table, one which doesn't load keeps the old path
+    bool kallsyms_change = true;
+    std::string kallsyms_error;
+    const std::string new_kallsyms_path = _kallsyms_path.text().trimmed().toStdString();
+    if (new_kallsyms_path != cfg._kallsyms_path) {
+        SlKallsyms test;
+        if (new_kallsyms_path.empty() || test.load(new_kallsyms_path, kallsyms_error)) {
+            cfg._kallsyms_path = new_kallsyms_path;
+        } else {
+            kallsyms_change = false;
+        }
+    }
 
     // Dynamically added members need special handling 
-    const int SUPPORTED_EVENTS_COUNT = static_cast<int>(cfg.get_events_meta().size());
+    bool events_listed = false;
 
-    for (int i = 0; i < SUPPORTED_EVENTS_COUNT; ++i) {
+    for (int i = 0; i < _event_rows; ++i) {
         auto index_str = std::to_string(i);
         auto event_name = this->findChild<QLabel*>("evt_name_" + index_str);
         auto event_allowed = this->findChild<QCheckBox*>("evt_allowed_" + index_str);
@@ -254,25 +613,58 @@ void SlConfigWindow::update_cfg() {
             && event_allowed != nullptr
         ) {
             std::string event_name_str = event_name->text().toStdString();
-            allowed_t& is_allowed = cfg._events_meta.at(event_name_str);
-            is_allowed = event_allowed->isChecked();
+            SlEventDescriptor* descriptor = _find_event(cfg._events_meta,
+                                                        event_name_str);
+            if (descriptor != nullptr) {
+                descriptor->enabled = event_allowed->isChecked();
+            } else { // Newly listed event
+                cfg._events_meta.push_back({event_name_str, "",
+                                            SlInfoDecoder::EVENT_INFO,
+                                            event_allowed->isChecked()});
+                events_listed = true;
+            }
         } else { // Otherwise indicate that there was a failure
             events_meta_change = false;
         }
     }
 
+    SlThreadPool::get_instance().resize(cfg._worker_threads);
+    SlConfig::_publish(std::move(cfg));
+
+    std::string save_error;
+    const bool saved = SlConfig::save_persisted(save_error);
+
     // Display a dialog based on the success of the update process
-    const char* change_status = events_meta_change ?
+    const bool full_change = events_meta_change && stack_filter_change
+                             && kallsyms_change;
+    const char* change_status = full_change ?
         "Configuration change success" :
         "Configuration change fail";
-    const char* detailed_message = events_meta_change ?
-        "Configuration was successfully altered!" :
-        "Configuration alteration wasn't fully successful.\n"
-        "Changes to specific events weren't applied.\n"
-        "Other configuration changes were successfully changed.";
-        
+
+    QString message;
+    if (full_change) {
+        message = "Configuration was successfully altered!";
+    } else {
+        message = "Configuration alteration wasn't fully successful.\n";
+        if (!events_meta_change)
+            message += "Changes to specific events weren't applied.\n";
+        if (!stack_filter_change)
+            message += "Stack filter's regular expression is invalid and wasn't applied.\n";
+        if (!kallsyms_change)
+            message += "Kernel symbols couldn't be loaded and weren't applied:\n"
+                       + QString::fromStdString(kallsyms_error) + "\n";
+        message += "Other configuration changes were successfully changed.";
+    }
+    if (events_listed) {
+        message += "\nNewly listed events are collected once a trace is loaded again.";
+    }
+    if (!saved) {
+        message += "\nThe configuration couldn't be saved for next sessions:\n"
+                   + QString::fromStdString(save_error);
+    }
+
     auto info_dialog = new QMessageBox(QMessageBox::Information,
-                change_status, detailed_message,
+                change_status, message,
                 QMessageBox::StandardButton::Ok, this);
     info_dialog->show();
 }
@@ -282,20 +674,103 @@ void SlConfigWindow::update_cfg() {
  * Spinbox's limit values are also set. Also creates
  * aesthetic spacing. 
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It reads the current configuration snapshot.
  */
 void SlConfigWindow::setup_histo_section() {
     // Configuration access here
-    const SlConfig& cfg = SlConfig::get_instance();
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
 
     _histo_limit.setMinimum(0);
     _histo_limit.setMaximum(1'000'000'000);
     _histo_limit.setValue(cfg._histo_entries_limit);
+    _density_strip.setChecked(cfg._density_strip);
+
+    _sampled_buttons.setMinimum(0);
+    _sampled_buttons.setMaximum(1000);
+    _sampled_buttons.setSpecialValueText("None");
+    _sampled_buttons.setValue((int)cfg._sampled_buttons);
 
     _histo_label.setFixedHeight(32);
     _histo_layout.addWidget(&_histo_label);
     _histo_layout.addStretch();
     _histo_layout.addWidget(&_histo_limit);
+
+    _sampled_label.setFixedHeight(32);
+    _sampled_layout.addWidget(&_sampled_label);
+    _sampled_layout.addStretch();
+    _sampled_layout.addWidget(&_sampled_buttons);
+}
+
+/**
+ * @brief Sets up spinbox and explanation label for the number
+ * of worker threads. Zero is shown as one thread per core.
+ * 
+ * @note It reads the current configuration snapshot.
+ */
+void SlConfigWindow::setup_workers_section() {
+    // Configuration access here
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
+
+    _workers.setMinimum(0);
+    _workers.setMaximum(1024);
+    _workers.setSpecialValueText("One per core");
+    _workers.setValue((int)cfg._worker_threads);
+    _inspector_entries.setValue((int)cfg._inspector_entries);
+
+    _workers_label.setFixedHeight(32);
+    _workers_layout.addWidget(&_workers_label);
+    _workers_layout.addStretch();
+    _workers_layout.addWidget(&_workers);
+}
+
+/**
+ * @brief Sets up spinbox and explanation label for the number
+ * of kernel stacks the inspector window keeps.
+ * 
+ * @note It reads the current configuration snapshot.
+ */
+void SlConfigWindow::setup_inspector_section() {
+    // Configuration access here
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
+
+    _inspector_entries.setMinimum(1);
+    _inspector_entries.setMaximum(1000);
+    _inspector_entries.setValue((int)cfg._inspector_entries);
+
+    _inspector_label.setFixedHeight(32);
+    _inspector_layout.addWidget(&_inspector_label);
+    _inspector_layout.addStretch();
+    _inspector_layout.addWidget(&_inspector_entries);
+}
+
+/**
+ * @brief Sets up the input, browse button and explanation label for
+ * the path of a saved kernel symbol table.
+ * 
+ * @note It reads the current configuration snapshot.
+ */
+void SlConfigWindow::setup_kallsyms_section() {
+    // Configuration access here
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
+
+    _kallsyms_path.setPlaceholderText("saved /proc/kallsyms or System.map");
+    _kallsyms_path.setText(cfg._kallsyms_path.c_str());
+
+    connect(&_kallsyms_browse, &QPushButton::pressed, this, [this]() {
+        const QString path = QFileDialog::getOpenFileName(this,
+            "Choose kernel symbols", _kallsyms_path.text());
+        if (!path.isEmpty())
+            _kallsyms_path.setText(path);
+    });
+
+    _kallsyms_label.setFixedHeight(32);
+    _kallsyms_layout.addWidget(&_kallsyms_label);
+    _kallsyms_layout.addWidget(&_kallsyms_path);
+    _kallsyms_layout.addWidget(&_kallsyms_browse);
 }
 
 /**
@@ -304,11 +779,12 @@ void SlConfigWindow::setup_histo_section() {
  * e.g. setting object names to find them afterwards when getting their
  * values.
  * 
-* @note It is dependent on the configuration 'SlConfig' singleton.
+* @note It reads the current configuration snapshot.
  */
 void SlConfigWindow::setup_events_meta_widget() {
     // Configuration access here
-    const SlConfig& cfg = SlConfig::get_instance();
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
     
     // Create a header row, so that the user knows what is what
     QHBoxLayout* header_row = new QHBoxLayout{nullptr};
@@ -323,29 +799,123 @@ void SlConfigWindow::setup_events_meta_widget() {
     _events_meta_layout.addLayout(header_row);
 
     // Create controls for the events meta
-    const events_meta_t& evts_meta = cfg.get_events_meta();
-    // Supported entry index to differentiate object names
-    int i = 0;
-    
-    for (auto it = evts_meta.cbegin(); it != evts_meta.cend(); ++it) {
-        QHBoxLayout* row = new QHBoxLayout{nullptr};
-        QLabel* evt_name = new QLabel{this};
-        QCheckBox* evt_allowed = new QCheckBox{this};
+    for (const SlEventDescriptor& descriptor : cfg.get_events_meta()) {
+        add_event_row(descriptor);
+    }
+}
 
-        evt_name->setText(it->first.c_str());
-        // Necessary for finding these later
-        evt_name->setObjectName("evt_name_" + std::to_string(i));
+/**
+ * @brief Adds a row with an event's name and a checkbox whether it is
+ * allowed to the events meta section. Rows are numbered in their object
+ * names, so that they can be found afterwards.
+ * 
+ * @param descriptor: descriptor of the event
+ */
+void SlConfigWindow::add_event_row(const SlEventDescriptor& descriptor) {
+    QHBoxLayout* row = new QHBoxLayout{nullptr};
+    QLabel* evt_name = new QLabel{this};
+    QCheckBox* evt_allowed = new QCheckBox{this};
+
+    evt_name->setText(descriptor.name.c_str());
+    // Necessary for finding these later
+    evt_name->setObjectName("evt_name_" + std::to_string(_event_rows));
+
+    evt_allowed->setChecked(descriptor.enabled);
+    evt_allowed->setObjectName("evt_allowed_" + std::to_string(_event_rows));
+
+    row->addWidget(evt_name);
+    row->addStretch();
+    row->addWidget(evt_allowed);
+
+    _events_meta_layout.addLayout(row);
+    ++_event_rows;
+}
 
-        evt_allowed->setChecked(it->second);
-        evt_allowed->setObjectName("evt_allowed_" + std::to_string(i));
+/**
+ * @brief Removes all rows of the events meta section, header included.
+ */
+void SlConfigWindow::clear_events_meta_widget() {
+    while (QLayoutItem* item = _events_meta_layout.takeAt(0)) {
+        if (QLayout* row = item->layout()) {
+            while (QLayoutItem* row_item = row->takeAt(0)) {
+                delete row_item->widget();
+                delete row_item;
+            }
+        }
+        delete item;
+    }
+    _event_rows = 0;
+}
+
+/**
+ * @brief Sets up the input and button listing a new event. The event gets
+ * a row of its own, it is listed in the configuration once changes are
+ * applied.
+ */
+void SlConfigWindow::setup_add_event_section() {
+    _new_event.setPlaceholderText("e.g. block/block_rq_issue");
+
+    _add_event_layout.addWidget(&_new_event);
+    _add_event_layout.addWidget(&_add_event_button);
+
+    connect(&_add_event_button, &QPushButton::pressed, this, [this]() {
+        const QString name = _new_event.text().trimmed();
+        if (name.isEmpty())
+            return;
+
+        // Listed once only
+        for (int i = 0; i < _event_rows; ++i) {
+            auto event_name = this->findChild<QLabel*>("evt_name_" + std::to_string(i));
+            if (event_name != nullptr && event_name->text() == name)
+                return;
+        }
 
-        row->addWidget(evt_name);
-        row->addStretch();
-        row->addWidget(evt_allowed);
+        add_event_row({name.toStdString(), "", SlInfoDecoder::EVENT_INFO, true});
+        _new_event.clear();
+    });
+}
 
-        _events_meta_layout.addLayout(row);
-        ++i;
+/**
+ * @brief Sets up labels and inputs of the kernel stack filter criteria
+ * in a grid, one criterion per row.
+ * 
+ * @note It reads the current configuration snapshot.
+ */
+void SlConfigWindow::setup_stack_filter_section() {
+    // Configuration access here
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
+
+    QLabel* header = new QLabel{this};
+    header->setText("Show buttons only for kernel stacks with (empty = any):");
+    _stack_filter_layout.addWidget(header, 0, 0, 1, 2);
+
+    const std::pair<const char*, QWidget*> rows[] = {
+        {"Symbol matching glob:", &_filter_glob},
+        {"Symbol matching regular expression:", &_filter_regex},
+        {"Symbol above...", &_filter_above},
+        {"...symbol below:", &_filter_below},
+        {"Minimal depth:", &_filter_min_depth}
+    };
+    int row = 1;
+    for (const auto& [label_text, input] : rows) {
+        QLabel* label = new QLabel{this};
+        label->setText(label_text);
+        _stack_filter_layout.addWidget(label, row, 0);
+        _stack_filter_layout.addWidget(input, row, 1);
+        ++row;
     }
+
+    _filter_glob.setPlaceholderText("e.g. mutex_*");
+    _filter_regex.setPlaceholderText("e.g. ^(io|blk)_");
+    _filter_min_depth.setMinimum(0);
+    _filter_min_depth.setMaximum(1024);
+
+    _filter_glob.setText(cfg._stack_filter.symbol_glob.c_str());
+    _filter_regex.setText(cfg._stack_filter.symbol_regex.c_str());
+    _filter_above.setText(cfg._stack_filter.above_frame.c_str());
+    _filter_below.setText(cfg._stack_filter.below_frame.c_str());
+    _filter_min_depth.setValue((int)cfg._stack_filter.min_depth);
 }
 
 /**
@@ -357,6 +927,11 @@ void SlConfigWindow::setup_layout() {
 
     // Add all control elements
     _layout.addLayout(&_histo_layout);
+    _layout.addWidget(&_density_strip);
+    _layout.addLayout(&_sampled_layout);
+    _layout.addLayout(&_workers_layout);
+    _layout.addLayout(&_inspector_layout);
+    _layout.addLayout(&_kallsyms_layout);
     _layout.addWidget(_get_hline(this));
     _layout.addStretch();
     _layout.addLayout(&_def_btn_col_ctl_layout);
@@ -364,6 +939,10 @@ void SlConfigWindow::setup_layout() {
     _layout.addWidget(_get_hline(this));
     _layout.addStretch();
     _layout.addLayout(&_events_meta_layout);
+    _layout.addLayout(&_add_event_layout);
+    _layout.addWidget(_get_hline(this));
+    _layout.addStretch();
+    _layout.addLayout(&_stack_filter_layout);
     _layout.addWidget(_get_hline(this));
     _layout.addStretch();
     _layout.addLayout(&_endstage_btns_layout);
@@ -390,14 +969,19 @@ void SlConfigWindow::setup_endstage() {
  * @brief Loads current configuration values into the configuration
  * window's control elements and inner values.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It reads the current configuration snapshot.
  */
 void SlConfigWindow::load_cfg_values() {
     // Configuration access here
-    const SlConfig& cfg = SlConfig::get_instance();
+    const std::shared_ptr<const SlConfig> snapshot = SlConfig::get_snapshot();
+    const SlConfig& cfg = *snapshot;
 
     // Setting of always-present members
     _histo_limit.setValue(cfg._histo_entries_limit);
+    _density_strip.setChecked(cfg._density_strip);
+    _sampled_buttons.setValue((int)cfg._sampled_buttons);
+    _workers.setValue((int)cfg._worker_threads);
+    _kallsyms_path.setText(cfg._kallsyms_path.c_str());
 
     _def_btn_col.setRgb(cfg._default_btn_col.r(),
                         cfg._default_btn_col.g(),
@@ -410,27 +994,15 @@ void SlConfigWindow::load_cfg_values() {
     _change_label_bg_color(&_btn_outline_preview,
                            &_btn_outline);
 
-    // Setting of dynamically added members - events meta
-    const int SUPPORTED_EVENTS_COUNT = static_cast<int>(cfg.get_events_meta().size());
-    const events_meta_t& cfg_evts_meta = cfg.get_events_meta();
-    // For loop to get all the event-specific objects
-    for (int i = 0; i < SUPPORTED_EVENTS_COUNT; ++i) {
-        auto index_str = std::to_string(i);
-        auto event_name = this->findChild<QLabel*>("evt_name_" + index_str);
-        auto event_allowed = this->findChild<QCheckBox*>("evt_allowed_" + index_str);
-        // If all went well, events meta elements were found and can be changed
-        if (event_name != nullptr
-            && event_allowed != nullptr
-        ) {
-            std::string event_name_str = event_name->text().toStdString();
-            const allowed_t is_allowed = cfg_evts_meta.at(event_name_str);
-            event_allowed->setChecked(is_allowed);
-        } else { // Otherwise, notify the user - this most likely won't happen though
-            auto info_dialog = new QMessageBox(QMessageBox::Warning,
-                "Events meta load failed",
-                "Events meta couldn't be loaded from the configuration.",
-                QMessageBox::StandardButton::Ok, this);
-            info_dialog->show();
-        }
-    }
+    _filter_glob.setText(cfg._stack_filter.symbol_glob.c_str());
+    _filter_regex.setText(cfg._stack_filter.symbol_regex.c_str());
+    _filter_above.setText(cfg._stack_filter.above_frame.c_str());
+    _filter_below.setText(cfg._stack_filter.below_frame.c_str());
+    _filter_min_depth.setValue((int)cfg._stack_filter.min_depth);
+
+    // Setting of dynamically added members - events meta. Rows are made
+    // anew, as unapplied rows of newly listed events must go.
+    clear_events_meta_widget();
+    setup_events_meta_widget();
+    _new_event.clear();
 }
@@ -13,7 +13,9 @@
 
 //C++
 #include <stdint.h>
-#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 // Qt
 #include <QtWidgets>
@@ -23,36 +25,42 @@
 #include "KsPlotTools.hpp"
 #include "KsMainWindow.hpp"
 
-// Usings
+// Plugin
+#include "SlEventRegistry.hpp"
+#include "SlStackFilter.hpp"
 
-/**
- * @brief Whether Stacklook buttons should show above event entries.
- */
-using allowed_t = bool;
+// Usings
 
 /**
- * @brief ID of the allowed events in string form.
+ * @brief Descriptors of the events Stacklook collects, in the order
+ * they were listed.
  */
-using event_name_t = std::string;
-
-using events_meta_t = std::map<event_name_t, allowed_t>;
+using events_meta_t = std::vector<SlEventDescriptor>;
 
 // For friending purposes :)
 class SlConfigWindow;
 
 // Class
 /**
- * @brief Singleton class for the config object of the plugin.
+ * @brief Configuration of the plugin, one immutable snapshot of it.
  * Holds values of: histogram limit until Stacklook buttons activate,
+ * whether a density strip is drawn in their place above the limit,
  * default color of Stacklook buttons, color of Stacklook buttons' outline,
  * if task colors should be used for buttons or not (modified KernelShark
- * feature only), and meta information about supported events - whether it's
- * allowed to show Stacklook buttons for them and how much offset from the
- * top of the kernel stack will the preview take into account when being
- * displayed.
+ * feature only), and descriptors of collected events - whether it's
+ * allowed to show Stacklook buttons for them, their labels and decoders
+ * of their specific information. Also holds the number of worker threads of the shared
+ * thread pool, how many stacks the inspector window keeps and the path of
+ * a saved kernel symbol table raw stack addresses are resolved with.
+ * 
+ * Configuration objects are immutable snapshots. Applying changes publishes
+ * a new snapshot with a higher generation through an atomic shared pointer,
+ * readers on any thread take the current one via `get_snapshot`. Older
+ * snapshots live for as long as someone holds them.
  * 
- * Uses sane defaults and is NOT persistent, i.e. settings won't be preserved
- * across different KernelShark sessions.
+ * Uses sane defaults, which are overriden by the configuration persisted
+ * in `$XDG_CONFIG_HOME/stacklook/config.json` when the GUI starts. Applied
+ * changes are persisted there.
 */
 class SlConfig {
 // Necessary for the config window to manipulate values in the config object.
@@ -66,6 +74,16 @@ private: // Data members
     /// histogram for the plugin to take effect.
     int32_t _histo_entries_limit{10000};
 
+    /// @brief Whether graphs with more entries than the limit get a strip
+    /// showing where events with kernel stacks are, instead of nothing.
+    /// Its first draw associates kernel stacks of the whole trace, which
+    /// the first zoomed-in draw would do anyway.
+    bool _density_strip{true};
+
+    /// @brief Most buttons drawn on a graph with more entries than the
+    /// limit, each for one sampled event, `0` for none.
+    uint32_t _sampled_buttons{0};
+
     ///
     /// @brief Default color of Stacklook buttons, white.
     KsPlot::Color _default_btn_col{0xFF, 0xFF, 0xFF};
@@ -75,24 +93,56 @@ private: // Data members
     KsPlot::Color _button_outline_col{0, 0, 0};
 
     /**
-     * @brief Map of event names keyed by their names with values:
-     * 
-     * 1) If Stacklook is allowed to show a button above the event's entry.
-     * 
-     * @note Hard-coded values imply a defined set of supported events.
+     * @brief Descriptors of the collected events - their names, labels,
+     * decoders of their specific information and whether Stacklook is
+     * allowed to show a button above their entries.
      * 
+     * @note The scheduling events are always listed, other features
+     * depend on them. Users list any other events followed by kernel
+     * stacks after them.
     */
     events_meta_t _events_meta{
-        {{"sched/sched_switch", true},
-         {"sched/sched_waking", false}}};
+        {"sched/sched_switch", "", SlInfoDecoder::PREV_STATE, true},
+        {"sched/sched_waking", "", SlInfoDecoder::WAKEUP, false}};
+
+    /// @brief Criteria kernel stacks must meet for their events to get
+    /// Stacklook buttons. Empty by default, i.e. nothing is filtered.
+    SlStackFilterSpec _stack_filter;
+
+    /// @brief Number of workers of the shared thread pool, `0` meaning
+    /// one per core.
+    uint32_t _worker_threads{0};
+
+    /// @brief Number of newest kernel stacks the inspector window keeps
+    /// tabs of.
+    uint32_t _inspector_entries{16};
+
+    /// @brief Path of a saved `/proc/kallsyms` or `System.map` resolving
+    /// raw addresses in kernel stacks. Empty by default, i.e. none.
+    std::string _kallsyms_path;
+
+    /// @brief Generation of the snapshot, increased by every publishing.
+    /// Defaults are generation `0`.
+    uint64_t _generation{0};
 
+private: // Functions
+    static void _publish(SlConfig&& config);
 public: // Functions
-    static SlConfig& get_instance();
+    static std::shared_ptr<const SlConfig> get_snapshot();
+    static QString persisted_path();
+    static bool load_persisted(std::string& error);
+    static bool save_persisted(std::string& error);
+    uint64_t get_generation() const;
     int32_t get_histo_limit() const;
+    bool get_density_strip() const;
+    uint32_t get_sampled_buttons() const;
     const KsPlot::Color get_default_btn_col() const; 
     const KsPlot::Color get_button_outline_col() const;
     const events_meta_t& get_events_meta() const;
-    bool is_event_allowed(const kshark_entry* entry) const;
+    const SlStackFilterSpec& get_stack_filter() const;
+    uint32_t get_worker_threads() const;
+    uint32_t get_inspector_entries() const;
+    const std::string& get_kallsyms_path() const;
 };
 
 /**
@@ -164,11 +214,108 @@ private: // Qt data members
     /// before Stacklook buttons show up.
     QSpinBox        _histo_limit;
 
+    /// @brief Checkbox toggling the density strip drawn above
+    /// the limit.
+    QCheckBox       _density_strip;
+
+    /// @brief Layout used for the spinbox and explanation
+    /// of what it does in the label.
+    QHBoxLayout     _sampled_layout;
+
+    ///
+    /// @brief Explanation of what the spinbox next to it does.
+    QLabel          _sampled_label;
+
+    /// @brief Spinbox used to change how many sampled buttons show
+    /// above the limit.
+    QSpinBox        _sampled_buttons;
+
+    // Worker threads
+
+    /// @brief Layout used for the spinbox and explanation
+    /// of what it does in the label.
+    QHBoxLayout     _workers_layout;
+
+    ///
+    /// @brief Explanation of what the spinbox next to it does.
+    QLabel          _workers_label;
+
+    /// @brief Spinbox used to change the number of worker threads,
+    /// zero meaning one per core.
+    QSpinBox        _workers;
+
+    // Inspector entries
+
+    /// @brief Layout used for the spinbox and explanation
+    /// of what it does in the label.
+    QHBoxLayout     _inspector_layout;
+
+    ///
+    /// @brief Explanation of what the spinbox next to it does.
+    QLabel          _inspector_label;
+
+    /// @brief Spinbox used to change how many kernel stacks the
+    /// inspector window keeps.
+    QSpinBox        _inspector_entries;
+
+    // Kernel symbol table
+
+    /// @brief Layout used for the path input, its browse button
+    /// and explanation of what it does in the label.
+    QHBoxLayout     _kallsyms_layout;
+
+    ///
+    /// @brief Explanation of what the input next to it does.
+    QLabel          _kallsyms_label;
+
+    /// @brief Path of a saved kernel symbol table, empty for none.
+    QLineEdit       _kallsyms_path;
+
+    /// @brief Button that invokes a file dialog for the user
+    /// to choose the kernel symbol table.
+    QPushButton     _kallsyms_browse;
+
     // Events meta
 
     /// @brief Layout used for the section of the config window
     /// which changes meta information of events in Stacklook's context.
     QVBoxLayout     _events_meta_layout;
+
+    ///
+    /// @brief Number of event rows in the events meta section.
+    int             _event_rows{0};
+
+    /// @brief Layout for the input and button listing a new event.
+    QHBoxLayout     _add_event_layout;
+
+    ///
+    /// @brief Name of an event to list, e.g. `block/block_rq_issue`.
+    QLineEdit       _new_event;
+
+    ///
+    /// @brief Adds the event in `_new_event` to the events meta rows.
+    QPushButton     _add_event_button;
+
+    // Stack filter
+
+    /// @brief Layout used for the labels and inputs of the
+    /// stack filter criteria.
+    QGridLayout     _stack_filter_layout;
+
+    /// @brief Glob which some frame's symbol must match.
+    QLineEdit       _filter_glob;
+
+    /// @brief Regular expression which some frame's symbol must match.
+    QLineEdit       _filter_regex;
+
+    /// @brief Symbol which must be above the one in `_filter_below`.
+    QLineEdit       _filter_above;
+
+    /// @brief Symbol which must be below the one in `_filter_above`.
+    QLineEdit       _filter_below;
+
+    /// @brief Minimal depth of a kernel stack.
+    QSpinBox        _filter_min_depth;
 public: // Qt data members
     ///
     /// @brief Close button for the widget.
@@ -180,7 +327,14 @@ public: // Qt data members
 private: // Qt functions
     void update_cfg();
     void setup_histo_section();
+    void setup_workers_section();
+    void setup_inspector_section();
+    void setup_kallsyms_section();
     void setup_events_meta_widget();
+    void add_event_row(const SlEventDescriptor& descriptor);
+    void clear_events_meta_widget();
+    void setup_add_event_section();
+    void setup_stack_filter_section();
     void setup_layout();
     void setup_endstage();
 public: // Functions
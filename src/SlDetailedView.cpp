@@ -2,24 +2,29 @@
 
 /**
  * @file    SlDetailedView.cpp
- * @brief   This file defines the class functionaliteis of the dialog windows
+ * @brief   This file defines the class functionaliteis of the inspector window
  *          shown by the Stacklook plugin. Includes some string manipulations
  *          of stack trace data as well.
 */
 
 // C++
+#include <algorithm>
 #include <string>
 #include <map>
 
 // Plugin headers
+#include "stacklook.h"
 #include "SlDetailedView.hpp"
+#include "SlButton.hpp"
 #include "SlConfig.hpp"
+#include "SlStreamIndex.hpp"
 
 // Static functions
 
 /**
  * @brief Replaces the top of the stack trace's text with an indicator that
- * the top is there.
+ * the top is there. The header of a user stack following the kernel stack
+ * is replaced with an indicator of user space.
  * 
  * @param data: stack trace from trace-cmd in its textual form
  * 
@@ -39,42 +44,100 @@ static QString _prettify_data(const char* data) {
     // Mark what's the top (just to make it clearer)
     std::string new_string = "(top)" + base_string.substr(first_newline);
 
+    // Mark where user space begins, if a user stack follows
+    const std::string USER_HEADER{"<user stack trace>"};
+    const size_t user_header = new_string.find(USER_HEADER);
+    if (user_header != std::string::npos) {
+        new_string.replace(user_header, USER_HEADER.size(), "(user space)");
+    }
+
     // Space for any other possible data prettifications here...
 
     // Return new QString (needs a C string to be constructed)
     return QString(new_string.c_str());
 }
 
-// Class functions
+// SlStackFrameModel
 
 /**
- * @brief Constructor for Stacklook's detailed stack trace view window.
+ * @brief Creates the model, splitting the text into lines.
  * 
- * @param task_name: name of the task whose stack trace is viewed
- * @param specific_info: specific info of a task
- * @param data: stack trace as text
+ * @param text: stack trace as text
+ * @param parent: parent Qt object, nullptr by default
+*/
+SlStackFrameModel::SlStackFrameModel(QString text, QObject* parent)
+  : QAbstractListModel(parent),
+    _text(std::move(text))
+{
+    int start = 0;
+    int newline;
+    while ((newline = _text.indexOf('\n', start)) != -1) {
+        _lines.emplace_back(start, newline - start);
+        start = newline + 1;
+    }
+    _lines.emplace_back(start, _text.size() - start);
+}
+
+/**
+ * @brief Gets the number of lines.
+ * 
+ * @param parent: parent index, valid ones have no rows in a list
+ * 
+ * @returns Number of lines.
+*/
+int SlStackFrameModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(_lines.size());
+}
+
+/**
+ * @brief Gets a line for display.
+ * 
+ * @param index: index of the line's row
+ * @param role: role of the data, only `Qt::DisplayRole` has any
+ * 
+ * @returns The line, or an invalid variant.
+*/
+QVariant SlStackFrameModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole
+        || index.row() >= static_cast<int>(_lines.size()))
+        return QVariant();
+
+    const std::pair<int, int>& line = _lines[index.row()];
+    return _text.mid(line.first, line.second);
+}
+
+/**
+ * @brief Gets the whole text of the stack trace.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @returns Const reference to the text.
 */
-SlDetailedView::SlDetailedView(const char* task_name, const char* specific_info,
-                               const char* data)
+const QString& SlStackFrameModel::text() const
+{ return _text; }
+
+// Class functions
+
+/**
+ * @brief Constructor for Stacklook's stack inspector window. It starts
+ * without any tabs.
+ * 
+ * @note It uses the main window pointer kept by 'SlConfig'.
+*/
+SlDetailedView::SlDetailedView()
   : QWidget(SlConfig::main_w_ptr), // Configuration access here
+    _tabs(this),
     _radio_btns(this),
     _raw_radio("Raw view", this),
     _list_radio("List view", this),
-    _which_task("Kernel stack for task '" + QString(task_name) + "':", this),
-    _specific_entry_info(specific_info, this),
+    _which_task(this),
+    _specific_entry_info(this),
     _stacked_widget(this),
     _list_view(this),
     _raw_view(this),
+    _prev_button("Previous with same stack", this),
+    _next_button("Next with same stack", this),
+    _nav_status(this),
     _close_button("Close", this)
 {
-    // Delete on close
-    setAttribute(Qt::WA_DeleteOnClose);
-
-    // Make the data a bit nicer
-    QString new_data = _prettify_data(data);
-
     setWindowTitle("Stacklook - Detailed Stack View");
     // Set window flags to make header buttons
     setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint
@@ -84,33 +147,52 @@ SlDetailedView::SlDetailedView(const char* task_name, const char* specific_info,
     // Change size to something reasonable
     resize(900, 450);
 
+    _tabs.setTabsClosable(true);
+    _tabs.setMovable(false);
+    _tabs.setExpanding(false);
+    _tabs.setElideMode(Qt::ElideRight);
+
     // Add control elements and set their defaults
     _radio_btns.addButton(&_raw_radio);
     _radio_btns.addButton(&_list_radio);
-    _raw_radio.setChecked(true);
+    _list_radio.setChecked(true);
 
     _raw_view.setReadOnly(true);
     _raw_view.setAcceptRichText(true);
-    _raw_view.setText(QString(new_data));
+
+    // Lines are laid out only when they scroll into view
+    _list_view.setUniformItemSizes(true);
 
     _stacked_widget.addWidget(&_raw_view);
     _stacked_widget.addWidget(&_list_view);
 
-    // Add stack trace to the list view as well
-    _list_view.addItems(new_data.split('\n'));
-
+    _layout.addWidget(&_tabs);
     _layout.addWidget(&_which_task);
     _layout.addWidget(&_specific_entry_info);
     _layout.addWidget(&_raw_radio);
     _layout.addWidget(&_list_radio);
 
+    _nav_layout.addWidget(&_prev_button);
+    _nav_layout.addWidget(&_next_button);
+    _nav_layout.addWidget(&_nav_status);
+    _nav_layout.addStretch();
+
     _layout.addWidget(&_stacked_widget);
+    _layout.addLayout(&_nav_layout);
     _layout.addWidget(&_close_button);
 
     // Connections
     connect(&_raw_radio, &QRadioButton::toggled, this, &SlDetailedView::_toggle_view);
     connect(&_list_radio, &QRadioButton::toggled, this, &SlDetailedView::_toggle_view);
 
+    connect(&_tabs, &QTabBar::currentChanged, this, &SlDetailedView::_show_tab);
+    connect(&_tabs, &QTabBar::tabCloseRequested, this, &SlDetailedView::_close_tab);
+
+    connect(&_prev_button, &QPushButton::pressed,
+            this, [this]() { step_same_stack(false); });
+    connect(&_next_button, &QPushButton::pressed,
+            this, [this]() { step_same_stack(true); });
+
     connect(&_close_button,	&QPushButton::pressed, this, &QWidget::close);
 
     // Set the layout to the prepared one
@@ -122,12 +204,203 @@ SlDetailedView::SlDetailedView(const char* task_name, const char* specific_info,
 
 /**
  * @brief Toggles which view is currently active in the widget based on
- * the radio buttons' checked states.
+ * the radio buttons' checked states. The raw view is filled only when
+ * it is shown and holds another stack trace.
 */
 void SlDetailedView::_toggle_view() {
     if (_raw_radio.isChecked()) {
+        const int tab = _tabs.currentIndex();
+        const SlStackFrameModel* frames = (tab >= 0) ?
+            _stacks[tab].frames.get() : nullptr;
+        if (_raw_shows != frames) {
+            _raw_view.setText(frames ? frames->text() : QString());
+            _raw_shows = frames;
+        }
         _stacked_widget.setCurrentWidget(&_raw_view);
     } else if (_list_radio.isChecked()) {
         _stacked_widget.setCurrentWidget(&_list_view);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Shows the stack of a tab in the shared widgets.
+ * 
+ * @param tab: index of the tab, -1 if there are no tabs
+*/
+void SlDetailedView::_show_tab(int tab) {
+    _nav_status.clear();
+    if (tab < 0 || tab >= static_cast<int>(_stacks.size())) {
+        _which_task.clear();
+        _specific_entry_info.clear();
+        _list_view.setModel(nullptr);
+    } else {
+        const SlInspectedStack& stack = _stacks[tab];
+        _which_task.setText("Kernel stack for task '" + stack.task_name + "':");
+        _specific_entry_info.setText(stack.specific_info);
+        _list_view.setModel(stack.frames.get());
+    }
+    _toggle_view();
+}
+
+/**
+ * @brief Closes a tab, forgetting its stack. The window is hidden once
+ * the last tab is closed.
+ * 
+ * @param tab: index of the tab
+*/
+void SlDetailedView::_close_tab(int tab) {
+    if (tab < 0 || tab >= static_cast<int>(_stacks.size()))
+        return;
+
+    // Views must not hold the model which might get destroyed
+    if (_list_view.model() == _stacks[tab].frames.get())
+        _list_view.setModel(nullptr);
+    if (_raw_shows == _stacks[tab].frames.get())
+        _raw_shows = nullptr;
+
+    _stacks.erase(_stacks.begin() + tab);
+    _tabs.removeTab(tab);
+
+    if (_stacks.empty())
+        hide();
+}
+
+/**
+ * @brief Closes the oldest tabs until at most the given number is left.
+ * 
+ * @param max_stacks: number of tabs to keep
+*/
+void SlDetailedView::_trim(size_t max_stacks) {
+    while (_stacks.size() > max_stacks) {
+        _close_tab(0);
+    }
+}
+
+/**
+ * @brief Sets the title and tooltip of a tab from its stack's event.
+ * 
+ * @param tab: index of the tab
+*/
+void SlDetailedView::_label_tab(int tab) {
+    const SlInspectedStack& stack = _stacks[tab];
+    _tabs.setTabText(tab, QString("%1 (%2)").arg(stack.task_name)
+                                            .arg(stack.pid));
+    _tabs.setTabToolTip(tab, QString("CPU %1, %2 ns").arg(stack.cpu)
+                                                      .arg(stack.ts));
+}
+
+/**
+ * @brief Shows the kernel stack of an event in its own tab. If the event
+ * of the same stream has a tab already, that one is switched to. Stacks
+ * of equal text share their lines. Oldest tabs are closed to keep the
+ * configured number of them.
+ * 
+ * @param event_entry: entry whose kernel stack is inspected
+ * @param task_name: name of the task whose stack trace is viewed
+ * @param specific_info: specific info of a task
+ * @param data: stack trace as text
+ * 
+ * @note It reads the current configuration snapshot.
+*/
+void SlDetailedView::inspect(const kshark_entry* event_entry,
+                             const char* task_name, const char* specific_info,
+                             const char* data) {
+    for (size_t i = 0; i < _stacks.size(); ++i) {
+        const SlInspectedStack& stack = _stacks[i];
+        if (stack.stream_id == event_entry->stream_id
+            && stack.ts == event_entry->ts && stack.cpu == event_entry->cpu
+            && stack.pid == event_entry->pid) {
+            _tabs.setCurrentIndex(static_cast<int>(i));
+            show();
+            raise();
+            return;
+        }
+    }
+
+    // Make the data a bit nicer
+    QString text = _prettify_data(data);
+
+    std::shared_ptr<SlStackFrameModel> frames;
+    for (const SlInspectedStack& stack : _stacks) {
+        if (stack.frames->text() == text) {
+            frames = stack.frames;
+            break;
+        }
+    }
+    if (!frames)
+        frames = std::make_shared<SlStackFrameModel>(std::move(text));
+
+    // Configuration access here
+    const size_t max_stacks = SlConfig::get_snapshot()->get_inspector_entries();
+    _trim(std::max<size_t>(max_stacks, 1) - 1);
+
+    _stacks.push_back({event_entry->stream_id, event_entry->ts,
+                       event_entry->cpu, event_entry->pid,
+                       QString(task_name), QString(specific_info),
+                       std::move(frames)});
+
+    const int tab = _tabs.addTab(QString());
+    _label_tab(tab);
+    _tabs.setCurrentIndex(tab);
+    // Switching to the first tab is no change for the tab bar
+    _show_tab(tab);
+
+    show();
+    raise();
+}
+
+/**
+ * @brief Moves the current tab to the previous or next event with the
+ * identical kernel stack and marks that event with marker A. Each move
+ * is a binary search in the stack's list of events in the stream's index.
+ * 
+ * @param forward: whether to move to the next event, otherwise to the
+ * previous one
+ * 
+ * @note It uses the main window pointer kept by 'SlConfig'.
+*/
+void SlDetailedView::step_same_stack(bool forward) {
+    const int tab = _tabs.currentIndex();
+    if (tab < 0)
+        return;
+
+    SlInspectedStack& stack = _stacks[tab];
+    const SlStreamIndex* index = get_stream_index(stack.stream_id);
+    if (index == nullptr) {
+        _nav_status.setText("The event's stream has no kernel stacks loaded.");
+        return;
+    }
+
+    const ssize_t event_idx = index->find_event(stack.ts, stack.cpu, stack.pid);
+    if (event_idx < 0) {
+        _nav_status.setText("The event is no longer loaded.");
+        return;
+    }
+
+    const ssize_t found = forward ? index->next_same_stack(event_idx) :
+                                    index->prev_same_stack(event_idx);
+    if (found < 0) {
+        _nav_status.setText(forward ? "No later event has this stack." :
+                                      "No earlier event has this stack.");
+        return;
+    }
+
+    kshark_entry* entry = index->events()->data[found]->entry;
+    // Configuration access here
+    SlConfig::main_w_ptr->markEntry(entry, DualMarkerState::A);
+
+    const char* task_name = kshark_get_task(entry);
+    stack.ts = entry->ts;
+    stack.cpu = entry->cpu;
+    stack.pid = entry->pid;
+    stack.task_name = QString(task_name ? task_name : "");
+    stack.specific_info = QString::fromStdString(get_specific_info(entry));
+    _label_tab(tab);
+    _show_tab(tab);
+
+    const std::span<const uint32_t> events = index->occurrences(index->stack_of(found));
+    const auto position = std::lower_bound(events.begin(), events.end(),
+                                           static_cast<uint32_t>(found));
+    _nav_status.setText(QString("Event %1 of %2 with this stack.")
+        .arg(position - events.begin() + 1).arg(events.size()));
+}
@@ -2,58 +2,131 @@
 
 /**
  * @file    SlDetailedView.hpp
- * @brief   This file declares a class for dialog windows with the full stack trace
+ * @brief   This file declares a class for the dialog window with full stack traces
  *          to be shown by the Stacklook plugin upon user's double click on a
  *          Stacklook button.
- * 
- * @note    Definitions in `SlDetailedView.cpp`.
+ *
+ * @note    Definitions in `SlDetailedView.cpp`, `get_detailed_view` is
+ *          defined in `Stacklook.cpp`.
 */
 
 #ifndef _SL_DETAILED_VIEW_HPP
 #define _SL_DETAILED_VIEW_HPP
 
 // C++
+#include <stdint.h>
+#include <deque>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Qt
 #include <QtWidgets>
 
 // KernelShark
+#include "libkshark.h"
 #include "KsMainWindow.hpp"
 
 // For friending
 class SlDetailedView;
 
 /**
- * @brief This type represents the windows the user can spawn to view
- * the stack trace of an event in full. Every window of this type will be
+ * @brief Read-only list model over the lines of a stack trace's text.
+ * The text is kept whole, rows are only offsets into it, so a deep stack
+ * costs one string and no per-row objects.
+*/
+class SlStackFrameModel : public QAbstractListModel {
+private: // Data members
+    ///
+    /// @brief Whole text of the stack trace.
+    QString _text;
+
+    ///
+    /// @brief Offset and length in the text of each line.
+    std::vector<std::pair<int, int>> _lines;
+public: // Functions
+    explicit SlStackFrameModel(QString text, QObject* parent = nullptr);
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+    const QString& text() const;
+};
+
+/**
+ * @brief Kernel stack of one event shown in the inspector.
+*/
+struct SlInspectedStack {
+    ///
+    /// @brief Stream of the event.
+    int stream_id;
+    ///
+    /// @brief Timestamp of the event, identifies it along with CPU and PID.
+    int64_t ts;
+    ///
+    /// @brief CPU of the event.
+    int16_t cpu;
+    ///
+    /// @brief PID of the event.
+    int32_t pid;
+    ///
+    /// @brief Name of the task whose stack trace is inspected.
+    QString task_name;
+    ///
+    /// @brief Information specific to the type of the event.
+    QString specific_info;
+    /// @brief Lines of the stack trace, shared with other inspected
+    /// stacks of the same text.
+    std::shared_ptr<SlStackFrameModel> frames;
+};
+
+/**
+ * @brief This type represents the window the user opens to view stack traces
+ * of events in full. Every inspected stack gets a tab, double-clicking
+ * a button of an event which has a tab already switches to it. Only the
+ * configured number of newest tabs is kept. A tab can move to the previous
+ * or next event with the identical stack, marking it with marker A. All
+ * tabs share one set of
+ * widgets and stacks of equal text share their lines. The window will be
  * dependent on the main KernelShark main window when it comes to program
  * termination (e.g. via clicking the X button).
- * 
+ *
  * It inherits from `QWidget`.
 */
 class SlDetailedView : public QWidget {
+private: // Data members
+    ///
+    /// @brief Inspected stacks, in the order of their tabs.
+    std::deque<SlInspectedStack> _stacks;
+
+    /// @brief Stack trace the raw view holds text of, nullptr if
+    /// it doesn't hold any.
+    const SlStackFrameModel* _raw_shows{nullptr};
 private: // Qt data members
     ///
     /// @brief Layout for the widget's control elements.
     QVBoxLayout     _layout;
 
+    ///
+    /// @brief Tabs of the inspected stacks.
+    QTabBar         _tabs;
+
     ///
     /// @brief Group for the radio buttons so they exclude each other.
     QButtonGroup    _radio_btns;
-    
+
     ///
     /// @brief Enables the raw view. Exclusive with `_list_radio`.
     QRadioButton    _raw_radio;
-    
+
     ///
     /// @brief Enables the list view. Exclusive with `_raw_radio`.
     QRadioButton    _list_radio;
-    
+
     ///
     /// @brief Name of the task whose stack trace we are viewing.
     QLabel          _which_task;
-    
+
     /// @brief Information specific to a type of an event.
     /// For example, sched_switch events will show their prev state.
     QLabel          _specific_entry_info;
@@ -61,23 +134,47 @@ private: // Qt data members
     ///
     /// @brief For toggling between views.
     QStackedWidget  _stacked_widget;
-    
+
     ///
     /// @brief View if the stack trace where items are in a list.
-    QListWidget     _list_view;
-    
-    ///
-    /// @brief Purely textual view if the stack trace.
+    QListView       _list_view;
+
+    /// @brief Purely textual view if the stack trace. Filled when
+    /// it is shown.
     QTextEdit       _raw_view;
+
+    /// @brief Layout for the buttons moving to other events with
+    /// the same stack.
+    QHBoxLayout     _nav_layout;
+
+    ///
+    /// @brief Moves to the previous event with the same stack.
+    QPushButton     _prev_button;
+
+    ///
+    /// @brief Moves to the next event with the same stack.
+    QPushButton     _next_button;
+
+    ///
+    /// @brief Result of the last move to another event.
+    QLabel          _nav_status;
 public: // Qt data members
     ///
     /// @brief Close button for the widget.
     QPushButton     _close_button;
 private: // Functions
     void _toggle_view();
+    void _show_tab(int tab);
+    void _close_tab(int tab);
+    void _trim(size_t max_stacks);
+    void _label_tab(int tab);
 public: // Functions
-    explicit SlDetailedView(const char* task_name, const char* specific_info,
-                            const char* data);
+    SlDetailedView();
+    void inspect(const kshark_entry* event_entry, const char* task_name,
+                 const char* specific_info, const char* data);
+    void step_same_stack(bool forward);
 };
 
-#endif
\ No newline at end of file
+SlDetailedView* get_detailed_view();
+
+#endif
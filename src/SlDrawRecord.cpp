@@ -0,0 +1,142 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlDrawRecord.cpp
+ * @brief   Defines recording of the plugin's draw calls and reading of
+ *          recordings.
+ *
+ *          A recording is a text file with a header line, then `stream`
+ *          lines with the trace file of a stream before its first call
+ *          and `draw` lines with the arguments of each call:
+ *
+ *              # Stacklook draw recording 1
+ *              stream SD PATH
+ *              draw SD VAL DRAW_ACTION MIN MAX N_BINS
+*/
+
+// C
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Plugin
+#include "SlDrawRecord.hpp"
+
+// Static variables
+
+///
+/// @brief First line of every recording, with the format's version.
+static const char* RECORDING_HEADER = "# Stacklook draw recording 1";
+
+// SlDrawRecorder
+
+/**
+ * @brief Creates the recording file, overwriting it, and writes its header.
+ *
+ * @param path: path of the recording file
+ */
+SlDrawRecorder::SlDrawRecorder(const std::string& path)
+    : _file(fopen(path.c_str(), "w")) {
+    if (_file == nullptr)
+        return;
+    setvbuf(_file, nullptr, _IOLBF, 0);
+    fprintf(_file, "%s\n", RECORDING_HEADER);
+}
+
+/**
+ * @brief Closes the recording file.
+ */
+SlDrawRecorder::~SlDrawRecorder() {
+    if (_file != nullptr)
+        fclose(_file);
+}
+
+/**
+ * @brief Checks whether the recording file could be created.
+ *
+ * @returns True if calls get recorded, false otherwise.
+ */
+bool SlDrawRecorder::is_open() const
+{ return _file != nullptr; }
+
+/**
+ * @brief Records a draw call. The trace file of the call's stream is
+ * written before the stream's first call.
+ *
+ * @param call: arguments of the call
+ * @param stream_file: trace file of the call's stream
+ */
+void SlDrawRecorder::record(const SlDrawCall& call, const char* stream_file) {
+    if (_file == nullptr)
+        return;
+
+    if (_known_streams.insert(call.sd).second)
+        fprintf(_file, "stream %" PRId32 " %s\n", call.sd,
+                (stream_file != nullptr) ? stream_file : "");
+
+    fprintf(_file, "draw %" PRId32 " %" PRId32 " %" PRId32 " %" PRId64
+            " %" PRId64 " %" PRId32 "\n", call.sd, call.val, call.draw_action,
+            call.min, call.max, call.n_bins);
+}
+
+// Global functions
+
+/**
+ * @brief Reads a recording of draw calls.
+ *
+ * @param path: path of the recording file
+ * @param recording: output location for the recording
+ * @param error: output location for the description of a failure
+ *
+ * @returns True if the whole recording was read, false otherwise.
+ */
+bool read_draw_recording(const std::string& path, SlDrawRecording& recording,
+                         std::string& error) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    recording = {};
+    char* line = nullptr;
+    size_t capacity = 0;
+    ssize_t length;
+    size_t line_no = 0;
+    bool ok = true;
+
+    while (ok && (length = getline(&line, &capacity, file)) != -1) {
+        ++line_no;
+        if (length > 0 && line[length - 1] == '\n')
+            line[--length] = '\0';
+
+        if (line_no == 1) {
+            ok = (strcmp(line, RECORDING_HEADER) == 0);
+            continue;
+        }
+
+        SlDrawCall call;
+        int path_start = 0;
+        if (sscanf(line, "draw %" SCNd32 " %" SCNd32 " %" SCNd32 " %" SCNd64
+                   " %" SCNd64 " %" SCNd32, &call.sd, &call.val,
+                   &call.draw_action, &call.min, &call.max, &call.n_bins) == 6) {
+            ok = recording.streams.count(call.sd) == 1;
+            recording.calls.push_back(call);
+        } else if (sscanf(line, "stream %" SCNd32 " %n", &call.sd, &path_start) == 1
+                   && path_start > 0) {
+            recording.streams[call.sd] = line + path_start;
+        } else {
+            ok = (length == 0);
+        }
+    }
+
+    free(line);
+    fclose(file);
+
+    if (!ok) {
+        error = path + ":" + std::to_string(line_no) + ": not a draw recording line";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlDrawRecord.hpp
+ * @brief   Declares recording of the plugin's draw calls into a text file
+ *          and reading them back, so that a session's zooming and panning
+ *          can be replayed headlessly by `stacklook-replay`.
+ *
+ * @note    Definitions in `SlDrawRecord.cpp`.
+*/
+
+#ifndef _SL_DRAW_RECORD_HPP
+#define _SL_DRAW_RECORD_HPP
+
+// C
+#include <stdint.h>
+#include <stdio.h>
+
+// C++
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Arguments of one call of the plugin's draw function.
+ */
+struct SlDrawCall {
+    ///
+    /// @brief Data stream identifier.
+    int32_t sd;
+    ///
+    /// @brief PID or CPU of the drawn graph.
+    int32_t val;
+    ///
+    /// @brief Draw action identifier, e.g. `KSHARK_TASK_DRAW`.
+    int32_t draw_action;
+    ///
+    /// @brief Start of the visible range.
+    int64_t min;
+    ///
+    /// @brief End of the visible range.
+    int64_t max;
+    ///
+    /// @brief Number of bins of the histogram.
+    int32_t n_bins;
+};
+
+/**
+ * @brief Recorded draw calls, along with the trace file of each stream.
+ */
+struct SlDrawRecording {
+    ///
+    /// @brief Trace file of each recorded stream.
+    std::map<int32_t, std::string> streams;
+    ///
+    /// @brief Draw calls in the order they were made.
+    std::vector<SlDrawCall> calls;
+};
+
+/**
+ * @brief Appends draw calls to a recording file as they are made. The
+ * file is line-buffered, so that a crashed session keeps its calls.
+ */
+class SlDrawRecorder {
+private: // Data members
+    ///
+    /// @brief Opened recording file, nullptr if opening failed.
+    FILE* _file;
+
+    ///
+    /// @brief Streams whose trace file is written already.
+    std::set<int32_t> _known_streams;
+public: // Functions
+    explicit SlDrawRecorder(const std::string& path);
+    ~SlDrawRecorder();
+    SlDrawRecorder(const SlDrawRecorder&) = delete;
+    SlDrawRecorder& operator=(const SlDrawRecorder&) = delete;
+
+    bool is_open() const;
+    void record(const SlDrawCall& call, const char* stream_file);
+};
+
+bool read_draw_recording(const std::string& path, SlDrawRecording& recording,
+                         std::string& error);
+
+#endif
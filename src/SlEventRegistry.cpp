@@ -0,0 +1,183 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlEventRegistry.cpp
+ * @brief   Defines event descriptors' decoders and the per-stream
+ *          registry of collected events.
+*/
+
+// C
+#include <stdlib.h>
+
+// C++
+#include <algorithm>
+#include <iterator>
+
+// Plugin
+#include "SlEventRegistry.hpp"
+#include "SlPrevState.hpp"
+
+// Static variables
+
+/**
+ * @brief Names of the decoders, as used in the configuration, in the
+ * order of `SlInfoDecoder`.
+ */
+static const char* const DECODER_NAMES[] = {
+    "none",
+    "prev_state",
+    "wakeup",
+    "event_info"
+};
+
+// SlEventRegistry
+
+/**
+ * @brief Resolves descriptors of events in a stream. Events the stream
+ * doesn't have are left out.
+ *
+ * @param stream: KernelShark's data stream
+ * @param events: descriptors of the events to collect
+ * @param generation: generation of the configuration the descriptors
+ * come from
+ */
+SlEventRegistry::SlEventRegistry(kshark_data_stream* stream,
+                                 const std::vector<SlEventDescriptor>& events,
+                                 uint64_t generation)
+    : _generation(generation) {
+    for (const SlEventDescriptor& descriptor : events) {
+        const int event_id = kshark_find_event_id(stream, descriptor.name.c_str());
+        if (event_id < 0)
+            continue;
+
+        if ((size_t)event_id >= _slots.size())
+            _slots.resize((size_t)event_id + 1, -1);
+        if (_slots[event_id] >= 0)
+            continue;
+
+        _slots[event_id] = (int32_t)_descriptors.size();
+        _descriptors.push_back(descriptor);
+        _event_ids.push_back(event_id);
+    }
+}
+
+/**
+ * @brief Takes labels, decoders and enabled flags of the resolved events
+ * from new descriptors. Resolved events missing from them get disabled.
+ *
+ * @param events: new descriptors of the events
+ * @param generation: generation of the configuration the descriptors
+ * come from
+ */
+void SlEventRegistry::update(const std::vector<SlEventDescriptor>& events,
+                             uint64_t generation) {
+    for (SlEventDescriptor& descriptor : _descriptors) {
+        auto found = std::find_if(events.begin(), events.end(),
+            [&descriptor](const SlEventDescriptor& event) {
+                return event.name == descriptor.name;
+            });
+
+        if (found == events.end()) {
+            descriptor.enabled = false;
+        } else {
+            descriptor = *found;
+        }
+    }
+    _generation = generation;
+}
+
+/**
+ * @brief Finds the descriptor of an event.
+ *
+ * @param event_id: numerical id of the event
+ *
+ * @returns Pointer to the descriptor, nullptr if the event isn't collected.
+ */
+const SlEventDescriptor* SlEventRegistry::find(int event_id) const {
+    if (event_id < 0 || (size_t)event_id >= _slots.size())
+        return nullptr;
+
+    const int32_t slot = _slots[event_id];
+    return (slot < 0) ? nullptr : &_descriptors[slot];
+}
+
+/**
+ * @brief Gets numerical ids of the collected events.
+ *
+ * @returns Const reference to the event ids.
+ */
+const std::vector<int>& SlEventRegistry::event_ids() const
+{ return _event_ids; }
+
+/**
+ * @brief Gets the generation of the configuration the descriptors
+ * come from.
+ *
+ * @returns Generation of the configuration.
+ */
+uint64_t SlEventRegistry::generation() const
+{ return _generation; }
+
+// Global functions
+
+/**
+ * @brief Gets the name of a decoder, as used in the configuration.
+ *
+ * @param decoder: decoder whose name to get
+ *
+ * @returns Name of the decoder.
+ */
+const char* info_decoder_name(SlInfoDecoder decoder)
+{ return DECODER_NAMES[(int)decoder]; }
+
+/**
+ * @brief Finds a decoder by its name.
+ *
+ * @param name: name of the decoder, as used in the configuration
+ * @param decoder: output location for the decoder
+ *
+ * @returns True if the name is known, false otherwise.
+ */
+bool parse_info_decoder(const std::string& name, SlInfoDecoder& decoder) {
+    for (size_t i = 0; i < std::size(DECODER_NAMES); ++i) {
+        if (name == DECODER_NAMES[i]) {
+            decoder = (SlInfoDecoder)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gets text with information specific to an event, to be shown
+ * in the stack window.
+ *
+ * @param descriptor: descriptor of the entry's event
+ * @param entry: entry whose information to decode
+ *
+ * @returns Decoded information, prefixed by the descriptor's label.
+ */
+std::string decode_specific_info(const SlEventDescriptor& descriptor,
+                                 const kshark_entry* entry) {
+    std::string info;
+    switch (descriptor.decoder) {
+    case SlInfoDecoder::PREV_STATE:
+        info = "Task was in state " + get_longer_prev_state(entry) + ".";
+        break;
+    case SlInfoDecoder::WAKEUP:
+        info = "Task has woken up.";
+        break;
+    case SlInfoDecoder::EVENT_INFO: {
+        // Allocated by KernelShark, copied and freed
+        char* event_info = kshark_get_info(entry);
+        info = (event_info != nullptr) ? event_info : "";
+        free(event_info);
+        break;
+    }
+    case SlInfoDecoder::NONE:
+        info = "No specific info for event.";
+        break;
+    }
+
+    return descriptor.label.empty() ? info : descriptor.label + ": " + info;
+}
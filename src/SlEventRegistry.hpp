@@ -0,0 +1,108 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlEventRegistry.hpp
+ * @brief   Declares descriptors of events Stacklook collects and shows
+ *          buttons for, along with the per-stream registry resolving
+ *          them by numerical event ids. Doesn't depend on Qt.
+ *
+ *          Any event followed by an `ftrace/kernel_stack` entry can be
+ *          described, e.g. `block/block_rq_issue` or `kmem/mm_page_alloc`.
+ *
+ * @note    Definitions in `SlEventRegistry.cpp`.
+*/
+
+#ifndef _SL_EVENT_REGISTRY_HPP
+#define _SL_EVENT_REGISTRY_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <string>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+/**
+ * @brief How information specific to an event is decoded for the stack
+ * window.
+ */
+enum class SlInfoDecoder {
+    ///
+    /// @brief No specific information.
+    NONE,
+    ///
+    /// @brief Prev_state of a `sched/sched_switch` event, also drawn
+    /// on its buttons.
+    PREV_STATE,
+    ///
+    /// @brief Notice that the task has woken up.
+    WAKEUP,
+    ///
+    /// @brief Info field of the event, i.e. its formatted fields.
+    EVENT_INFO
+};
+
+/**
+ * @brief Describes one event Stacklook collects.
+ */
+struct SlEventDescriptor {
+    ///
+    /// @brief Full name of the event, e.g. `sched/sched_switch`.
+    std::string name;
+    /// @brief Label put in front of the event's specific information,
+    /// empty for none.
+    std::string label;
+    ///
+    /// @brief Decoder of the event's specific information.
+    SlInfoDecoder decoder;
+    ///
+    /// @brief Whether Stacklook buttons show above the event's entries.
+    bool enabled;
+};
+
+/**
+ * @brief Descriptors of a stream's collected events, indexed by their
+ * numerical ids, so that the draw predicate resolves an entry's
+ * descriptor with one array access.
+ *
+ * The set of resolved events is fixed once it is built, as collection
+ * handlers are registered for exactly these events during loading.
+ * Updates change only labels, decoders and enabled flags.
+ */
+class SlEventRegistry {
+private: // Data members
+    ///
+    /// @brief Descriptors of the events found in the stream.
+    std::vector<SlEventDescriptor> _descriptors;
+
+    /// @brief Position in `_descriptors` of each event id, `-1` for
+    /// events which aren't collected.
+    std::vector<int32_t> _slots;
+
+    /// @brief Numerical ids of the events in `_descriptors`, in the
+    /// same order.
+    std::vector<int> _event_ids;
+
+    ///
+    /// @brief Generation of the configuration the descriptors come from.
+    uint64_t _generation{0};
+public: // Functions
+    SlEventRegistry(kshark_data_stream* stream,
+                    const std::vector<SlEventDescriptor>& events,
+                    uint64_t generation);
+    void update(const std::vector<SlEventDescriptor>& events,
+                uint64_t generation);
+    const SlEventDescriptor* find(int event_id) const;
+    const std::vector<int>& event_ids() const;
+    uint64_t generation() const;
+};
+
+const char* info_decoder_name(SlInfoDecoder decoder);
+bool parse_info_decoder(const std::string& name, SlInfoDecoder& decoder);
+std::string decode_specific_info(const SlEventDescriptor& descriptor,
+                                 const kshark_entry* entry);
+
+#endif
@@ -0,0 +1,176 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFlameGraph.cpp
+ * @brief   Defines the incrementally updated prefix tree of kernel stacks.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin
+#include "SlFlameGraph.hpp"
+
+// Class functions
+
+/**
+ * @brief Constructor of the flame graph's tree. It starts with an
+ * empty range.
+ *
+ * @param index: stream index whose stacks will be aggregated
+ */
+SlFlameGraph::SlFlameGraph(const SlStreamIndex* index)
+    : _index(index)
+{ clear(); }
+
+/**
+ * @brief Gets a child node of a node, creating it if it doesn't exist yet.
+ *
+ * @param parent: index of the parent node
+ * @param symbol: interned symbol of the child
+ *
+ * @returns Index of the child node.
+ */
+uint32_t SlFlameGraph::_child(uint32_t parent, uint32_t symbol) {
+    const uint64_t key = (uint64_t(parent) << 32) | symbol;
+    auto found = _children.find(key);
+    if (found != _children.end())
+        return found->second;
+
+    const uint32_t new_node = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back({symbol, parent, NO_NODE,
+                      _nodes[parent].first_child, 0});
+    _nodes[parent].first_child = new_node;
+    _children.emplace(key, new_node);
+    return new_node;
+}
+
+/**
+ * @brief Gets the node of a stack's top frame, inserting the whole stack
+ * into the tree if it wasn't there yet.
+ *
+ * @param stack_id: ID of an interned stack
+ *
+ * @returns Index of the stack's top node.
+ */
+uint32_t SlFlameGraph::_leaf_of(uint32_t stack_id) {
+    if (stack_id >= _stack_leaves.size())
+        _stack_leaves.resize(stack_id + 1, NO_NODE);
+
+    if (_stack_leaves[stack_id] == NO_NODE) {
+        std::span<const uint32_t> frames = _index->stacks().frames(stack_id);
+        uint32_t node = ROOT;
+        // Frames are top first, the tree grows from the bottom
+        for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+            node = _child(node, *frame);
+        }
+        _stack_leaves[stack_id] = node;
+    }
+
+    return _stack_leaves[stack_id];
+}
+
+/**
+ * @brief Sums changes of stack counts caused by events in a range of
+ * the index.
+ *
+ * @param begin: first event index of the range
+ * @param end: one past the last event index of the range
+ * @param sign: `1` if the events are entering the range, `-1` if leaving
+ * @param deltas: stack IDs mapped to their summed count changes
+ */
+void SlFlameGraph::_apply(ssize_t begin, ssize_t end, int64_t sign,
+                          std::unordered_map<uint32_t, int64_t>& deltas) const {
+    for (ssize_t i = begin; i < end; ++i) {
+        const uint32_t stack_id = _index->stack_of(i);
+        if (stack_id != SlStreamIndex::NO_STACK)
+            deltas[stack_id] += sign;
+    }
+}
+
+/**
+ * @brief Changes the range of aggregated events. Only events in the
+ * difference of the old and new range are visited, each distinct stack
+ * among them then walks its path to the root once.
+ *
+ * @param begin: first event index of the new range
+ * @param end: one past the last event index of the new range
+ */
+void SlFlameGraph::set_range(ssize_t begin, ssize_t end) {
+    begin = std::clamp<ssize_t>(begin, 0, _index->size());
+    end = std::clamp<ssize_t>(end, begin, _index->size());
+
+    std::unordered_map<uint32_t, int64_t> deltas;
+    if (end <= _begin || begin >= _end) {
+        // Disjoint ranges - drop the old one, add the new one
+        _apply(_begin, _end, -1, deltas);
+        _apply(begin, end, 1, deltas);
+    } else {
+        _apply(std::min(begin, _begin), std::max(begin, _begin),
+               (begin < _begin) ? 1 : -1, deltas);
+        _apply(std::min(end, _end), std::max(end, _end),
+               (end > _end) ? 1 : -1, deltas);
+    }
+
+    _begin = begin;
+    _end = end;
+
+    for (const auto& [stack_id, delta] : deltas) {
+        if (delta == 0)
+            continue;
+        for (uint32_t node = _leaf_of(stack_id); node != ROOT;
+             node = _nodes[node].parent) {
+            _nodes[node].count += delta;
+        }
+        _nodes[ROOT].count += delta;
+    }
+}
+
+/**
+ * @brief Changes the range of aggregated events to those whose timestamps
+ * lie in a closed interval.
+ *
+ * @param min_ts: lowest timestamp of the range
+ * @param max_ts: highest timestamp of the range
+ */
+void SlFlameGraph::set_time_range(int64_t min_ts, int64_t max_ts) {
+    set_range(_index->lower_bound(min_ts),
+              (max_ts == INT64_MAX) ? _index->size()
+                                    : _index->lower_bound(max_ts + 1));
+}
+
+/**
+ * @brief Removes all nodes and empties the range.
+ */
+void SlFlameGraph::clear() {
+    _nodes.clear();
+    _children.clear();
+    _stack_leaves.clear();
+    _nodes.push_back({0, NO_NODE, NO_NODE, NO_NODE, 0});
+    _begin = 0;
+    _end = 0;
+}
+
+/**
+ * @brief Gets the stream index the tree is built over.
+ *
+ * @returns Pointer to the index.
+ */
+const SlStreamIndex* SlFlameGraph::index() const
+{ return _index; }
+
+/**
+ * @brief Gets all nodes of the tree, root is at index `ROOT`.
+ *
+ * @returns Const reference to the nodes.
+ */
+const std::vector<SlFlameNode>& SlFlameGraph::nodes() const
+{ return _nodes; }
+
+/**
+ * @brief Gets the number of stacks in the current range.
+ *
+ * @returns Count of the root node.
+ */
+int64_t SlFlameGraph::total() const
+{ return _nodes[ROOT].count; }
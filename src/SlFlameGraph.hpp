@@ -0,0 +1,102 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFlameGraph.hpp
+ * @brief   Declares the prefix tree of interned kernel stacks used by the
+ *          flame graph, updated incrementally as its time range changes.
+ *
+ * @note    Definitions in `SlFlameGraph.cpp`.
+*/
+
+#ifndef _SL_FLAME_GRAPH_HPP
+#define _SL_FLAME_GRAPH_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <unordered_map>
+#include <vector>
+
+// Plugin
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief Node of the flame graph's prefix tree. Children of a node are
+ * kept as a singly linked list of siblings.
+ */
+struct SlFlameNode {
+    ///
+    /// @brief Interned symbol of the frame, unused for the root.
+    uint32_t symbol;
+    ///
+    /// @brief Index of the parent node, unused for the root.
+    uint32_t parent;
+    ///
+    /// @brief Index of the first child or `SlFlameGraph::NO_NODE`.
+    uint32_t first_child;
+    ///
+    /// @brief Index of the next sibling or `SlFlameGraph::NO_NODE`.
+    uint32_t next_sibling;
+    ///
+    /// @brief How many stacks in the range pass through this node.
+    int64_t count;
+};
+
+/**
+ * @brief Prefix tree of kernel stacks of collected events in a range
+ * of the stream index. Root of the tree is the bottom of the stacks.
+ *
+ * Changing the range only adds and subtracts the events which entered
+ * or left it, nodes are never removed, only their counts go to zero.
+ */
+class SlFlameGraph {
+public: // Class data members
+    ///
+    /// @brief Marks a missing node link.
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+    ///
+    /// @brief Index of the root node.
+    static constexpr uint32_t ROOT = 0;
+private: // Data members
+    ///
+    /// @brief Index the tree is built over, not owned.
+    const SlStreamIndex* _index;
+
+    ///
+    /// @brief All nodes of the tree, root first.
+    std::vector<SlFlameNode> _nodes;
+
+    /// @brief Lookup of child nodes keyed by their parent's index
+    /// in the upper half and their symbol in the lower half.
+    std::unordered_map<uint64_t, uint32_t> _children;
+
+    ///
+    /// @brief Node of each stack's top frame, by stack ID.
+    std::vector<uint32_t> _stack_leaves;
+
+    ///
+    /// @brief First event index of the current range.
+    ssize_t _begin{0};
+
+    ///
+    /// @brief One past the last event index of the current range.
+    ssize_t _end{0};
+private: // Functions
+    uint32_t _child(uint32_t parent, uint32_t symbol);
+    uint32_t _leaf_of(uint32_t stack_id);
+    void _apply(ssize_t begin, ssize_t end, int64_t sign,
+                std::unordered_map<uint32_t, int64_t>& deltas) const;
+public: // Functions
+    explicit SlFlameGraph(const SlStreamIndex* index);
+
+    void set_range(ssize_t begin, ssize_t end);
+    void set_time_range(int64_t min_ts, int64_t max_ts);
+    void clear();
+
+    const SlStreamIndex* index() const;
+    const std::vector<SlFlameNode>& nodes() const;
+    int64_t total() const;
+};
+
+#endif
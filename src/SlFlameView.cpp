@@ -0,0 +1,355 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFlameView.cpp
+ * @brief   Defines the flame graph window and the canvas it paints on.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin headers
+#include "stacklook.h"
+#include "SlConfig.hpp"
+#include "SlFlameView.hpp"
+
+// Static functions
+
+/**
+ * @brief Picks a warm color for a frame's rectangle, based on the hash
+ * of its symbol, so that the same function is always the same color.
+ *
+ * @param symbol: text of the frame's symbol
+ *
+ * @returns Color of the frame.
+ */
+static QColor _frame_color(const QString& symbol) {
+    const size_t hash = qHash(symbol);
+    return QColor(205 + int(hash % 50),
+                  int((hash >> 8) % 230),
+                  int((hash >> 16) % 55));
+}
+
+/**
+ * @brief Formats a trace timestamp as seconds, the way KernelShark does.
+ *
+ * @param ts: timestamp in nanoseconds
+ *
+ * @returns Text with the timestamp in seconds.
+ */
+static QString _ts_text(int64_t ts) {
+    return QString::number(double(ts) / 1e9, 'f', 6);
+}
+
+// Class functions - canvas
+
+///
+/// @brief Height of one frame's row in pixels.
+static constexpr int FRAME_ROW_HEIGHT = 18;
+
+/**
+ * @brief Constructor of the flame graph canvas.
+ *
+ * @param parent: widget owning the canvas
+ */
+SlFlameCanvas::SlFlameCanvas(QWidget* parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setMinimumSize(400, 8 * FRAME_ROW_HEIGHT);
+}
+
+/**
+ * @brief Sets the tree to paint and zooms out.
+ *
+ * @param graph: tree to paint, may be nullptr
+ */
+void SlFlameCanvas::set_graph(const SlFlameGraph* graph) {
+    _graph = graph;
+    reset_zoom();
+}
+
+/**
+ * @brief Makes the root of the tree span the full width again.
+ */
+void SlFlameCanvas::reset_zoom() {
+    _zoom_node = SlFlameGraph::ROOT;
+    update();
+}
+
+/**
+ * @brief Gets text describing a node - its symbol, count and share of
+ * all stacks in the range.
+ *
+ * @param node: index of the node
+ *
+ * @returns Label of the node.
+ */
+QString SlFlameCanvas::_node_label(uint32_t node) const {
+    const SlFlameNode& flame_node = _graph->nodes()[node];
+    const QString name = (node == SlFlameGraph::ROOT) ? QString("all") :
+        QString::fromUtf8(_graph->index()->symbols().text(flame_node.symbol));
+    const double share = (_graph->total() > 0) ?
+        100.0 * double(flame_node.count) / double(_graph->total()) : 0.0;
+
+    return QString("%1 (%2 stacks, %3 %)").arg(name)
+                                           .arg(flame_node.count)
+                                           .arg(share, 0, 'f', 2);
+}
+
+/**
+ * @brief Paints a node and, recursively, its children above it. Nodes
+ * narrower than a pixel or above the canvas' top are skipped.
+ *
+ * @param painter: painter of the canvas
+ * @param node: index of the node to paint
+ * @param x: left edge of the node's rectangle
+ * @param width: width of the node's rectangle
+ * @param depth: how many rows from the bottom the node is
+ */
+void SlFlameCanvas::_paint_node(QPainter& painter, uint32_t node,
+                                double x, double width, int depth) {
+    const int y = height() - (depth + 1) * FRAME_ROW_HEIGHT;
+    if (width < 1.0 || y < 0)
+        return;
+
+    const std::vector<SlFlameNode>& nodes = _graph->nodes();
+    const SlSymbolTable& symbols = _graph->index()->symbols();
+
+    const QString name = (node == SlFlameGraph::ROOT) ? QString("all") :
+        QString::fromUtf8(symbols.text(nodes[node].symbol));
+    const QRectF box{x, double(y), width, double(FRAME_ROW_HEIGHT - 1)};
+
+    painter.fillRect(box, _frame_color(name));
+    if (width > 20.0) {
+        const QString text = painter.fontMetrics().elidedText(
+            name, Qt::ElideRight, int(width) - 4);
+        painter.drawText(box.adjusted(2, 0, -2, 0),
+                         Qt::AlignVCenter | Qt::AlignLeft, text);
+    }
+    _hit_boxes.emplace_back(box, node);
+
+    // Flame graphs order siblings alphabetically
+    std::vector<uint32_t> children;
+    for (uint32_t child = nodes[node].first_child;
+         child != SlFlameGraph::NO_NODE; child = nodes[child].next_sibling) {
+        if (nodes[child].count > 0)
+            children.push_back(child);
+    }
+    std::sort(children.begin(), children.end(),
+        [&](uint32_t left, uint32_t right) {
+            return symbols.text(nodes[left].symbol)
+                   < symbols.text(nodes[right].symbol);
+        });
+
+    double child_x = x;
+    for (uint32_t child : children) {
+        const double child_width = width * double(nodes[child].count)
+                                   / double(nodes[node].count);
+        _paint_node(painter, child, child_x, child_width, depth + 1);
+        child_x += child_width;
+    }
+}
+
+/**
+ * @brief Finds the node painted under a point of the canvas.
+ *
+ * @param pos: point in the canvas' coordinates
+ *
+ * @returns Index of the node or `SlFlameGraph::NO_NODE`.
+ */
+uint32_t SlFlameCanvas::_node_at(const QPoint& pos) const {
+    for (const auto& [box, node] : _hit_boxes) {
+        if (box.contains(pos))
+            return node;
+    }
+    return SlFlameGraph::NO_NODE;
+}
+
+/**
+ * @brief Paints the tree from the zoomed-in node up.
+ */
+void SlFlameCanvas::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    _hit_boxes.clear();
+
+    if (_graph == nullptr || _graph->total() == 0) {
+        painter.drawText(rect(), Qt::AlignCenter,
+                         "No kernel stacks in the range.");
+        return;
+    }
+
+    if (_graph->nodes()[_zoom_node].count == 0)
+        _zoom_node = SlFlameGraph::ROOT;
+
+    _paint_node(painter, _zoom_node, 0.0, double(width()), 0);
+}
+
+/**
+ * @brief Zooms into the clicked node.
+ *
+ * @param event: Qt mouse event
+ */
+void SlFlameCanvas::mousePressEvent(QMouseEvent* event) {
+    const uint32_t node = _node_at(event->pos());
+    if (node != SlFlameGraph::NO_NODE) {
+        _zoom_node = node;
+        update();
+    }
+}
+
+/**
+ * @brief Zooms out to the root.
+ */
+void SlFlameCanvas::mouseDoubleClickEvent(QMouseEvent*) {
+    reset_zoom();
+}
+
+/**
+ * @brief Shows a tooltip with the label of the hovered node.
+ *
+ * @param event: Qt event
+ *
+ * @returns Whether the event was handled.
+ */
+bool SlFlameCanvas::event(QEvent* event) {
+    if (event->type() == QEvent::ToolTip) {
+        auto help_event = static_cast<QHelpEvent*>(event);
+        const uint32_t node = _node_at(help_event->pos());
+        if (node != SlFlameGraph::NO_NODE) {
+            QToolTip::showText(help_event->globalPos(), _node_label(node));
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+// Class functions - window
+
+/**
+ * @brief Constructor of the flame graph window.
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+SlFlameView::SlFlameView()
+    : QWidget(SlConfig::main_w_ptr), // Configuration access here
+    _range_label(this),
+    _follow_check("Follow visible range", this),
+    _canvas(this),
+    _reset_button("Reset zoom", this),
+    _close_button("Close", this)
+{
+    setWindowTitle("Stacklook - Flame Graph");
+    // Set window flags to make header buttons
+    setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint
+                   | Qt::WindowMaximizeButtonHint
+                   | Qt::WindowCloseButtonHint);
+    resize(1000, 500);
+
+    _follow_check.setChecked(true);
+
+    _range_layout.addWidget(&_range_label);
+    _range_layout.addStretch();
+    _range_layout.addWidget(&_follow_check);
+
+    _endstage_btns_layout.addWidget(&_reset_button);
+    _endstage_btns_layout.addStretch();
+    _endstage_btns_layout.addWidget(&_close_button);
+
+    _layout.addLayout(&_range_layout);
+    _layout.addWidget(&_canvas, 1);
+    _layout.addLayout(&_endstage_btns_layout);
+
+    connect(&_reset_button, &QPushButton::pressed,
+            &_canvas, &SlFlameCanvas::reset_zoom);
+    connect(&_close_button, &QPushButton::pressed,
+            this, &QWidget::close);
+
+    setLayout(&_layout);
+    _update_label();
+}
+
+/**
+ * @brief Updates the aggregation to the latest requested range. If the
+ * stream's index changed since the last update, the tree is rebuilt.
+ */
+void SlFlameView::refresh() {
+    _update_pending = false;
+
+    const SlStreamIndex* index = (_stream_id >= 0) ?
+        get_stream_index(_stream_id) : nullptr;
+    if (index == nullptr) {
+        _graph.reset();
+        _canvas.set_graph(nullptr);
+        _update_label();
+        return;
+    }
+
+    if (!_graph || _graph->index() != index) {
+        _graph = std::make_unique<SlFlameGraph>(index);
+        _canvas.set_graph(_graph.get());
+    }
+
+    _graph->set_time_range(_min_ts, _max_ts);
+    _update_label();
+    _canvas.update();
+}
+
+/**
+ * @brief Shows the aggregated range and stack count in the label.
+ */
+void SlFlameView::_update_label() {
+    if (!_graph) {
+        _range_label.setText("No kernel stacks to aggregate yet.");
+        return;
+    }
+
+    _range_label.setText(QString("Stream %1, %2 s - %3 s, %4 stacks")
+                         .arg(_stream_id)
+                         .arg(_ts_text(_min_ts))
+                         .arg(_ts_text(_max_ts))
+                         .arg(_graph->total()));
+}
+
+/**
+ * @brief Notifies the window of the range visible in KernelShark's graph.
+ * If the window follows the range, an update is scheduled, so that the
+ * aggregation doesn't happen in the middle of KernelShark's drawing.
+ *
+ * @param stream_id: stream being drawn
+ * @param min_ts: lowest visible timestamp
+ * @param max_ts: highest visible timestamp
+ */
+void SlFlameView::follow_range(int stream_id, int64_t min_ts, int64_t max_ts) {
+    if (!_follow_check.isChecked())
+        return;
+    if (stream_id == _stream_id && min_ts == _min_ts && max_ts == _max_ts)
+        return;
+
+    _stream_id = stream_id;
+    _min_ts = min_ts;
+    _max_ts = max_ts;
+
+    if (isVisible() && !_update_pending) {
+        _update_pending = true;
+        QTimer::singleShot(0, this, [this]() { refresh(); });
+    }
+}
+
+/**
+ * @brief Drops the aggregation if it was built over an index which is
+ * about to be freed.
+ *
+ * @param index: index to be freed
+ */
+void SlFlameView::index_freed(const SlStreamIndex* index) {
+    if (_graph && _graph->index() == index) {
+        _canvas.set_graph(nullptr);
+        _graph.reset();
+        _update_label();
+    }
+}
@@ -0,0 +1,134 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFlameView.hpp
+ * @brief   Declares the flame graph window of the plugin, which aggregates
+ *          kernel stacks of all collected events in the visible time range.
+ *
+ * @note    Definitions in `SlFlameView.cpp`.
+*/
+
+#ifndef _SL_FLAME_VIEW_HPP
+#define _SL_FLAME_VIEW_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QtWidgets>
+
+// Plugin
+#include "SlFlameGraph.hpp"
+
+/**
+ * @brief Canvas painting the flame graph's tree. Frames are drawn as
+ * rectangles with widths proportional to their counts, the bottom of
+ * the stacks is at the bottom of the canvas.
+ *
+ * Clicking a frame zooms into it, double clicking anywhere zooms out.
+ */
+class SlFlameCanvas : public QWidget {
+private: // Data members
+    ///
+    /// @brief Tree to paint, not owned.
+    const SlFlameGraph* _graph{nullptr};
+
+    ///
+    /// @brief Node drawn with the full width of the canvas.
+    uint32_t _zoom_node{SlFlameGraph::ROOT};
+
+    ///
+    /// @brief Painted rectangles of nodes, for mouse hit tests.
+    std::vector<std::pair<QRectF, uint32_t>> _hit_boxes;
+private: // Functions
+    void _paint_node(QPainter& painter, uint32_t node,
+                     double x, double width, int depth);
+    uint32_t _node_at(const QPoint& pos) const;
+    QString _node_label(uint32_t node) const;
+protected: // Qt functions
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    bool event(QEvent* event) override;
+public: // Functions
+    explicit SlFlameCanvas(QWidget* parent);
+    void set_graph(const SlFlameGraph* graph);
+    void reset_zoom();
+};
+
+/**
+ * @brief Window with the flame graph of kernel stacks of collected events.
+ * By default it follows the time range visible in KernelShark's graph,
+ * the range can be pinned to keep the current aggregation.
+ *
+ * There is at most one such window, the plugin owns it the same way it
+ * owns the configuration window.
+ */
+class SlFlameView : public QWidget {
+private: // Data members
+    ///
+    /// @brief Aggregation of stacks of the followed stream.
+    std::unique_ptr<SlFlameGraph> _graph;
+
+    ///
+    /// @brief Stream whose stacks are aggregated, -1 if none yet.
+    int _stream_id{-1};
+
+    ///
+    /// @brief Lowest timestamp of the range to aggregate.
+    int64_t _min_ts{0};
+
+    ///
+    /// @brief Highest timestamp of the range to aggregate.
+    int64_t _max_ts{INT64_MAX};
+
+    ///
+    /// @brief Whether a range update is already scheduled.
+    bool _update_pending{false};
+private: // Qt data members
+    ///
+    /// @brief Layout for the widget's control elements.
+    QVBoxLayout     _layout;
+
+    ///
+    /// @brief Layout for the range label and the pin checkbox.
+    QHBoxLayout     _range_layout;
+
+    ///
+    /// @brief Shows the aggregated range and count of stacks.
+    QLabel          _range_label;
+
+    ///
+    /// @brief If checked, the range follows KernelShark's visible range.
+    QCheckBox       _follow_check;
+
+    ///
+    /// @brief Canvas the flame graph is painted on.
+    SlFlameCanvas   _canvas;
+
+    ///
+    /// @brief Layout for the Reset zoom and Close buttons.
+    QHBoxLayout     _endstage_btns_layout;
+
+    ///
+    /// @brief Zooms the canvas out to the root.
+    QPushButton     _reset_button;
+public: // Qt data members
+    ///
+    /// @brief Close button for the widget.
+    QPushButton     _close_button;
+private: // Functions
+    void _update_label();
+public: // Functions
+    SlFlameView();
+    void refresh();
+    void follow_range(int stream_id, int64_t min_ts, int64_t max_ts);
+    void index_freed(const SlStreamIndex* index);
+};
+
+#endif
@@ -0,0 +1,94 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFoldedExport.cpp
+ * @brief   Defines the exporter of kernel stacks to the folded stack
+ *          format.
+*/
+
+// C
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// C++
+#include <memory>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlFoldedExport.hpp"
+#include "SlStackAggregate.hpp"
+
+// Static variables
+
+///
+/// @brief Size of the output file's buffer.
+static constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+// Global functions
+
+/**
+ * @brief Writes kernel stacks of a stream in the folded stack format, one
+ * line per task and stack: `task;bottom_frame;...;top_frame weight`.
+ * Stacks are aggregated over interned IDs first, texts are put together
+ * only for the line being written and the file is written through a large
+ * buffer, so that huge traces can be exported.
+ *
+ * @param index: built index of the stream
+ * @param path: path of the output file, overwritten if it exists
+ * @param weight: what the number at the end of each line counts
+ *
+ * @returns Result of the export. Stacks with zero weight aren't written.
+ */
+SlExportResult export_folded_stacks(const SlStreamIndex& index,
+                                    const std::string& path,
+                                    SlFoldedWeight weight) {
+    const std::vector<SlAggregatedStack> aggregated = aggregate_stacks(index);
+
+    std::unique_ptr<FILE, int(*)(FILE*)> out{fopen(path.c_str(), "w"), fclose};
+    if (!out)
+        return {false, 0, path + ": " + strerror(errno)};
+    setvbuf(out.get(), nullptr, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    const SlSymbolTable& symbols = index.symbols();
+    const SlStackTable& stacks = index.stacks();
+    uint64_t written = 0;
+
+    // Reused for every line
+    std::string line;
+
+    for (const SlAggregatedStack& stack : aggregated) {
+        const uint64_t value = (weight == SlFoldedWeight::OFF_CPU_NS) ?
+            stack.off_cpu_ns : stack.count;
+        if (value == 0)
+            continue;
+
+        const kshark_entry* sample = index.events()->data[stack.sample_event]->entry;
+        const char* task = kshark_get_task(sample);
+        line.assign((task != nullptr) ? task : "<unknown>");
+        line += '-';
+        line += std::to_string(stack.pid);
+
+        // Folded stacks start at the bottom, the index keeps the top first
+        std::span<const uint32_t> frames = stacks.frames(stack.stack_id);
+        for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+            line += ';';
+            line += symbols.text(*frame);
+        }
+        line += ' ';
+        line += std::to_string(value);
+        line += '\n';
+
+        if (fwrite(line.data(), 1, line.size(), out.get()) != line.size())
+            return {false, written, path + ": " + strerror(errno)};
+        ++written;
+    }
+
+    if (fclose(out.release()) != 0)
+        return {false, written, path + ": " + strerror(errno)};
+
+    return {true, written, {}};
+}
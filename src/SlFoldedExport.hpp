@@ -0,0 +1,38 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlFoldedExport.hpp
+ * @brief   Declares the exporter of kernel stacks to the folded stack
+ *          format used by flame graph tools. Doesn't depend on Qt, so it
+ *          can be used without the GUI.
+ *
+ * @note    Definitions in `SlFoldedExport.cpp`.
+*/
+
+#ifndef _SL_FOLDED_EXPORT_HPP
+#define _SL_FOLDED_EXPORT_HPP
+
+// C++
+#include <string>
+
+// Plugin
+#include "SlStackAggregate.hpp"
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief What the number at the end of a folded line counts.
+ */
+enum class SlFoldedWeight {
+    ///
+    /// @brief Number of events with the stack.
+    EVENT_COUNT,
+    ///
+    /// @brief Nanoseconds spent off CPU after switching out with the stack.
+    OFF_CPU_NS
+};
+
+SlExportResult export_folded_stacks(const SlStreamIndex& index,
+                                    const std::string& path,
+                                    SlFoldedWeight weight);
+
+#endif
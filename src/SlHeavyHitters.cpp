@@ -0,0 +1,235 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlHeavyHitters.cpp
+ * @brief   Defines the Space-Saving summary and the aggregator of the most
+ *          frequent kernel stacks.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin
+#include "SlHeavyHitters.hpp"
+
+// Class functions - Space-Saving
+
+/**
+ * @brief Constructor of an empty summary.
+ *
+ * @param capacity: maximum number of counters
+ */
+SlSpaceSaving::SlSpaceSaving(size_t capacity)
+    : _capacity(std::max<size_t>(capacity, 1)) {}
+
+/**
+ * @brief Swaps two counters in the heap and updates their positions.
+ *
+ * @param a: heap position of the first counter
+ * @param b: heap position of the second counter
+ */
+void SlSpaceSaving::_swap(size_t a, size_t b) {
+    std::swap(_heap[a], _heap[b]);
+    _positions[_heap[a].key] = a;
+    _positions[_heap[b].key] = b;
+}
+
+/**
+ * @brief Moves a counter down the heap until its children are
+ * not smaller than it.
+ *
+ * @param pos: heap position of the counter
+ */
+void SlSpaceSaving::_sift_down(size_t pos) {
+    const size_t size = _heap.size();
+    while (true) {
+        size_t smallest = pos;
+        const size_t left = 2 * pos + 1;
+        const size_t right = left + 1;
+        if (left < size && _heap[left].count < _heap[smallest].count)
+            smallest = left;
+        if (right < size && _heap[right].count < _heap[smallest].count)
+            smallest = right;
+        if (smallest == pos)
+            return;
+        _swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+/**
+ * @brief Moves a counter up the heap until its parent is not
+ * larger than it.
+ *
+ * @param pos: heap position of the counter
+ */
+void SlSpaceSaving::_sift_up(size_t pos) {
+    while (pos > 0) {
+        const size_t parent = (pos - 1) / 2;
+        if (_heap[parent].count <= _heap[pos].count)
+            return;
+        _swap(pos, parent);
+        pos = parent;
+    }
+}
+
+/**
+ * @brief Counts an occurrence of a key.
+ *
+ * @param key: key which occurred
+ * @param event_idx: index of the event the key occurred in
+ * @param weight: how much the occurrence counts
+ * @param may_grow: whether a new counter may be allocated for a new key,
+ * the smallest counter is taken over otherwise; an empty summary always
+ * allocates one
+ */
+void SlSpaceSaving::add(uint64_t key, ssize_t event_idx, uint64_t weight,
+                        bool may_grow) {
+    auto found = _positions.find(key);
+    if (found != _positions.end()) {
+        SlHitterCounter& counter = _heap[found->second];
+        counter.count += weight;
+        counter.last_event = event_idx;
+        _sift_down(found->second);
+        return;
+    }
+
+    if (_heap.empty() || (may_grow && _heap.size() < _capacity)) {
+        _heap.push_back({key, weight, 0, event_idx});
+        _positions[key] = _heap.size() - 1;
+        _sift_up(_heap.size() - 1);
+        return;
+    }
+
+    // Take over the smallest counter
+    SlHitterCounter& smallest = _heap.front();
+    _positions.erase(smallest.key);
+    smallest.error = smallest.count;
+    smallest.count += weight;
+    smallest.key = key;
+    smallest.last_event = event_idx;
+    _positions[key] = 0;
+    _sift_down(0);
+}
+
+/**
+ * @brief Gets all counters of the summary, in no particular order.
+ *
+ * @returns Const reference to the counters.
+ */
+const std::vector<SlHitterCounter>& SlSpaceSaving::counters() const
+{ return _heap; }
+
+/**
+ * @brief Gets the number of allocated counters.
+ *
+ * @returns Number of counters.
+ */
+size_t SlSpaceSaving::size() const
+{ return _heap.size(); }
+
+/**
+ * @brief Removes all counters.
+ */
+void SlSpaceSaving::clear() {
+    _heap.clear();
+    _positions.clear();
+}
+
+// Class functions - stack heavy hitters
+
+/**
+ * @brief Constructor of the aggregator.
+ *
+ * @param group_capacity: number of counters of each group's summary
+ * @param capacity: number of counters of all groups of a grouping
+ */
+SlStackHeavyHitters::SlStackHeavyHitters(size_t group_capacity, size_t capacity)
+    : _group_capacity(group_capacity), _capacity(capacity) {}
+
+/**
+ * @brief Counts a stack in one group, creating the group's summary if
+ * it's new. The summary may grow only while the grouping is under its cap.
+ *
+ * @param group: grouping dimension
+ * @param group_value: CPU, PID or prev_state letter
+ * @param stack_id: ID of the interned stack
+ * @param event_idx: index of the event in the container of collected events
+ */
+void SlStackHeavyHitters::_add(SlHitterGroup group, uint32_t group_value,
+                               uint32_t stack_id, ssize_t event_idx) {
+    _Grouping& grouping = _groupings[(size_t)group];
+    SlSpaceSaving& summary = grouping.summaries.try_emplace(
+        group_value, _group_capacity).first->second;
+
+    const size_t counters_before = summary.size();
+    summary.add(stack_id, event_idx, 1, grouping.counters < _capacity);
+    grouping.counters += summary.size() - counters_before;
+}
+
+/**
+ * @brief Counts an event's stack in all groupings.
+ *
+ * @param entry: entry of the event
+ * @param event_idx: index of the event in the container of collected events
+ * @param stack_id: ID of the event's interned stack
+ * @param prev_state: prev_state letter of a switch, `0` for other events
+ */
+void SlStackHeavyHitters::add(const kshark_entry* entry, ssize_t event_idx,
+                              uint32_t stack_id, char prev_state) {
+    _add(SlHitterGroup::CPU, uint32_t(entry->cpu), stack_id, event_idx);
+    _add(SlHitterGroup::TASK, uint32_t(entry->pid), stack_id, event_idx);
+    if (prev_state != 0)
+        _add(SlHitterGroup::PREV_STATE, uint32_t(prev_state), stack_id, event_idx);
+}
+
+/**
+ * @brief Gets the most frequent stacks of each group of a grouping.
+ *
+ * @param group: grouping dimension
+ * @param per_group: how many stacks to get at most for each group
+ *
+ * @returns Rows sorted by group and then by descending count.
+ */
+std::vector<SlStackHitter> SlStackHeavyHitters::top(SlHitterGroup group,
+                                                    size_t per_group) const {
+    const _Grouping& grouping = _groupings[(size_t)group];
+
+    std::vector<uint32_t> group_values;
+    group_values.reserve(grouping.summaries.size());
+    for (const auto& [group_value, summary] : grouping.summaries) {
+        group_values.push_back(group_value);
+    }
+    std::sort(group_values.begin(), group_values.end());
+
+    std::vector<SlStackHitter> rows;
+    std::vector<SlStackHitter> hitters;
+    for (uint32_t group_value : group_values) {
+        hitters.clear();
+        for (const SlHitterCounter& counter :
+             grouping.summaries.at(group_value).counters()) {
+            hitters.push_back({group_value, uint32_t(counter.key),
+                               counter.count, counter.error,
+                               counter.last_event});
+        }
+
+        const size_t kept = std::min(per_group, hitters.size());
+        std::partial_sort(hitters.begin(), hitters.begin() + kept,
+                          hitters.end(),
+            [](const SlStackHitter& a, const SlStackHitter& b) {
+                return a.count > b.count;
+            });
+        rows.insert(rows.end(), hitters.begin(), hitters.begin() + kept);
+    }
+    return rows;
+}
+
+/**
+ * @brief Removes all counters of all groupings.
+ */
+void SlStackHeavyHitters::clear() {
+    for (_Grouping& grouping : _groupings) {
+        grouping.summaries.clear();
+        grouping.counters = 0;
+    }
+}
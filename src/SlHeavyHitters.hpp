@@ -0,0 +1,164 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlHeavyHitters.hpp
+ * @brief   Declares the streaming Space-Saving summary and the aggregator
+ *          of the most frequent kernel stacks per CPU, task and prev_state.
+ *
+ * @note    Definitions in `SlHeavyHitters.cpp`.
+*/
+
+#ifndef _SL_HEAVY_HITTERS_HPP
+#define _SL_HEAVY_HITTERS_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+/**
+ * @brief Counter of the Space-Saving summary.
+ */
+struct SlHitterCounter {
+    ///
+    /// @brief Key being counted.
+    uint64_t key;
+    ///
+    /// @brief Estimated count, never lower than the real count.
+    uint64_t count;
+    /// @brief Maximum overestimation of the count, i.e. the count of
+    /// the key this counter took over from.
+    uint64_t error;
+    ///
+    /// @brief Index of the last event counted under the key.
+    ssize_t last_event;
+};
+
+/**
+ * @brief Space-Saving summary of the most frequent keys of a stream with
+ * a fixed number of counters. When a new key arrives and all counters are
+ * taken, the smallest counter is handed over to the new key.
+ *
+ * Counters are kept in a min-heap, so each update is logarithmic in the
+ * number of counters. They are allocated as keys arrive, not up front.
+ */
+class SlSpaceSaving {
+private: // Data members
+    ///
+    /// @brief Maximum number of counters.
+    size_t _capacity;
+
+    ///
+    /// @brief Counters ordered as a min-heap by their counts.
+    std::vector<SlHitterCounter> _heap;
+
+    ///
+    /// @brief Positions of keys' counters in the heap.
+    std::unordered_map<uint64_t, size_t> _positions;
+private: // Functions
+    void _sift_down(size_t pos);
+    void _sift_up(size_t pos);
+    void _swap(size_t a, size_t b);
+public: // Functions
+    explicit SlSpaceSaving(size_t capacity);
+    void add(uint64_t key, ssize_t event_idx, uint64_t weight = 1,
+             bool may_grow = true);
+    const std::vector<SlHitterCounter>& counters() const;
+    size_t size() const;
+    void clear();
+};
+
+/**
+ * @brief Dimensions by which the most frequent stacks can be grouped.
+ */
+enum class SlHitterGroup : uint8_t {
+    CPU = 0,
+    TASK,
+    PREV_STATE,
+    COUNT
+};
+
+/**
+ * @brief One row of the most frequent stacks - a stack in a group.
+ */
+struct SlStackHitter {
+    ///
+    /// @brief CPU, PID or prev_state letter, based on the grouping.
+    uint32_t group_value;
+    ///
+    /// @brief ID of the interned stack.
+    uint32_t stack_id;
+    ///
+    /// @brief Estimated number of occurrences.
+    uint64_t count;
+    ///
+    /// @brief Maximum overestimation of `count`.
+    uint64_t error;
+    ///
+    /// @brief Index of the last occurrence's event.
+    ssize_t last_event;
+};
+
+/**
+ * @brief Streaming aggregator of the most frequent kernel stacks. It is
+ * fed events one by one while their stacks are associated and keeps one
+ * bounded Space-Saving summary per group (each CPU, task and prev_state),
+ * so heavy groups can't evict counters of minor ones.
+ *
+ * Counters of all groups of a grouping are capped as well. Once the cap is
+ * reached, groups stop growing and new stacks take over their smallest
+ * counters; a new group still gets one counter.
+ */
+class SlStackHeavyHitters {
+public: // Class data members
+    ///
+    /// @brief Default number of counters of each group's summary.
+    static constexpr size_t DEFAULT_GROUP_CAPACITY = 64;
+
+    ///
+    /// @brief Default number of counters of all groups of a grouping.
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+private: // Types
+    /**
+     * @brief Summaries of all groups of one grouping dimension.
+     */
+    struct _Grouping {
+        ///
+        /// @brief Summary of each group, by CPU, PID or prev_state letter.
+        std::unordered_map<uint32_t, SlSpaceSaving> summaries;
+        ///
+        /// @brief Counters of all the summaries.
+        size_t counters = 0;
+    };
+private: // Data members
+    ///
+    /// @brief Number of counters of each group's summary.
+    size_t _group_capacity;
+
+    ///
+    /// @brief Number of counters of all groups of a grouping.
+    size_t _capacity;
+
+    ///
+    /// @brief Summaries of each grouping dimension.
+    std::array<_Grouping, (size_t)SlHitterGroup::COUNT> _groupings;
+private: // Functions
+    void _add(SlHitterGroup group, uint32_t group_value, uint32_t stack_id,
+              ssize_t event_idx);
+public: // Functions
+    explicit SlStackHeavyHitters(size_t group_capacity = DEFAULT_GROUP_CAPACITY,
+                                 size_t capacity = DEFAULT_CAPACITY);
+    void add(const kshark_entry* entry, ssize_t event_idx,
+             uint32_t stack_id, char prev_state);
+    std::vector<SlStackHitter> top(SlHitterGroup group,
+                                   size_t per_group) const;
+    void clear();
+};
+
+#endif
@@ -0,0 +1,176 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlKallsyms.cpp
+ * @brief   Defines loading of saved kernel symbol tables and resolving
+ *          of raw kernel addresses with them.
+*/
+
+// C
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// C++
+#include <algorithm>
+#include <utility>
+
+// Plugin
+#include "SlKallsyms.hpp"
+#include "SlSelfTrace.h"
+
+// Static variables
+
+/// @brief Fewest hexadecimal digits of a symbol taken as a raw address,
+/// so that short function names made of letters a-f aren't.
+static constexpr size_t MIN_ADDRESS_DIGITS = 8;
+
+/// @brief Farthest an address may be from the symbol at or below it to
+/// resolve to it, so that addresses past the last symbol stay raw.
+static constexpr uint64_t MAX_SYMBOL_DISTANCE = 1 << 20;
+
+// Static functions
+
+/**
+ * @brief Checks whether a symbol type of kallsyms marks a text symbol.
+ *
+ * @param type: type letter of the symbol
+ *
+ * @returns True for text and weak symbols, false otherwise.
+ */
+static bool _is_text_type(char type) {
+    return type == 't' || type == 'T' || type == 'w' || type == 'W';
+}
+
+// Global functions
+
+/**
+ * @brief Reads a symbol of a stack frame as a raw address. Frames given
+ * as addresses keep only their hexadecimal digits after parsing, see
+ * `parse_stack_frames`.
+ *
+ * @param symbol: text of an interned symbol
+ * @param address: output location for the address
+ *
+ * @returns True if the symbol is a raw address, false otherwise.
+ */
+bool parse_raw_address(std::string_view symbol, uint64_t& address) {
+    if (symbol.size() < MIN_ADDRESS_DIGITS || symbol.size() > 16)
+        return false;
+
+    uint64_t value = 0;
+    for (char digit : symbol) {
+        value <<= 4;
+        if (digit >= '0' && digit <= '9') {
+            value |= uint64_t(digit - '0');
+        } else if (digit >= 'a' && digit <= 'f') {
+            value |= uint64_t(digit - 'a' + 10);
+        } else if (digit >= 'A' && digit <= 'F') {
+            value |= uint64_t(digit - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+
+    address = value;
+    return true;
+}
+
+// SlKallsyms
+
+/**
+ * @brief Loads text symbols from a saved `/proc/kallsyms` or `System.map`.
+ * Previously loaded symbols are replaced only if loading succeeds.
+ *
+ * @param path: path of the file
+ * @param error: output location for the description of a failure
+ *
+ * @returns True if the file had any usable symbols, false otherwise.
+ */
+bool SlKallsyms::load(const std::string& path, std::string& error) {
+    SL_TRACE_SCOPE("load_kallsyms");
+
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> symbols;
+    char* line = nullptr;
+    size_t capacity = 0;
+    bool restricted = false;
+
+    while (getline(&line, &capacity, file) != -1) {
+        uint64_t address;
+        char type;
+        int name_start = 0;
+        int name_end = 0;
+        if (sscanf(line, "%" SCNx64 " %c %n%*s%n", &address, &type,
+                   &name_start, &name_end) != 2 || name_end <= name_start)
+            continue;
+        // Restricted kallsyms (kptr_restrict) list all addresses as zero
+        if (address == 0) {
+            restricted = true;
+            continue;
+        }
+        if (!_is_text_type(type))
+            continue;
+
+        symbols.emplace_back(address,
+                             std::string(line + name_start, name_end - name_start));
+    }
+
+    free(line);
+    fclose(file);
+
+    if (symbols.empty()) {
+        error = path + (restricted ?
+            ": all addresses are zero, save kallsyms as root" :
+            ": no text symbols found");
+        return false;
+    }
+
+    // Aliases share an address, the first one listed is kept
+    std::stable_sort(symbols.begin(), symbols.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    _addresses.clear();
+    _names.clear();
+    for (auto& [address, name] : symbols) {
+        if (!_addresses.empty() && _addresses.back() == address)
+            continue;
+        _addresses.push_back(address);
+        _names.push_back(std::move(name));
+    }
+    return true;
+}
+
+/**
+ * @brief Resolves an address to the name of the function it is in.
+ *
+ * @param address: raw kernel address
+ *
+ * @returns Name of the closest symbol at or below the address, empty
+ * view if there is none near enough, e.g. for user-space addresses.
+ */
+std::string_view SlKallsyms::resolve(uint64_t address) const {
+    auto above = std::upper_bound(_addresses.begin(), _addresses.end(), address);
+    if (above == _addresses.begin())
+        return {};
+
+    const size_t found = size_t(above - _addresses.begin()) - 1;
+    if (address - _addresses[found] > MAX_SYMBOL_DISTANCE)
+        return {};
+    return _names[found];
+}
+
+/**
+ * @brief Gets the number of loaded symbols.
+ *
+ * @returns Count of symbols with distinct addresses.
+ */
+size_t SlKallsyms::size() const
+{ return _addresses.size(); }
@@ -0,0 +1,48 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlKallsyms.hpp
+ * @brief   Declares the offline symbolizer of raw kernel addresses, which
+ *          resolves them with a saved `/proc/kallsyms` or `System.map`.
+ *          Doesn't depend on Qt, so it can be used without the GUI.
+ *
+ * @note    Definitions in `SlKallsyms.cpp`.
+*/
+
+#ifndef _SL_KALLSYMS_HPP
+#define _SL_KALLSYMS_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Text symbols of a kernel, sorted by their addresses. An address
+ * resolves to the closest symbol at or below it with one binary search.
+ *
+ * Both `/proc/kallsyms` and `System.map` have the same lines, i.e.
+ * "address type name [module]", so either can be loaded. Only text
+ * symbols are kept, as only they appear in stacks.
+ */
+class SlKallsyms {
+private: // Data members
+    ///
+    /// @brief Addresses of the symbols, ascending and distinct.
+    std::vector<uint64_t> _addresses;
+
+    ///
+    /// @brief Names of the symbols, in the order of `_addresses`.
+    std::vector<std::string> _names;
+public: // Functions
+    bool load(const std::string& path, std::string& error);
+    std::string_view resolve(uint64_t address) const;
+    size_t size() const;
+};
+
+bool parse_raw_address(std::string_view symbol, uint64_t& address);
+
+#endif
@@ -0,0 +1,394 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlLatency.cpp
+ * @brief   Defines the scheduling latency engine.
+*/
+
+// C++
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlLatency.hpp"
+
+// Static functions
+
+/**
+ * @brief Orders latency samples so that the lowest delay ends up on top
+ * of a heap.
+ *
+ * @param a: first sample
+ * @param b: second sample
+ *
+ * @returns True if `a` has a greater delay than `b`.
+ */
+static bool _worse_latency(const SlLatencySample& a, const SlLatencySample& b) {
+    return a.latency > b.latency;
+}
+
+/**
+ * @brief Reads an integer field of an event.
+ *
+ * @param entry: entry of the event
+ * @param field: name of the field
+ * @param value: output location for the field's value
+ *
+ * @returns True if the field was read, false otherwise.
+ */
+static bool _read_field(const kshark_entry* entry, const char* field,
+                        int64_t* value) {
+    return kshark_read_event_field_int(entry, field, value) >= 0;
+}
+
+// Class functions - histogram
+
+/**
+ * @brief Gets the bucket of a value.
+ *
+ * @param value: latency in nanoseconds
+ *
+ * @returns Index of the bucket.
+ */
+size_t SlLatencyHistogram::_bucket_of(uint64_t value) {
+    if (value < LINEAR_LIMIT)
+        return size_t(value);
+
+    // Power of two of the value, at least SUB_BUCKET_BITS + 1
+    const uint32_t magnitude = uint32_t(std::bit_width(value)) - 1;
+    const uint32_t shift = magnitude - SUB_BUCKET_BITS;
+    const size_t sub_bucket = size_t(value >> shift)
+                              - (size_t(1) << SUB_BUCKET_BITS);
+    const size_t bucket = LINEAR_LIMIT
+        + (magnitude - SUB_BUCKET_BITS - 1) * (size_t(1) << SUB_BUCKET_BITS)
+        + sub_bucket;
+
+    return std::min(bucket, BUCKETS - 1);
+}
+
+/**
+ * @brief Gets the highest value which falls into a bucket.
+ *
+ * @param bucket: index of the bucket
+ *
+ * @returns Highest latency of the bucket in nanoseconds.
+ */
+uint64_t SlLatencyHistogram::_highest_in_bucket(size_t bucket) {
+    if (bucket < LINEAR_LIMIT)
+        return bucket;
+
+    const size_t above_linear = bucket - LINEAR_LIMIT;
+    const uint32_t magnitude = uint32_t(above_linear >> SUB_BUCKET_BITS)
+                               + SUB_BUCKET_BITS + 1;
+    const uint64_t top = (uint64_t(1) << SUB_BUCKET_BITS)
+        + (above_linear & ((size_t(1) << SUB_BUCKET_BITS) - 1));
+    const uint32_t shift = magnitude - SUB_BUCKET_BITS;
+
+    return ((top + 1) << shift) - 1;
+}
+
+/**
+ * @brief Records a latency.
+ *
+ * @param value: latency in nanoseconds
+ */
+void SlLatencyHistogram::record(uint64_t value) {
+    ++_counts[_bucket_of(value)];
+    ++_total;
+    _max = std::max(_max, value);
+}
+
+/**
+ * @brief Gets the number of recorded latencies.
+ *
+ * @returns Count of the latencies.
+ */
+uint64_t SlLatencyHistogram::count() const
+{ return _total; }
+
+/**
+ * @brief Gets the highest recorded latency.
+ *
+ * @returns Exact highest latency in nanoseconds, `0` if nothing was
+ * recorded.
+ */
+uint64_t SlLatencyHistogram::max() const
+{ return _max; }
+
+/**
+ * @brief Gets the latency below or at which lies a percentage of the
+ * recorded latencies.
+ *
+ * @param percentile: percentage, between `0` and `100`
+ *
+ * @returns Highest latency of the bucket holding the percentile, never
+ * above the highest recorded latency, `0` if nothing was recorded.
+ */
+uint64_t SlLatencyHistogram::value_at_percentile(double percentile) const {
+    if (_total == 0)
+        return 0;
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t wanted = std::max<uint64_t>(
+        1, uint64_t(std::ceil(clamped / 100.0 * double(_total))));
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += _counts[bucket];
+        // The last bucket has no upper bound of its own
+        if (seen >= wanted && bucket == BUCKETS - 1)
+            return _max;
+        if (seen >= wanted)
+            return std::min(_highest_in_bucket(bucket), _max);
+    }
+    return _max;
+}
+
+// Class functions - pending wakeups
+
+/**
+ * @brief Constructor of an empty table.
+ *
+ * @param capacity: maximum number of pending wakeups, rounded up to
+ * a power of two
+ */
+SlPendingWakeups::SlPendingWakeups(size_t capacity)
+    : _slots(std::bit_ceil(std::max<size_t>(capacity, 2)),
+             _Slot{-1, nullptr}) {}
+
+/**
+ * @brief Gets the slot where a PID's search starts.
+ *
+ * @param pid: PID of a task
+ *
+ * @returns Index of the slot.
+ */
+size_t SlPendingWakeups::_home_of(int32_t pid) const {
+    // Fibonacci hashing spreads consecutive PIDs
+    const uint64_t hash = uint64_t(uint32_t(pid)) * 0x9E3779B97F4A7C15ull;
+    return size_t(hash >> 32) & (_slots.size() - 1);
+}
+
+/**
+ * @brief Opens a pending wakeup of a task. If the task already has one,
+ * the earlier waking is kept, as the task has been runnable since then.
+ *
+ * @param pid: PID of the woken task
+ * @param waking: entry of the waking event
+ *
+ * @returns False if the table is full and the wakeup was dropped,
+ * true otherwise.
+ */
+bool SlPendingWakeups::insert(int32_t pid, const kshark_entry* waking) {
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = _home_of(pid); ; i = (i + 1) & mask) {
+        if (_slots[i].pid == pid)
+            return true;
+        if (_slots[i].pid == -1) {
+            // Keep one slot free, so that searches always end
+            if (_size + 1 >= _slots.size())
+                return false;
+            _slots[i] = {pid, waking};
+            ++_size;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Closes the pending wakeup of a task.
+ *
+ * @param pid: PID of the task
+ *
+ * @returns Entry of the waking event, nullptr if the task had no pending
+ * wakeup.
+ */
+const kshark_entry* SlPendingWakeups::take(int32_t pid) {
+    const size_t mask = _slots.size() - 1;
+    size_t hole = _home_of(pid);
+    while (_slots[hole].pid != pid) {
+        if (_slots[hole].pid == -1)
+            return nullptr;
+        hole = (hole + 1) & mask;
+    }
+
+    const kshark_entry* waking = _slots[hole].waking;
+    --_size;
+
+    // Shift back following slots which the hole would make unreachable
+    for (size_t i = (hole + 1) & mask; _slots[i].pid != -1; i = (i + 1) & mask) {
+        const size_t home = _home_of(_slots[i].pid);
+        const bool reachable = (hole <= i) ? (hole < home && home <= i)
+                                           : (hole < home || home <= i);
+        if (!reachable) {
+            _slots[hole] = _slots[i];
+            hole = i;
+        }
+    }
+    _slots[hole] = {-1, nullptr};
+
+    return waking;
+}
+
+/**
+ * @brief Gets the number of pending wakeups.
+ *
+ * @returns Count of the wakeups.
+ */
+size_t SlPendingWakeups::size() const
+{ return _size; }
+
+// Class functions - statistics
+
+/**
+ * @brief Records the delay of one wakeup.
+ *
+ * @param pid: PID of the woken task
+ * @param waking: entry of the waking event
+ * @param switch_in: entry of the switch which ran the woken task
+ */
+void SlLatencyStats::_record(int32_t pid, const kshark_entry* waking,
+                             const kshark_entry* switch_in) {
+    if (switch_in->ts < waking->ts)
+        return;
+
+    const uint64_t latency = uint64_t(switch_in->ts - waking->ts);
+    _all.record(latency);
+
+    if (switch_in->cpu >= 0) {
+        if (size_t(switch_in->cpu) >= _per_cpu.size())
+            _per_cpu.resize(size_t(switch_in->cpu) + 1);
+        _per_cpu[switch_in->cpu].record(latency);
+    }
+
+    auto slot = _task_slots.find(pid);
+    if (slot != _task_slots.end()) {
+        _per_task[slot->second].histogram.record(latency);
+    } else if (_per_task.size() < MAX_TASKS) {
+        _task_slots.emplace(pid, _per_task.size());
+        _per_task.push_back({pid, {}});
+        _per_task.back().histogram.record(latency);
+    } else {
+        _other_tasks.record(latency);
+    }
+
+    const SlLatencySample sample{pid, latency, waking, switch_in};
+    if (_outliers.size() < MAX_OUTLIERS) {
+        _outliers.push_back(sample);
+        std::push_heap(_outliers.begin(), _outliers.end(), _worse_latency);
+    } else if (latency > _outliers.front().latency) {
+        std::pop_heap(_outliers.begin(), _outliers.end(), _worse_latency);
+        _outliers.back() = sample;
+        std::push_heap(_outliers.begin(), _outliers.end(), _worse_latency);
+    }
+}
+
+/**
+ * @brief Measures wakeup-to-run delays in one pass over collected events.
+ * Woken PIDs are read from the `pid` field of wakings, switched PIDs from
+ * the `next_pid` and `prev_pid` fields of switches, so that plugins which
+ * rewrite entries' PIDs don't matter.
+ *
+ * @param events: sorted container of collected events
+ * @param swaking_event_id: numerical id of the stream's sched_waking event
+ * @param sswitch_event_id: numerical id of the stream's sched_switch event
+ */
+void SlLatencyStats::build(const kshark_data_container* events,
+                           int swaking_event_id, int sswitch_event_id) {
+    SlPendingWakeups pending{MAX_PENDING};
+
+    for (ssize_t i = 0; i < events->size; ++i) {
+        const kshark_entry* entry = events->data[i]->entry;
+        int64_t pid;
+
+        if (entry->event_id == swaking_event_id) {
+            // The idle task is never woken up for real
+            if (_read_field(entry, "pid", &pid) && pid > 0
+                && !pending.insert(int32_t(pid), entry)) {
+                ++_dropped;
+            }
+        } else if (entry->event_id == sswitch_event_id) {
+            // A task leaving the CPU must have been switched in without
+            // its wakeup being closed, e.g. when switches were lost
+            if (_read_field(entry, "prev_pid", &pid) && pid > 0
+                && pending.take(int32_t(pid)) != nullptr) {
+                ++_unmatched;
+            }
+
+            if (_read_field(entry, "next_pid", &pid) && pid > 0) {
+                const kshark_entry* waking = pending.take(int32_t(pid));
+                if (waking != nullptr)
+                    _record(int32_t(pid), waking, entry);
+            }
+        }
+    }
+
+    _unmatched += pending.size();
+}
+
+/**
+ * @brief Gets the histogram of all delays.
+ *
+ * @returns Const reference to the histogram.
+ */
+const SlLatencyHistogram& SlLatencyStats::all() const
+{ return _all; }
+
+/**
+ * @brief Gets histograms of delays by the CPU the tasks were switched
+ * in on.
+ *
+ * @returns Const reference to the histograms, indexed by CPU.
+ */
+const std::vector<SlLatencyHistogram>& SlLatencyStats::per_cpu() const
+{ return _per_cpu; }
+
+/**
+ * @brief Gets histograms of tasks which have histograms of their own.
+ *
+ * @returns Const reference to the tasks' histograms, in the order the
+ * tasks were first switched in.
+ */
+const std::vector<SlTaskLatency>& SlLatencyStats::per_task() const
+{ return _per_task; }
+
+/**
+ * @brief Gets the histogram shared by tasks beyond `MAX_TASKS`.
+ *
+ * @returns Const reference to the histogram.
+ */
+const SlLatencyHistogram& SlLatencyStats::other_tasks() const
+{ return _other_tasks; }
+
+/**
+ * @brief Gets the worst delays.
+ *
+ * @returns Copy of the samples, the worst delay first.
+ */
+std::vector<SlLatencySample> SlLatencyStats::outliers() const {
+    std::vector<SlLatencySample> sorted = _outliers;
+    std::sort(sorted.begin(), sorted.end(), _worse_latency);
+    return sorted;
+}
+
+/**
+ * @brief Gets the number of wakeups dropped because too many wakeups
+ * were pending at once.
+ *
+ * @returns Count of the dropped wakeups.
+ */
+uint64_t SlLatencyStats::dropped() const
+{ return _dropped; }
+
+/**
+ * @brief Gets the number of wakeups which never ended with a switch-in
+ * of their task.
+ *
+ * @returns Count of the unmatched wakeups.
+ */
+uint64_t SlLatencyStats::unmatched() const
+{ return _unmatched; }
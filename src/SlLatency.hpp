@@ -0,0 +1,203 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlLatency.hpp
+ * @brief   Declares the scheduling latency engine - log-bucketed latency
+ *          histograms, the fixed-size table of pending wakeups and the
+ *          per-CPU and per-task statistics of wakeup-to-run delays.
+ *
+ * @note    Definitions in `SlLatency.cpp`.
+*/
+
+#ifndef _SL_LATENCY_HPP
+#define _SL_LATENCY_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+/**
+ * @brief Histogram of latencies in nanoseconds with logarithmic buckets
+ * in the style of HDR histograms. Every power of two is split into 16
+ * linear sub-buckets, so a reported value is at most ~6 % above the real
+ * one. Values of 2^41 ns (about 37 minutes) and more share the last bucket,
+ * which keeps the size of the histogram fixed.
+ */
+class SlLatencyHistogram {
+public: // Constants
+    ///
+    /// @brief Bits of a value kept exactly inside its power of two.
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    ///
+    /// @brief Values below this limit get a bucket of their own.
+    static constexpr uint64_t LINEAR_LIMIT = uint64_t(2) << SUB_BUCKET_BITS;
+    ///
+    /// @brief Highest power of two with buckets of its own.
+    static constexpr uint32_t MAX_MAGNITUDE = 40;
+    ///
+    /// @brief Number of buckets of every histogram.
+    static constexpr size_t BUCKETS = LINEAR_LIMIT
+        + (MAX_MAGNITUDE - SUB_BUCKET_BITS) * (size_t(1) << SUB_BUCKET_BITS);
+private: // Data members
+    ///
+    /// @brief Number of values in each bucket.
+    std::array<uint32_t, BUCKETS> _counts{};
+
+    ///
+    /// @brief Number of all recorded values.
+    uint64_t _total{0};
+
+    ///
+    /// @brief Highest recorded value, kept exactly.
+    uint64_t _max{0};
+private: // Functions
+    static size_t _bucket_of(uint64_t value);
+    static uint64_t _highest_in_bucket(size_t bucket);
+public: // Functions
+    void record(uint64_t value);
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t value_at_percentile(double percentile) const;
+};
+
+/**
+ * @brief Table of wakeups whose tasks weren't switched in yet, keyed by
+ * PID. The table is open-addressed with a capacity fixed upon creation;
+ * removal shifts following entries back, so no tombstones accumulate.
+ */
+class SlPendingWakeups {
+private: // Types
+    ///
+    /// @brief Slot of the table.
+    struct _Slot {
+        ///
+        /// @brief PID of the woken task, `-1` if the slot is free.
+        int32_t pid;
+        ///
+        /// @brief Entry of the waking event.
+        const kshark_entry* waking;
+    };
+private: // Data members
+    ///
+    /// @brief Slots of the table, their count is a power of two.
+    std::vector<_Slot> _slots;
+
+    ///
+    /// @brief Number of taken slots.
+    size_t _size{0};
+private: // Functions
+    size_t _home_of(int32_t pid) const;
+public: // Functions
+    explicit SlPendingWakeups(size_t capacity);
+    bool insert(int32_t pid, const kshark_entry* waking);
+    const kshark_entry* take(int32_t pid);
+    size_t size() const;
+};
+
+/**
+ * @brief One measured wakeup-to-run delay.
+ */
+struct SlLatencySample {
+    ///
+    /// @brief PID of the woken task.
+    int32_t pid;
+    ///
+    /// @brief Delay between the waking and the switch-in, in nanoseconds.
+    uint64_t latency;
+    ///
+    /// @brief Entry of the waking event.
+    const kshark_entry* waking;
+    ///
+    /// @brief Entry of the switch which ran the woken task.
+    const kshark_entry* switch_in;
+};
+
+/**
+ * @brief Latency histogram of a single task.
+ */
+struct SlTaskLatency {
+    ///
+    /// @brief PID of the task.
+    int32_t pid;
+    ///
+    /// @brief Delays of the task's wakeups.
+    SlLatencyHistogram histogram;
+};
+
+/**
+ * @brief Wakeup-to-run delays of a stream, measured in one pass over
+ * collected `sched_waking` and `sched_switch` events. A waking opens
+ * a pending wakeup of the woken PID, the first switch-in of the PID
+ * afterwards closes it and records the delay per CPU of the switch-in
+ * and per task.
+ *
+ * Memory is bounded: the pending table has a fixed capacity, only the
+ * first `MAX_TASKS` tasks get histograms of their own (the rest share
+ * one) and only the `MAX_OUTLIERS` worst delays are kept as samples.
+ */
+class SlLatencyStats {
+public: // Constants
+    ///
+    /// @brief Capacity of the table of pending wakeups.
+    static constexpr size_t MAX_PENDING = 1 << 16;
+    ///
+    /// @brief Number of tasks with histograms of their own.
+    static constexpr size_t MAX_TASKS = 1024;
+    ///
+    /// @brief Number of the worst delays kept as samples.
+    static constexpr size_t MAX_OUTLIERS = 64;
+private: // Data members
+    ///
+    /// @brief Delays of all wakeups.
+    SlLatencyHistogram _all;
+
+    ///
+    /// @brief Delays by the CPU the task was switched in on.
+    std::vector<SlLatencyHistogram> _per_cpu;
+
+    ///
+    /// @brief Delays of tasks with histograms of their own.
+    std::vector<SlTaskLatency> _per_task;
+
+    ///
+    /// @brief Position of each task's histogram in `_per_task`.
+    std::unordered_map<int32_t, size_t> _task_slots;
+
+    ///
+    /// @brief Delays of tasks which didn't fit into `_per_task`.
+    SlLatencyHistogram _other_tasks;
+
+    ///
+    /// @brief Worst delays, as a min-heap by the delay.
+    std::vector<SlLatencySample> _outliers;
+
+    ///
+    /// @brief Wakeups not recorded, because the pending table was full.
+    uint64_t _dropped{0};
+
+    ///
+    /// @brief Wakeups which never ended with a switch-in of their task.
+    uint64_t _unmatched{0};
+private: // Functions
+    void _record(int32_t pid, const kshark_entry* waking,
+                 const kshark_entry* switch_in);
+public: // Functions
+    void build(const kshark_data_container* events,
+               int swaking_event_id, int sswitch_event_id);
+    const SlLatencyHistogram& all() const;
+    const std::vector<SlLatencyHistogram>& per_cpu() const;
+    const std::vector<SlTaskLatency>& per_task() const;
+    const SlLatencyHistogram& other_tasks() const;
+    std::vector<SlLatencySample> outliers() const;
+    uint64_t dropped() const;
+    uint64_t unmatched() const;
+};
+
+#endif
@@ -0,0 +1,287 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlLatencyView.cpp
+ * @brief   Defines the window with scheduling latency percentiles.
+*/
+
+// KernelShark
+#include "libkshark.h"
+#include "KsMainWindow.hpp"
+
+// Plugin headers
+#include "stacklook.h"
+#include "SlConfig.hpp"
+#include "SlLatencyView.hpp"
+
+// Static functions
+
+///
+/// @brief Indices of the groups table's columns.
+enum _latency_groups_column : int {
+    GROUP_COL = 0,
+    COUNT_COL,
+    P50_COL,
+    P99_COL,
+    MAX_COL,
+    GROUPS_COLUMNS_COUNT
+};
+
+///
+/// @brief Indices of the outliers table's columns.
+enum _latency_outliers_column : int {
+    LATENCY_COL = 0,
+    PID_COL,
+    CPU_COL,
+    WAKING_COL,
+    OUTLIERS_COLUMNS_COUNT
+};
+
+///
+/// @brief Groupings of latencies, order matches the combo box.
+enum class _LatencyGroup : int {
+    CPU = 0,
+    TASK
+};
+
+/**
+ * @brief Creates a table item which sorts by its numerical value.
+ *
+ * @param value: number to show
+ *
+ * @returns Pointer to the new item, to be owned by a table.
+ */
+static QTableWidgetItem* _number_item(qulonglong value) {
+    auto item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, value);
+    return item;
+}
+
+/**
+ * @brief Creates a table item showing nanoseconds as microseconds, which
+ * sorts by its numerical value.
+ *
+ * @param nanoseconds: latency in nanoseconds
+ *
+ * @returns Pointer to the new item, to be owned by a table.
+ */
+static QTableWidgetItem* _usecs_item(uint64_t nanoseconds) {
+    auto item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, double(nanoseconds) / 1e3);
+    return item;
+}
+
+/**
+ * @brief Fills a row of the groups table with a histogram's percentiles.
+ *
+ * @param table: table to fill
+ * @param row: row to fill
+ * @param group: name of the group
+ * @param histogram: latencies of the group
+ */
+static void _set_group_row(QTableWidget& table, int row, const QString& group,
+                           const SlLatencyHistogram& histogram) {
+    table.setItem(row, GROUP_COL, new QTableWidgetItem(group));
+    table.setItem(row, COUNT_COL, _number_item(histogram.count()));
+    table.setItem(row, P50_COL, _usecs_item(histogram.value_at_percentile(50)));
+    table.setItem(row, P99_COL, _usecs_item(histogram.value_at_percentile(99)));
+    table.setItem(row, MAX_COL, _usecs_item(histogram.max()));
+}
+
+// Class functions
+
+/**
+ * @brief Constructor of the scheduling latency window.
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+SlLatencyView::SlLatencyView()
+    : QWidget(SlConfig::main_w_ptr), // Configuration access here
+    _group_label("Group by: ", this),
+    _group_combo(this),
+    _summary_label(this),
+    _groups_table(this),
+    _outliers_label("Worst latencies - click a row to mark its waking (A) "
+                    "and switch-in (B):", this),
+    _outliers_table(this),
+    _close_button("Close", this)
+{
+    setWindowTitle("Stacklook - Wakeup Latency");
+    // Set window flags to make header buttons
+    setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint
+                   | Qt::WindowMaximizeButtonHint
+                   | Qt::WindowCloseButtonHint);
+    resize(800, 700);
+
+    // Order must match _LatencyGroup
+    _group_combo.addItems({"CPU", "Task"});
+
+    _group_layout.addWidget(&_group_label);
+    _group_layout.addWidget(&_group_combo);
+    _group_layout.addStretch();
+
+    _groups_table.setColumnCount(GROUPS_COLUMNS_COUNT);
+    _groups_table.setHorizontalHeaderLabels({"Group", "Count", "p50 (us)",
+                                             "p99 (us)", "Max (us)"});
+    _groups_table.horizontalHeader()->setStretchLastSection(true);
+    _groups_table.setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _groups_table.setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    _outliers_table.setColumnCount(OUTLIERS_COLUMNS_COUNT);
+    _outliers_table.setHorizontalHeaderLabels({"Latency (us)", "PID", "CPU",
+                                               "Waking (s)"});
+    _outliers_table.horizontalHeader()->setStretchLastSection(true);
+    _outliers_table.setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _outliers_table.setSelectionBehavior(QAbstractItemView::SelectRows);
+    _outliers_table.setSelectionMode(QAbstractItemView::SingleSelection);
+
+    _layout.addLayout(&_group_layout);
+    _layout.addWidget(&_summary_label);
+    _layout.addWidget(&_groups_table);
+    _layout.addWidget(&_outliers_label);
+    _layout.addWidget(&_outliers_table);
+    _layout.addWidget(&_close_button);
+
+    connect(&_group_combo, &QComboBox::currentIndexChanged,
+            this, [this]() { _fill_groups(); });
+    connect(&_outliers_table, &QTableWidget::cellClicked,
+            this, [this](int row, int) { _mark_outlier(row); });
+    connect(&_close_button, &QPushButton::pressed,
+            this, &QWidget::close);
+
+    setLayout(&_layout);
+}
+
+/**
+ * @brief Fills the summary and the table of percentiles of the current
+ * grouping. Sorting is disabled while the table is being filled, as
+ * recommended by Qt.
+ */
+void SlLatencyView::_fill_groups() {
+    _groups_table.setSortingEnabled(false);
+    _groups_table.setRowCount(0);
+
+    if (_stats == nullptr) {
+        _summary_label.setText("No latencies to show.");
+        return;
+    }
+
+    const SlLatencyHistogram& all = _stats->all();
+    _summary_label.setText(QString("Stream %1: %2 wakeups, p50 %3 us, "
+                                   "p99 %4 us, max %5 us. Not measured: "
+                                   "%6 without switch-in, %7 dropped.")
+        .arg(_stream_id)
+        .arg(all.count())
+        .arg(double(all.value_at_percentile(50)) / 1e3)
+        .arg(double(all.value_at_percentile(99)) / 1e3)
+        .arg(double(all.max()) / 1e3)
+        .arg(_stats->unmatched())
+        .arg(_stats->dropped()));
+
+    int row = 0;
+    if ((_LatencyGroup)_group_combo.currentIndex() == _LatencyGroup::CPU) {
+        const std::vector<SlLatencyHistogram>& per_cpu = _stats->per_cpu();
+        _groups_table.setRowCount(int(per_cpu.size()));
+        for (size_t cpu = 0; cpu < per_cpu.size(); ++cpu) {
+            if (per_cpu[cpu].count() == 0)
+                continue;
+            _set_group_row(_groups_table, row++,
+                           QString("CPU %1").arg(cpu), per_cpu[cpu]);
+        }
+    } else {
+        const std::vector<SlTaskLatency>& per_task = _stats->per_task();
+        _groups_table.setRowCount(int(per_task.size()) + 1);
+        for (const SlTaskLatency& task : per_task) {
+            _set_group_row(_groups_table, row++,
+                           QString("PID %1").arg(task.pid), task.histogram);
+        }
+        if (_stats->other_tasks().count() > 0) {
+            _set_group_row(_groups_table, row++, "Other tasks",
+                           _stats->other_tasks());
+        }
+    }
+    _groups_table.setRowCount(row);
+
+    _groups_table.setSortingEnabled(true);
+    _groups_table.sortByColumn(P99_COL, Qt::DescendingOrder);
+}
+
+/**
+ * @brief Fills the table of the worst latencies.
+ */
+void SlLatencyView::_fill_outliers() {
+    _outliers_table.setSortingEnabled(false);
+    _outliers_table.setRowCount(0);
+    _outliers.clear();
+
+    if (_stats == nullptr)
+        return;
+
+    _outliers = _stats->outliers();
+    _outliers_table.setRowCount(int(_outliers.size()));
+    for (int row = 0; row < int(_outliers.size()); ++row) {
+        const SlLatencySample& sample = _outliers[row];
+        auto latency_item = _usecs_item(sample.latency);
+        // Rows get reordered by sorting, remember which one this is
+        latency_item->setData(Qt::UserRole, row);
+
+        _outliers_table.setItem(row, LATENCY_COL, latency_item);
+        _outliers_table.setItem(row, PID_COL, _number_item(sample.pid));
+        _outliers_table.setItem(row, CPU_COL,
+                                _number_item(sample.switch_in->cpu));
+        _outliers_table.setItem(row, WAKING_COL, new QTableWidgetItem(
+            QString::number(double(sample.waking->ts) / 1e9, 'f', 6)));
+    }
+
+    _outliers_table.setSortingEnabled(true);
+    _outliers_table.sortByColumn(LATENCY_COL, Qt::DescendingOrder);
+}
+
+/**
+ * @brief Marks the waking of an outlier with KernelShark's marker A and
+ * its switch-in with marker B.
+ *
+ * @param row: row of the outliers table which was clicked
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+void SlLatencyView::_mark_outlier(int row) {
+    QTableWidgetItem* latency_item = _outliers_table.item(row, LATENCY_COL);
+    if (_stats == nullptr || latency_item == nullptr)
+        return;
+
+    const SlLatencySample& sample =
+        _outliers[latency_item->data(Qt::UserRole).toULongLong()];
+
+    // Configuration access here
+    SlConfig::main_w_ptr->markEntry(sample.switch_in, DualMarkerState::B);
+    SlConfig::main_w_ptr->markEntry(sample.waking, DualMarkerState::A);
+}
+
+/**
+ * @brief Shows scheduling latencies of a stream, measuring them first
+ * if needed.
+ *
+ * @param stream_id: stream whose latencies to show
+ */
+void SlLatencyView::show_stream(int stream_id) {
+    _stream_id = stream_id;
+    _stats = (stream_id >= 0) ? get_latency_stats(stream_id) : nullptr;
+    _fill_groups();
+    _fill_outliers();
+    show();
+}
+
+/**
+ * @brief Empties the window if it shows latencies which are about to
+ * be freed.
+ *
+ * @param stats: latencies to be freed
+ */
+void SlLatencyView::stats_freed(const SlLatencyStats* stats) {
+    if (_stats == stats) {
+        _stats = nullptr;
+        _fill_groups();
+        _fill_outliers();
+    }
+}
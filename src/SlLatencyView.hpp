@@ -0,0 +1,88 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlLatencyView.hpp
+ * @brief   Declares the window with wakeup-to-run latency percentiles per
+ *          CPU or task and the list of the worst latencies.
+ *
+ * @note    Definitions in `SlLatencyView.cpp`.
+*/
+
+#ifndef _SL_LATENCY_VIEW_HPP
+#define _SL_LATENCY_VIEW_HPP
+
+// C++
+#include <vector>
+
+// Qt
+#include <QtWidgets>
+
+// Plugin
+#include "SlLatency.hpp"
+
+/**
+ * @brief Window showing scheduling latencies of a stream - p50, p99 and
+ * maximum of delays between `sched_waking` and the switch-in of the woken
+ * task, per CPU or per task. Clicking one of the worst latencies marks its
+ * waking with KernelShark's marker A and its switch-in with marker B.
+ */
+class SlLatencyView : public QWidget {
+private: // Data members
+    ///
+    /// @brief Stream whose latencies are shown, -1 if none.
+    int _stream_id{-1};
+
+    ///
+    /// @brief Latencies which are shown, not owned.
+    const SlLatencyStats* _stats{nullptr};
+
+    ///
+    /// @brief Worst latencies, in the order they were inserted.
+    std::vector<SlLatencySample> _outliers;
+private: // Qt data members
+    ///
+    /// @brief Layout for the widget's control elements.
+    QVBoxLayout     _layout;
+
+    ///
+    /// @brief Layout for the grouping controls.
+    QHBoxLayout     _group_layout;
+
+    ///
+    /// @brief Explanation of the grouping combo box.
+    QLabel          _group_label;
+
+    ///
+    /// @brief Chooses the grouping - CPU or task.
+    QComboBox       _group_combo;
+
+    ///
+    /// @brief Percentiles of all latencies and counts of lost wakeups.
+    QLabel          _summary_label;
+
+    ///
+    /// @brief Table of percentiles per group.
+    QTableWidget    _groups_table;
+
+    ///
+    /// @brief Explanation of the outliers table.
+    QLabel          _outliers_label;
+
+    ///
+    /// @brief Table of the worst latencies.
+    QTableWidget    _outliers_table;
+public: // Qt data members
+    ///
+    /// @brief Close button for the widget.
+    QPushButton     _close_button;
+private: // Functions
+    void _fill_groups();
+    void _fill_outliers();
+    void _mark_outlier(int row);
+public: // Functions
+    SlLatencyView();
+    void show_stream(int stream_id);
+    void stats_freed(const SlLatencyStats* stats);
+};
+
+#endif
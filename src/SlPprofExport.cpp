@@ -0,0 +1,408 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlPprofExport.cpp
+ * @brief   Defines the exporter of kernel stacks to gzip-compressed pprof
+ *          profiles, encoding protocol buffers' wire format directly.
+*/
+
+// C
+#include <errno.h>
+#include <string.h>
+#include <zlib.h>
+
+// C++
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlPprofExport.hpp"
+#include "SlStackAggregate.hpp"
+
+// Static variables
+
+///
+/// @brief Size of zlib's buffer of the output file.
+static constexpr unsigned OUTPUT_BUFFER_SIZE = 1 << 20;
+
+///
+/// @brief Encoded bytes gathered before they are handed to zlib.
+static constexpr size_t FLUSH_THRESHOLD = 1 << 16;
+
+/// @brief Field numbers of pprof's `profile.proto` messages used by
+/// the exporter.
+enum _pprof_field : uint32_t {
+    PROFILE_SAMPLE_TYPE = 1,
+    PROFILE_SAMPLE = 2,
+    PROFILE_LOCATION = 4,
+    PROFILE_FUNCTION = 5,
+    PROFILE_STRING_TABLE = 6,
+    PROFILE_DURATION_NANOS = 10,
+    PROFILE_DEFAULT_SAMPLE_TYPE = 14,
+
+    VALUE_TYPE_TYPE = 1,
+    VALUE_TYPE_UNIT = 2,
+
+    SAMPLE_LOCATION_ID = 1,
+    SAMPLE_VALUE = 2,
+    SAMPLE_LABEL = 3,
+
+    LABEL_KEY = 1,
+    LABEL_STR = 2,
+    LABEL_NUM = 3,
+    LABEL_NUM_UNIT = 4,
+
+    LOCATION_ID = 1,
+    LOCATION_LINE = 4,
+
+    LINE_FUNCTION_ID = 1,
+
+    FUNCTION_ID = 1,
+    FUNCTION_NAME = 2,
+    FUNCTION_SYSTEM_NAME = 3
+};
+
+/// @brief Wire types of protocol buffers used by the exporter.
+enum _wire_type : uint32_t {
+    WIRE_VARINT = 0,
+    WIRE_LENGTH_DELIMITED = 2
+};
+
+// Static functions
+
+/**
+ * @brief Appends a base-128 variable-length integer.
+ *
+ * @param out: buffer to append to
+ * @param value: number to encode
+ */
+static void _put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += char(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out += char(uint8_t(value));
+}
+
+/**
+ * @brief Appends a field's key - its number and wire type.
+ *
+ * @param out: buffer to append to
+ * @param field: number of the field
+ * @param wire_type: wire type of the field's value
+ */
+static void _put_key(std::string& out, uint32_t field, uint32_t wire_type) {
+    _put_varint(out, (uint64_t(field) << 3) | wire_type);
+}
+
+/**
+ * @brief Appends an integer field. Zero is the default value of proto3
+ * and isn't written.
+ *
+ * @param out: buffer to append to
+ * @param field: number of the field
+ * @param value: value of the field
+ */
+static void _put_int(std::string& out, uint32_t field, int64_t value) {
+    if (value == 0)
+        return;
+    _put_key(out, field, WIRE_VARINT);
+    _put_varint(out, uint64_t(value));
+}
+
+/**
+ * @brief Appends a length-delimited field - a string or an encoded
+ * embedded message.
+ *
+ * @param out: buffer to append to
+ * @param field: number of the field
+ * @param bytes: value of the field
+ */
+static void _put_bytes(std::string& out, uint32_t field,
+                       std::string_view bytes) {
+    _put_key(out, field, WIRE_LENGTH_DELIMITED);
+    _put_varint(out, bytes.size());
+    out += bytes;
+}
+
+/**
+ * @brief Appends a packed repeated integer field.
+ *
+ * @param out: buffer to append to
+ * @param field: number of the field
+ * @param values: values of the field
+ * @param scratch: reused buffer for the packed values
+ */
+template<typename T>
+static void _put_packed(std::string& out, uint32_t field,
+                        const std::vector<T>& values, std::string& scratch) {
+    scratch.clear();
+    for (T value : values) {
+        _put_varint(scratch, uint64_t(value));
+    }
+    _put_bytes(out, field, scratch);
+}
+
+/**
+ * @brief Appends a label to an encoded sample.
+ *
+ * @param out: buffer to append to
+ * @param key: string table index of the label's key
+ * @param str: string table index of the label's text, `0` for none
+ * @param num: numerical value of the label, if it has no text
+ * @param num_unit: string table index of the numerical value's unit,
+ * `0` for none; pprof drops labels with neither text nor number nor unit,
+ * so numerical labels which may be zero need it
+ * @param scratch: reused buffer for the label
+ */
+static void _put_label(std::string& out, int64_t key, int64_t str,
+                       int64_t num, int64_t num_unit, std::string& scratch) {
+    scratch.clear();
+    _put_int(scratch, LABEL_KEY, key);
+    _put_int(scratch, LABEL_STR, str);
+    _put_int(scratch, LABEL_NUM, num);
+    _put_int(scratch, LABEL_NUM_UNIT, num_unit);
+    _put_bytes(out, SAMPLE_LABEL, scratch);
+}
+
+/**
+ * @brief String table of a profile. Index `0` is the empty string, as
+ * pprof requires.
+ */
+class _PprofStrings {
+private: // Data members
+    ///
+    /// @brief Strings in the order of their indices, kept for writing.
+    std::vector<std::string> _strings{""};
+
+    ///
+    /// @brief Index of each string.
+    std::unordered_map<std::string, int64_t> _indices{{"", 0}};
+public: // Functions
+    /**
+     * @brief Gets the index of a string, adding it if needed.
+     *
+     * @param text: the string
+     *
+     * @returns Index of the string in the table.
+     */
+    int64_t intern(std::string_view text) {
+        auto [it, inserted] = _indices.try_emplace(std::string(text),
+                                                   int64_t(_strings.size()));
+        if (inserted)
+            _strings.emplace_back(text);
+        return it->second;
+    }
+
+    /**
+     * @brief Gets all strings of the table.
+     *
+     * @returns Strings in the order of their indices.
+     */
+    const std::vector<std::string>& strings() const
+    { return _strings; }
+};
+
+/**
+ * @brief Buffered writer of encoded bytes into a gzip file.
+ */
+class _GzipOutput {
+private: // Data members
+    ///
+    /// @brief Opened file, nullptr if opening failed.
+    gzFile _file;
+
+    ///
+    /// @brief Whether all writes succeeded so far.
+    bool _ok;
+public: // Data members
+    ///
+    /// @brief Encoded bytes waiting to be written.
+    std::string pending;
+public: // Functions
+    /**
+     * @brief Opens the file for writing, overwriting it.
+     *
+     * @param path: path of the file
+     */
+    explicit _GzipOutput(const std::string& path)
+        : _file(gzopen(path.c_str(), "wb")), _ok(_file != nullptr) {
+        if (_file != nullptr)
+            gzbuffer(_file, OUTPUT_BUFFER_SIZE);
+        pending.reserve(FLUSH_THRESHOLD * 2);
+    }
+
+    _GzipOutput(const _GzipOutput&) = delete;
+    _GzipOutput& operator=(const _GzipOutput&) = delete;
+
+    /**
+     * @brief Closes the file, if it is still open.
+     */
+    ~_GzipOutput() {
+        if (_file != nullptr)
+            gzclose(_file);
+    }
+
+    /**
+     * @brief Hands pending bytes over to zlib, if there are enough of them
+     * or if forced to.
+     *
+     * @param force: whether to write even a few pending bytes
+     */
+    void flush(bool force = false) {
+        if (!_ok || pending.empty() || (!force && pending.size() < FLUSH_THRESHOLD))
+            return;
+        _ok = gzwrite(_file, pending.data(), unsigned(pending.size()))
+              == int(pending.size());
+        pending.clear();
+    }
+
+    /**
+     * @brief Writes pending bytes and closes the file.
+     *
+     * @returns True if everything was written, false otherwise.
+     */
+    bool close() {
+        flush(true);
+        if (_file != nullptr) {
+            _ok = (gzclose(_file) == Z_OK) && _ok;
+            _file = nullptr;
+        }
+        return _ok;
+    }
+
+    /**
+     * @brief Checks whether all writes succeeded so far.
+     *
+     * @returns True if no write failed, false otherwise.
+     */
+    bool ok() const
+    { return _ok; }
+};
+
+// Global functions
+
+/**
+ * @brief Writes kernel stacks of a stream as a gzip-compressed pprof
+ * profile. Stacks are aggregated by task, CPU and prev_state; each
+ * aggregate is a sample with the event count and blocked (off-CPU)
+ * nanoseconds as values and task, PID, CPU and prev_state as labels.
+ * Every interned symbol is one function and one location with the same
+ * ID (symbol ID plus one).
+ *
+ * Samples are encoded and compressed one by one, the string table, which
+ * collects strings as samples go, is written last. Protocol buffers allow
+ * fields of a message in any order.
+ *
+ * @param index: built index of the stream
+ * @param path: path of the output file, overwritten if it exists
+ *
+ * @returns Result of the export.
+ */
+SlExportResult export_pprof_profile(const SlStreamIndex& index,
+                                    const std::string& path) {
+    const std::vector<SlAggregatedStack> aggregated = aggregate_stacks(index, true);
+
+    _GzipOutput out{path};
+    if (!out.ok())
+        return {false, 0, path + ": " + strerror(errno)};
+
+    _PprofStrings strings;
+    std::string message;
+    std::string scratch;
+
+    // Sample types, count first, as it is the default one
+    const int64_t samples_str = strings.intern("samples");
+    for (auto [type, unit] : {std::pair{samples_str, strings.intern("count")},
+                              std::pair{strings.intern("blocked"),
+                                        strings.intern("nanoseconds")}}) {
+        message.clear();
+        _put_int(message, VALUE_TYPE_TYPE, type);
+        _put_int(message, VALUE_TYPE_UNIT, unit);
+        _put_bytes(out.pending, PROFILE_SAMPLE_TYPE, message);
+    }
+    _put_int(out.pending, PROFILE_DEFAULT_SAMPLE_TYPE, samples_str);
+
+    const int64_t task_key = strings.intern("task");
+    const int64_t pid_key = strings.intern("pid");
+    const int64_t cpu_key = strings.intern("cpu");
+    const int64_t prev_state_key = strings.intern("prev_state");
+    // CPU 0 and PID 0 would be dropped without a unit
+    const int64_t id_unit = strings.intern("id");
+
+    const SlStackTable& stacks = index.stacks();
+    std::vector<uint64_t> location_ids;
+    uint64_t written = 0;
+
+    for (const SlAggregatedStack& stack : aggregated) {
+        // Locations go from the leaf, which is what the index keeps first
+        location_ids.clear();
+        for (uint32_t symbol : stacks.frames(stack.stack_id)) {
+            location_ids.push_back(uint64_t(symbol) + 1);
+        }
+
+        const kshark_entry* sample = index.events()->data[stack.sample_event]->entry;
+        const char* task = kshark_get_task(sample);
+
+        message.clear();
+        _put_packed(message, SAMPLE_LOCATION_ID, location_ids, scratch);
+        _put_packed(message, SAMPLE_VALUE,
+                    std::vector<uint64_t>{stack.count, stack.off_cpu_ns}, scratch);
+        _put_label(message, task_key,
+                   strings.intern((task != nullptr) ? task : "<unknown>"),
+                   0, 0, scratch);
+        _put_label(message, pid_key, 0, stack.pid, id_unit, scratch);
+        _put_label(message, cpu_key, 0, stack.cpu, id_unit, scratch);
+        if (stack.prev_state != 0) {
+            _put_label(message, prev_state_key,
+                       strings.intern(std::string_view(&stack.prev_state, 1)),
+                       0, 0, scratch);
+        }
+        _put_bytes(out.pending, PROFILE_SAMPLE, message);
+
+        ++written;
+        out.flush();
+    }
+
+    const SlSymbolTable& symbols = index.symbols();
+    for (uint32_t symbol = 0; symbol < symbols.size(); ++symbol) {
+        const int64_t id = int64_t(symbol) + 1;
+        const int64_t name = strings.intern(symbols.text(symbol));
+
+        message.clear();
+        _put_int(message, FUNCTION_ID, id);
+        _put_int(message, FUNCTION_NAME, name);
+        _put_int(message, FUNCTION_SYSTEM_NAME, name);
+        _put_bytes(out.pending, PROFILE_FUNCTION, message);
+
+        scratch.clear();
+        _put_int(scratch, LINE_FUNCTION_ID, id);
+        message.clear();
+        _put_int(message, LOCATION_ID, id);
+        _put_bytes(message, LOCATION_LINE, scratch);
+        _put_bytes(out.pending, PROFILE_LOCATION, message);
+
+        out.flush();
+    }
+
+    if (index.size() > 0) {
+        const kshark_data_container* events = index.events();
+        _put_int(out.pending, PROFILE_DURATION_NANOS,
+                 events->data[index.size() - 1]->entry->ts
+                 - events->data[0]->entry->ts);
+    }
+
+    for (const std::string& text : strings.strings()) {
+        _put_bytes(out.pending, PROFILE_STRING_TABLE, text);
+        out.flush();
+    }
+
+    if (!out.close())
+        return {false, written, path + ": writing the compressed profile failed"};
+
+    return {true, written, {}};
+}
@@ -0,0 +1,25 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlPprofExport.hpp
+ * @brief   Declares the exporter of kernel stacks to gzip-compressed pprof
+ *          profiles. Doesn't depend on Qt, so it can be used without
+ *          the GUI.
+ *
+ * @note    Definitions in `SlPprofExport.cpp`.
+*/
+
+#ifndef _SL_PPROF_EXPORT_HPP
+#define _SL_PPROF_EXPORT_HPP
+
+// C++
+#include <string>
+
+// Plugin
+#include "SlStackAggregate.hpp"
+#include "SlStreamIndex.hpp"
+
+SlExportResult export_pprof_profile(const SlStreamIndex& index,
+                                    const std::string& path);
+
+#endif
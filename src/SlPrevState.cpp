@@ -5,8 +5,12 @@
  * @brief   This file has definitions of the prev_state get-functions.
 */
 
+// C
+#include <stdlib.h>
+
 // C++
 #include <string>
+#include <string_view>
 
 // KernelShark
 #include "libkshark.h"
@@ -16,22 +20,40 @@
 
 // Global functions
 
+/**
+ * @brief Parses the abbreviated name of a prev_state out of the info
+ * text of a `sched/sched_switch` event, where it is the letter right
+ * before the " ==>" arrow.
+ * 
+ * @param info: info text of the event
+ * 
+ * @returns The letter, `0` if the text has no arrow in it.
+ */
+char parse_switch_prev_state(std::string_view info) {
+    const std::size_t arrow = info.find(" ==>");
+    return (arrow == std::string_view::npos || arrow == 0) ? 0 : info[arrow - 1];
+}
+
 /**
  * @brief Gets the abbreviated name of a prev_state from the info field of a
  * KernelShark entry using the specific format of the entries in KernelShark.
  * 
  * @param entry: `sched/sched_switch` event entry whose prev_state we wish to get
  *  
- * @returns Const C++ string with only one member - the name abbreviation.
+ * @returns Const C++ string with only one member - the name abbreviation,
+ * empty if the info has no prev_state in it.
  * 
  * @note Returning the string is more useful as the value is used a lot
- * in string concatenations.
+ * in string concatenations. The info text is allocated by KernelShark
+ * and freed here.
  */
 const std::string get_switch_prev_state(const kshark_entry* entry) {
-    auto info_as_str = std::string(kshark_get_info(entry));
-    std::size_t start = info_as_str.find(" ==>");
-    auto prev_state = info_as_str.substr(start - 1, 1);
-    return prev_state;
+    char* info = kshark_get_info(entry);
+    if (info == nullptr)
+        return {};
+    const char letter = parse_switch_prev_state(info);
+    free(info);
+    return (letter != 0) ? std::string(1, letter) : std::string{};
 }
 
 /**
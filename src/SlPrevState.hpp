@@ -12,6 +12,7 @@
 
 // C++
 #include <string>
+#include <string_view>
 #include <map>
 
 // KernelShark
@@ -35,6 +36,7 @@ static const std::map<char, const char*> LETTER_TO_NAME {{
 }};
 
 // Global functions
+char parse_switch_prev_state(std::string_view info);
 const std::string get_switch_prev_state(const kshark_entry* entry);
 const std::string get_longer_prev_state(const kshark_entry* entry);
 
@@ -0,0 +1,452 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlRangeCounts.cpp
+ * @brief   Defines per-CPU and per-task prefix sums of collected events
+ *          with kernel stacks and their stratified sampling.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin
+#include "SlRangeCounts.hpp"
+#include "SlPrevState.hpp"
+#include "SlSelfTrace.h"
+
+// Global functions
+
+/**
+ * @brief Gets the kind a switch is counted as by its prev_state.
+ *
+ * @param prev_state: prev_state letter of the switch, `0` if unknown
+ *
+ * @returns Kind of the switch.
+ */
+SlCountKind count_kind_of_state(char prev_state) {
+    switch (prev_state) {
+    case 'S':
+        return SlCountKind::SWITCH_SLEEPING;
+    case 'D':
+        return SlCountKind::SWITCH_DISK;
+    case 'R':
+        return SlCountKind::SWITCH_RUNNING;
+    case 'I':
+        return SlCountKind::SWITCH_IDLE;
+    default:
+        return SlCountKind::SWITCH_OTHER;
+    }
+}
+
+/**
+ * @brief Sums counts of all kinds.
+ *
+ * @param counts: counts by kind
+ *
+ * @returns Number of events of any kind.
+ */
+uint32_t total_count(const SlKindCounts& counts) {
+    uint32_t total = 0;
+    for (uint32_t count : counts) {
+        total += count;
+    }
+    return total;
+}
+
+/**
+ * @brief Finds the kind which best describes a range. Switches win over
+ * other kinds, as their prev_state tells the most, then wakings.
+ *
+ * @param counts: counts by kind, not all zero
+ *
+ * @returns The most frequent switch kind, if there are switches, else
+ * wakings, if there are any, else other events.
+ */
+SlCountKind dominant_kind(const SlKindCounts& counts) {
+    const size_t switch_kinds = size_t(SlCountKind::SWITCH_OTHER) + 1;
+    const auto most = std::max_element(counts.begin(),
+                                       counts.begin() + switch_kinds);
+    if (*most > 0)
+        return SlCountKind(most - counts.begin());
+
+    return (counts[size_t(SlCountKind::WAKING)] > 0) ?
+        SlCountKind::WAKING : SlCountKind::OTHER_EVENT;
+}
+
+// SlRangeCounts
+
+/**
+ * @brief Appends an event to a series, along with a row of prefix sums
+ * counting it.
+ *
+ * @param series: events of a CPU or task
+ * @param event_idx: container index of the event, higher than indices
+ * already in the series
+ * @param kind: kind of the event
+ */
+void SlRangeCounts::_append(_Series& series, uint32_t event_idx,
+                            SlCountKind kind) {
+    series.events.push_back(event_idx);
+
+    const size_t last_row = series.prefix.size() - SL_COUNT_KINDS;
+    for (size_t k = 0; k < SL_COUNT_KINDS; ++k) {
+        series.prefix.push_back(series.prefix[last_row + k]);
+    }
+    ++series.prefix[series.prefix.size() - SL_COUNT_KINDS + size_t(kind)];
+}
+
+/**
+ * @brief Builds prefix sums of enabled collected events with kernel stacks
+ * in one pass over the container, straight from association results, so
+ * that stacks don't have to be indexed first. Earlier counts are
+ * discarded. Off-CPU time of a switch is measured along the way, it lasts
+ * until the next switch whose `next_pid` is the switched out task.
+ *
+ * @param events: sorted container of collected events with associated
+ * kernel stacks, it must outlive the counts
+ * @param registry: event registry of the stream, events it doesn't
+ * enable aren't counted
+ * @param sswitch_event_id: numerical id of the stream's sched_switch event
+ * @param swaking_event_id: numerical id of the stream's sched_waking event
+ */
+void SlRangeCounts::build(const kshark_data_container* events,
+                          const SlEventRegistry& registry,
+                          int sswitch_event_id, int swaking_event_id) {
+    SL_TRACE_SCOPE("build_range_counts");
+
+    _events = events;
+    _generation = registry.generation();
+    _per_cpu.clear();
+    _per_task.clear();
+    _kinds.assign(size_t(events->size), NO_KIND);
+    _off_cpu.assign(size_t(events->size), 0);
+
+    // Switches with stacks whose tasks weren't switched in again yet, by PID
+    std::unordered_map<int32_t, ssize_t> switched_out;
+
+    for (ssize_t i = 0; i < events->size; ++i) {
+        const kshark_entry* entry = _events->data[i]->entry;
+        const bool is_switch = (entry->event_id == sswitch_event_id);
+
+        int64_t next_pid;
+        if (is_switch
+            && kshark_read_event_field_int(entry, "next_pid", &next_pid) >= 0) {
+            auto back_on_cpu = switched_out.find(int32_t(next_pid));
+            if (back_on_cpu != switched_out.end()) {
+                _off_cpu[back_on_cpu->second] = entry->ts
+                    - _events->data[back_on_cpu->second]->entry->ts;
+                switched_out.erase(back_on_cpu);
+            }
+        }
+
+        // Field is -1 if the kernel stack wasn't found
+        if (_events->data[i]->field == -1)
+            continue;
+
+        const SlEventDescriptor* descriptor = registry.find(entry->event_id);
+        if (descriptor == nullptr || !descriptor->enabled)
+            continue;
+
+        // Stack belongs to the task which ran when it was taken
+        const int32_t switched_pid = is_switch ? kshark_get_pid(entry) : 0;
+        if (switched_pid > 0)
+            switched_out[switched_pid] = i;
+
+        SlCountKind kind = SlCountKind::OTHER_EVENT;
+        if (entry->event_id == sswitch_event_id) {
+            kind = count_kind_of_state(get_switch_prev_state(entry)[0]);
+        } else if (entry->event_id == swaking_event_id) {
+            kind = SlCountKind::WAKING;
+        }
+
+        _kinds[i] = uint8_t(kind);
+        if (entry->cpu >= 0) {
+            if ((size_t)entry->cpu >= _per_cpu.size())
+                _per_cpu.resize((size_t)entry->cpu + 1);
+            _append(_per_cpu[entry->cpu], uint32_t(i), kind);
+        }
+        _append(_per_task[entry->pid], uint32_t(i), kind);
+    }
+}
+
+/**
+ * @brief Finds the first event of a series at or after a timestamp.
+ *
+ * @param series: events of a CPU or task
+ * @param from: event of the series to search from, no event before it
+ * may be at or after the timestamp
+ * @param ts: timestamp to search for
+ *
+ * @returns Position of the first event with timestamp not lower than
+ * `ts`, the end of the series if there is none.
+ */
+std::vector<uint32_t>::const_iterator SlRangeCounts::_boundary(
+        const _Series& series, std::vector<uint32_t>::const_iterator from,
+        int64_t ts) const {
+    const kshark_data_container* events = _events;
+    return std::lower_bound(from, series.events.cend(), ts,
+        [events](uint32_t event_idx, int64_t time) {
+            return events->data[event_idx]->entry->ts < time;
+        });
+}
+
+/**
+ * @brief Counts events of a series between two of its positions as the
+ * difference of their prefix rows.
+ *
+ * @param series: events of a CPU or task
+ * @param first: position of the first counted event
+ * @param last: position after the last counted event
+ *
+ * @returns Counts of the events by kind.
+ */
+SlKindCounts SlRangeCounts::_between(const _Series& series,
+                                     std::vector<uint32_t>::const_iterator first,
+                                     std::vector<uint32_t>::const_iterator last) const {
+    const size_t begin_row = size_t(first - series.events.cbegin()) * SL_COUNT_KINDS;
+    const size_t end_row = size_t(last - series.events.cbegin()) * SL_COUNT_KINDS;
+
+    SlKindCounts counts;
+    for (size_t k = 0; k < SL_COUNT_KINDS; ++k) {
+        counts[k] = series.prefix[end_row + k] - series.prefix[begin_row + k];
+    }
+    return counts;
+}
+
+/**
+ * @brief Counts events of a series in a time range.
+ *
+ * @param series: events of a CPU or task, nullptr for none
+ * @param t0: start of the range, inclusive
+ * @param t1: end of the range, inclusive
+ *
+ * @returns Counts of the events in the range by kind.
+ */
+SlKindCounts SlRangeCounts::_count(const _Series* series,
+                                   int64_t t0, int64_t t1) const {
+    if (series == nullptr || t1 < t0)
+        return SlKindCounts{};
+
+    auto first = _boundary(*series, series->events.cbegin(), t0);
+    auto last = _boundary(*series, first, t1 + 1);
+    return _between(*series, first, last);
+}
+
+/**
+ * @brief Counts events of a series in consecutive bins of equal size.
+ * Neighbouring bins share their boundary, so it's searched for only once.
+ *
+ * @param series: events of a CPU or task, nullptr for none
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin, at least one
+ * @param n_bins: number of bins
+ * @param bins: output vector for the counts of each bin, it is resized
+ */
+void SlRangeCounts::_count_bins(const _Series* series, int64_t first_ts,
+                                int64_t bin_size, size_t n_bins,
+                                std::vector<SlKindCounts>& bins) const {
+    bins.assign(n_bins, SlKindCounts{});
+    if (series == nullptr || bin_size <= 0)
+        return;
+
+    auto bin_begin = _boundary(*series, series->events.cbegin(), first_ts);
+    for (size_t b = 0; b < n_bins && bin_begin != series->events.cend(); ++b) {
+        auto bin_end = _boundary(*series, bin_begin,
+                                 first_ts + int64_t(b + 1) * bin_size);
+        bins[b] = _between(*series, bin_begin, bin_end);
+        bin_begin = bin_end;
+    }
+}
+
+/**
+ * @brief Picks at most one event per stratum of consecutive bins, so that
+ * at most the wanted number of events represents the whole range.
+ *
+ * An event of the kind rarest in the whole range wins, as it stands out
+ * the most, then the one which kept its task off CPU the longest, then
+ * the earliest one. The choice therefore depends only on the range and
+ * the events, not on the order of draws.
+ *
+ * @param series: events of a CPU or task, nullptr for none
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin, at least one
+ * @param n_bins: number of bins
+ * @param max_samples: maximal number of picked events
+ * @param accept: predicate telling which events may be picked
+ * @param samples: output vector for container indices of the picked
+ * events, ascending; it is cleared first
+ */
+void SlRangeCounts::_sample_bins(const _Series* series, int64_t first_ts,
+                                 int64_t bin_size, size_t n_bins,
+                                 size_t max_samples, const accept_t& accept,
+                                 std::vector<uint32_t>& samples) const {
+    samples.clear();
+    if (series == nullptr || bin_size <= 0 || n_bins == 0 || max_samples == 0)
+        return;
+
+    // Strata are made of whole bins, so a button never falls between them
+    const size_t strata = std::min(max_samples, n_bins);
+    const int64_t stratum_size = bin_size * int64_t((n_bins + strata - 1) / strata);
+    const int64_t last_ts = first_ts + int64_t(n_bins) * bin_size;
+
+    auto stratum_begin = _boundary(*series, series->events.cbegin(), first_ts);
+    const SlKindCounts in_range = _between(*series, stratum_begin,
+        _boundary(*series, stratum_begin, last_ts));
+
+    auto is_better = [this, &in_range](uint32_t a, uint32_t b) {
+        const uint32_t rarity_a = in_range[_kinds[a]];
+        const uint32_t rarity_b = in_range[_kinds[b]];
+        if (rarity_a != rarity_b)
+            return rarity_a < rarity_b;
+        // Full ties keep the earlier event, which is seen first
+        return _off_cpu[a] > _off_cpu[b];
+    };
+
+    for (int64_t start = first_ts;
+         start < last_ts && stratum_begin != series->events.cend();
+         start += stratum_size) {
+        auto stratum_end = _boundary(*series, stratum_begin,
+                                     std::min(start + stratum_size, last_ts));
+
+        bool found = false;
+        uint32_t best = 0;
+        for (auto it = stratum_begin; it != stratum_end; ++it) {
+            if ((!found || is_better(*it, best)) && accept(*it)) {
+                best = *it;
+                found = true;
+            }
+        }
+        if (found)
+            samples.push_back(best);
+
+        stratum_begin = stratum_end;
+    }
+}
+
+/**
+ * @brief Counts events with kernel stacks on a CPU in a time range.
+ *
+ * @param cpu: CPU of the events
+ * @param t0: start of the range, inclusive
+ * @param t1: end of the range, inclusive
+ *
+ * @returns Counts of the events in the range by kind.
+ */
+SlKindCounts SlRangeCounts::count_cpu(int16_t cpu, int64_t t0, int64_t t1) const {
+    const bool known = cpu >= 0 && (size_t)cpu < _per_cpu.size();
+    return _count(known ? &_per_cpu[cpu] : nullptr, t0, t1);
+}
+
+/**
+ * @brief Counts events with kernel stacks of a task in a time range.
+ *
+ * @param pid: PID of the task
+ * @param t0: start of the range, inclusive
+ * @param t1: end of the range, inclusive
+ *
+ * @returns Counts of the events in the range by kind.
+ */
+SlKindCounts SlRangeCounts::count_task(int32_t pid, int64_t t0, int64_t t1) const {
+    auto found = _per_task.find(pid);
+    return _count((found != _per_task.end()) ? &found->second : nullptr, t0, t1);
+}
+
+/**
+ * @brief Counts events with kernel stacks on a CPU in consecutive bins
+ * of equal size, e.g. those of KernelShark's histogram.
+ *
+ * @param cpu: CPU of the events
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin
+ * @param n_bins: number of bins
+ * @param bins: output vector for the counts of each bin, it is resized
+ */
+void SlRangeCounts::count_cpu_bins(int16_t cpu, int64_t first_ts, int64_t bin_size,
+                                   size_t n_bins, std::vector<SlKindCounts>& bins) const {
+    const bool known = cpu >= 0 && (size_t)cpu < _per_cpu.size();
+    _count_bins(known ? &_per_cpu[cpu] : nullptr, first_ts, bin_size, n_bins, bins);
+}
+
+/**
+ * @brief Counts events with kernel stacks of a task in consecutive bins
+ * of equal size, e.g. those of KernelShark's histogram.
+ *
+ * @param pid: PID of the task
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin
+ * @param n_bins: number of bins
+ * @param bins: output vector for the counts of each bin, it is resized
+ */
+void SlRangeCounts::count_task_bins(int32_t pid, int64_t first_ts, int64_t bin_size,
+                                    size_t n_bins, std::vector<SlKindCounts>& bins) const {
+    auto found = _per_task.find(pid);
+    _count_bins((found != _per_task.end()) ? &found->second : nullptr,
+                first_ts, bin_size, n_bins, bins);
+}
+
+/**
+ * @brief Picks at most the wanted number of events with kernel stacks on
+ * a CPU to represent a range of bins, one per stratum of consecutive bins.
+ *
+ * @param cpu: CPU of the events
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin
+ * @param n_bins: number of bins
+ * @param max_samples: maximal number of picked events
+ * @param accept: predicate telling which events may be picked
+ * @param samples: output vector for container indices of the picked events
+ */
+void SlRangeCounts::sample_cpu_bins(int16_t cpu, int64_t first_ts, int64_t bin_size,
+                                    size_t n_bins, size_t max_samples,
+                                    const accept_t& accept,
+                                    std::vector<uint32_t>& samples) const {
+    const bool known = cpu >= 0 && (size_t)cpu < _per_cpu.size();
+    _sample_bins(known ? &_per_cpu[cpu] : nullptr, first_ts, bin_size, n_bins,
+                 max_samples, accept, samples);
+}
+
+/**
+ * @brief Picks at most the wanted number of events with kernel stacks of
+ * a task to represent a range of bins, one per stratum of consecutive bins.
+ *
+ * @param pid: PID of the task
+ * @param first_ts: start of the first bin
+ * @param bin_size: length of each bin
+ * @param n_bins: number of bins
+ * @param max_samples: maximal number of picked events
+ * @param accept: predicate telling which events may be picked
+ * @param samples: output vector for container indices of the picked events
+ */
+void SlRangeCounts::sample_task_bins(int32_t pid, int64_t first_ts, int64_t bin_size,
+                                     size_t n_bins, size_t max_samples,
+                                     const accept_t& accept,
+                                     std::vector<uint32_t>& samples) const {
+    auto found = _per_task.find(pid);
+    _sample_bins((found != _per_task.end()) ? &found->second : nullptr,
+                 first_ts, bin_size, n_bins, max_samples, accept, samples);
+}
+
+/**
+ * @brief Gets how long a switch kept its task off CPU.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns Nanoseconds until the task was switched in again, `0` for
+ * other events, switches without a kernel stack and tasks never switched
+ * in again.
+ */
+int64_t SlRangeCounts::off_cpu_of(ssize_t event_idx) const {
+    return (event_idx >= 0 && event_idx < (ssize_t)_off_cpu.size()) ?
+        _off_cpu[event_idx] : 0;
+}
+
+/**
+ * @brief Gets the generation of the configuration whose enabled events
+ * were counted. Counts of an older generation may be out of date.
+ *
+ * @returns Configuration generation of the last build, `0` if there was
+ * none.
+ */
+uint64_t SlRangeCounts::generation() const {
+    return _generation;
+}
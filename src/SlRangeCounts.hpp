@@ -0,0 +1,167 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlRangeCounts.hpp
+ * @brief   Declares per-CPU and per-task prefix sums of collected events
+ *          with kernel stacks, which count such events in any time range
+ *          without scanning them, and stratified sampling of the events.
+ *          Doesn't depend on Qt.
+ *
+ * @note    Definitions in `SlRangeCounts.cpp`.
+*/
+
+#ifndef _SL_RANGE_COUNTS_HPP
+#define _SL_RANGE_COUNTS_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <array>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlEventRegistry.hpp"
+
+/**
+ * @brief Kinds events with kernel stacks are counted by. Switches are
+ * split by their prev_state.
+ */
+enum class SlCountKind : uint8_t {
+    ///
+    /// @brief Switch of a sleeping task, prev_state `S`.
+    SWITCH_SLEEPING = 0,
+    ///
+    /// @brief Switch of a task in uninterruptible sleep, prev_state `D`.
+    SWITCH_DISK,
+    ///
+    /// @brief Switch of a preempted task, prev_state `R`.
+    SWITCH_RUNNING,
+    ///
+    /// @brief Switch of an idle kernel thread, prev_state `I`.
+    SWITCH_IDLE,
+    ///
+    /// @brief Switch with any other or unknown prev_state.
+    SWITCH_OTHER,
+    ///
+    /// @brief Waking of a task.
+    WAKING,
+    ///
+    /// @brief Any other collected event.
+    OTHER_EVENT
+};
+
+///
+/// @brief Number of kinds in `SlCountKind`.
+constexpr size_t SL_COUNT_KINDS = 7;
+
+///
+/// @brief Counts of events in a range, indexed by `SlCountKind`.
+using SlKindCounts = std::array<uint32_t, SL_COUNT_KINDS>;
+
+/**
+ * @brief Counts of collected events with kernel stacks in time ranges,
+ * per CPU and per task. Each CPU and task has the ascending container
+ * indices of its events and prefix sums of their kinds, so counting the
+ * events in `[t0, t1]` takes two binary searches and a subtraction.
+ *
+ * Dense ranges can also be sampled - split into strata of whole bins,
+ * each represented by a single event chosen deterministically.
+ *
+ * Only events enabled in the stream's event registry are counted, as
+ * only they get buttons. Visibility filters aren't taken into account.
+ * The counts refer to the container they were built from and must be
+ * freed before it is.
+ */
+class SlRangeCounts {
+public: // Types
+    ///
+    /// @brief Predicate telling whether an event, by its container index,
+    /// may be sampled.
+    using accept_t = std::function<bool(uint32_t event_idx)>;
+private: // Class data members
+    ///
+    /// @brief Kind of events without a kernel stack in `_kinds`.
+    static constexpr uint8_t NO_KIND = UINT8_MAX;
+private: // Types
+    /**
+     * @brief Events of one CPU or task along with prefix sums of their
+     * kinds.
+     */
+    struct _Series {
+        ///
+        /// @brief Container indices of the events, ascending.
+        std::vector<uint32_t> events;
+        /// @brief Counts of each kind among the first `n` events, for `n`
+        /// from zero to the number of events, one row after another.
+        std::vector<uint32_t> prefix = std::vector<uint32_t>(SL_COUNT_KINDS, 0);
+    };
+private: // Data members
+    ///
+    /// @brief Container of collected events the counts were built over.
+    const kshark_data_container* _events{nullptr};
+
+    ///
+    /// @brief Events of each CPU, by CPU number.
+    std::vector<_Series> _per_cpu;
+
+    ///
+    /// @brief Events of each task, by PID.
+    std::unordered_map<int32_t, _Series> _per_task;
+
+    ///
+    /// @brief Kind of each collected event, by container index.
+    std::vector<uint8_t> _kinds;
+
+    /// @brief Nanoseconds each switch with a kernel stack kept its task
+    /// off CPU, by container index, `0` for other events.
+    std::vector<int64_t> _off_cpu;
+
+    /// @brief Generation of the configuration whose enabled events were
+    /// counted.
+    uint64_t _generation{0};
+private: // Functions
+    void _append(_Series& series, uint32_t event_idx, SlCountKind kind);
+    std::vector<uint32_t>::const_iterator _boundary(
+        const _Series& series, std::vector<uint32_t>::const_iterator from,
+        int64_t ts) const;
+    SlKindCounts _between(const _Series& series,
+                          std::vector<uint32_t>::const_iterator first,
+                          std::vector<uint32_t>::const_iterator last) const;
+    SlKindCounts _count(const _Series* series, int64_t t0, int64_t t1) const;
+    void _count_bins(const _Series* series, int64_t first_ts, int64_t bin_size,
+                     size_t n_bins, std::vector<SlKindCounts>& bins) const;
+    void _sample_bins(const _Series* series, int64_t first_ts, int64_t bin_size,
+                      size_t n_bins, size_t max_samples, const accept_t& accept,
+                      std::vector<uint32_t>& samples) const;
+public: // Functions
+    void build(const kshark_data_container* events,
+               const SlEventRegistry& registry, int sswitch_event_id,
+               int swaking_event_id);
+    SlKindCounts count_cpu(int16_t cpu, int64_t t0, int64_t t1) const;
+    SlKindCounts count_task(int32_t pid, int64_t t0, int64_t t1) const;
+    void count_cpu_bins(int16_t cpu, int64_t first_ts, int64_t bin_size,
+                        size_t n_bins, std::vector<SlKindCounts>& bins) const;
+    void count_task_bins(int32_t pid, int64_t first_ts, int64_t bin_size,
+                         size_t n_bins, std::vector<SlKindCounts>& bins) const;
+    void sample_cpu_bins(int16_t cpu, int64_t first_ts, int64_t bin_size,
+                         size_t n_bins, size_t max_samples, const accept_t& accept,
+                         std::vector<uint32_t>& samples) const;
+    void sample_task_bins(int32_t pid, int64_t first_ts, int64_t bin_size,
+                          size_t n_bins, size_t max_samples, const accept_t& accept,
+                          std::vector<uint32_t>& samples) const;
+    int64_t off_cpu_of(ssize_t event_idx) const;
+    uint64_t generation() const;
+};
+
+SlCountKind count_kind_of_state(char prev_state);
+uint32_t total_count(const SlKindCounts& counts);
+SlCountKind dominant_kind(const SlKindCounts& counts);
+
+#endif
@@ -0,0 +1,204 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlSelfTrace.cpp
+ * @brief   Defines self-tracing of the plugin.
+ *
+ *          Finished spans go into a ring buffer of fixed capacity, the newest
+ *          overwriting the oldest. Writers claim slots with one atomic
+ *          increment and publish them with a per-slot sequence number, so
+ *          neither writers nor the flush ever block. The flush skips slots
+ *          which are being written or were overwritten while read.
+*/
+
+// C
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+
+// Plugin
+#include "SlSelfTrace.h"
+
+// Static variables
+
+///
+/// @brief Spans kept by default, configurable via `SL_SELF_TRACE_SPANS`.
+static constexpr uint64_t DEFAULT_CAPACITY = uint64_t(1) << 16;
+
+/**
+ * @brief Slot of the ring buffer holding one finished span.
+ */
+struct _TraceSlot {
+    /// @brief Twice the index of the span plus one while it's being written,
+    /// plus two once it's written.
+    std::atomic<uint64_t> seq{0};
+    ///
+    /// @brief Name of the span.
+    std::atomic<const char*> name{nullptr};
+    ///
+    /// @brief Start in nanoseconds of the monotonic clock.
+    std::atomic<uint64_t> start{0};
+    ///
+    /// @brief Duration in nanoseconds.
+    std::atomic<uint64_t> duration{0};
+    ///
+    /// @brief Thread which made the span.
+    std::atomic<uint32_t> tid{0};
+};
+
+///
+/// @brief Path of the output file, empty if self-tracing is off.
+static std::string output_path;
+
+///
+/// @brief Number of slots, a power of two.
+static uint64_t capacity = 0;
+
+///
+/// @brief Slots of the ring buffer.
+static std::unique_ptr<_TraceSlot[]> ring;
+
+///
+/// @brief Index of the next span to be written.
+static std::atomic<uint64_t> head{0};
+
+// Static functions
+
+/**
+ * @brief Gets the ID of the calling thread, cached per thread.
+ *
+ * @returns The thread ID.
+ */
+static uint32_t _thread_id() {
+    static thread_local const uint32_t tid = uint32_t(syscall(SYS_gettid));
+    return tid;
+}
+
+/**
+ * @brief Switches self-tracing on if the environment asks for it,
+ * allocates the ring buffer and flushes it at exit.
+ *
+ * @returns Whether self-tracing is on.
+ */
+static bool _init_from_env() {
+    const char* path = getenv("SL_SELF_TRACE");
+    if (path == nullptr || *path == '\0')
+        return false;
+
+    const char* spans = getenv("SL_SELF_TRACE_SPANS");
+    const uint64_t wanted = (spans != nullptr) ? strtoull(spans, nullptr, 10) : 0;
+    capacity = 1;
+    while (capacity < std::max<uint64_t>(wanted ? wanted : DEFAULT_CAPACITY, 2)) {
+        capacity <<= 1;
+    }
+
+    output_path = path;
+    ring = std::make_unique<_TraceSlot[]>(capacity);
+    atexit(sl_self_trace_flush);
+    return true;
+}
+
+// Global variables
+
+bool sl_self_trace_active = _init_from_env();
+
+// Global functions
+
+/**
+ * @brief Gets the current time of the monotonic clock.
+ *
+ * @returns Nanoseconds of the clock, never `0`.
+ */
+uint64_t sl_self_trace_now(void) {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1'000'000'000u + uint64_t(now.tv_nsec) + 1;
+}
+
+/**
+ * @brief Ends a span, putting it into the ring buffer.
+ *
+ * @param name: name of the span, must be a string literal
+ * @param start: start of the span from `sl_self_trace_now`
+ */
+void sl_self_trace_end(const char* name, uint64_t start) {
+    if (!sl_self_trace_active)
+        return;
+
+    sl_self_trace_span(name, start, sl_self_trace_now());
+}
+
+/**
+ * @brief Puts a span which has already ended into the ring buffer, e.g.
+ * one covering many short calls.
+ *
+ * @param name: name of the span, must be a string literal
+ * @param start: start of the span from `sl_self_trace_now`
+ * @param end: end of the span from `sl_self_trace_now`
+ */
+void sl_self_trace_span(const char* name, uint64_t start, uint64_t end) {
+    if (!sl_self_trace_active)
+        return;
+
+    const uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    _TraceSlot& slot = ring[index & (capacity - 1)];
+
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.tid.store(_thread_id(), std::memory_order_relaxed);
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Writes spans in the ring buffer, oldest first, into the output
+ * file as Chrome trace-event JSON, replacing its previous content.
+ * Spans keep being recorded meanwhile.
+ */
+void sl_self_trace_flush(void) {
+    if (!sl_self_trace_active)
+        return;
+
+    FILE* out = fopen(output_path.c_str(), "w");
+    if (out == nullptr) {
+        perror(output_path.c_str());
+        return;
+    }
+
+    const int pid = int(getpid());
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"args\":{\"name\":\"stacklook\"}}", pid);
+
+    const uint64_t end = head.load(std::memory_order_acquire);
+    const uint64_t begin = (end > capacity) ? end - capacity : 0;
+    for (uint64_t index = begin; index < end; ++index) {
+        const _TraceSlot& slot = ring[index & (capacity - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != 2 * index + 2)
+            continue;
+        const char* name = slot.name.load(std::memory_order_relaxed);
+        const uint64_t start = slot.start.load(std::memory_order_relaxed);
+        const uint64_t duration = slot.duration.load(std::memory_order_relaxed);
+        const uint32_t tid = slot.tid.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != 2 * index + 2)
+            continue;
+
+        fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"stacklook\",\"ph\":\"X\","
+                "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}", name,
+                double(start) / 1e3, double(duration) / 1e3, pid, tid);
+    }
+
+    fprintf(out, "\n]}\n");
+    fclose(out);
+}
@@ -0,0 +1,82 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlSelfTrace.h
+ * @brief   Declares self-tracing of the plugin - timed spans of its own
+ *          work, kept in a lock-free ring buffer and written out as
+ *          Chrome/Perfetto trace-event JSON.
+ *
+ *          Self-tracing is on if the environment variable `SL_SELF_TRACE`
+ *          names the output file when the plugin is loaded. When it is off,
+ *          a span costs one check of a global flag. Usable from C and C++.
+ *
+ * @note    Definitions in `SlSelfTrace.cpp`.
+*/
+
+#ifndef _SL_SELF_TRACE_H
+#define _SL_SELF_TRACE_H
+
+// C
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///
+/// @brief Whether self-tracing is on. Set once, when the plugin is loaded.
+extern bool sl_self_trace_active;
+
+uint64_t sl_self_trace_now(void);
+void sl_self_trace_end(const char* name, uint64_t start);
+void sl_self_trace_span(const char* name, uint64_t start, uint64_t end);
+void sl_self_trace_flush(void);
+
+#ifdef __cplusplus
+}
+
+/**
+ * @brief Span of self-tracing lasting until the end of its scope.
+ */
+class SlTraceSpan {
+private: // Data members
+    ///
+    /// @brief Name of the span, must be a string literal.
+    const char* _name;
+
+    ///
+    /// @brief Start of the span, `0` if self-tracing is off.
+    uint64_t _start;
+public: // Functions
+    /**
+     * @brief Starts the span, if self-tracing is on.
+     *
+     * @param name: name of the span, must be a string literal
+     */
+    explicit SlTraceSpan(const char* name)
+        : _name(name), _start(sl_self_trace_active ? sl_self_trace_now() : 0) {}
+
+    SlTraceSpan(const SlTraceSpan&) = delete;
+    SlTraceSpan& operator=(const SlTraceSpan&) = delete;
+
+    /**
+     * @brief Ends the span, if it was started.
+     */
+    ~SlTraceSpan() {
+        if (_start != 0)
+            sl_self_trace_end(_name, _start);
+    }
+};
+
+#define _SL_TRACE_CONCAT_INNER(a, b) a##b
+#define _SL_TRACE_CONCAT(a, b) _SL_TRACE_CONCAT_INNER(a, b)
+
+///
+/// @brief Traces the rest of the enclosing scope as a span of the given name.
+#define SL_TRACE_SCOPE(name) \
+    SlTraceSpan _SL_TRACE_CONCAT(_sl_trace_span_, __LINE__){name}
+
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackAggregate.cpp
+ * @brief   Defines aggregation of a stream's interned kernel stacks.
+*/
+
+// C++
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlStackAggregate.hpp"
+
+// Static functions
+
+/**
+ * @brief Key of an aggregated stack - PID and stack ID in the first half,
+ * CPU and prev_state in the second.
+ */
+struct _AggregateKey {
+    ///
+    /// @brief PID in the upper and stack ID in the lower 32 bits.
+    uint64_t task_stack;
+    ///
+    /// @brief CPU in the upper and prev_state in the lower 32 bits.
+    uint64_t cpu_state;
+
+    bool operator==(const _AggregateKey&) const = default;
+};
+
+/**
+ * @brief Hash of aggregate keys.
+ */
+struct _AggregateKeyHash {
+    /**
+     * @brief Mixes both halves of a key.
+     *
+     * @param key: key to hash
+     *
+     * @returns Hash of the key.
+     */
+    size_t operator()(const _AggregateKey& key) const {
+        return std::hash<uint64_t>{}(key.task_stack
+                                     ^ (key.cpu_state * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+// Global functions
+
+/**
+ * @brief Aggregates events with kernel stacks by their task and stack in
+ * one pass over the index. Off-CPU time of a `sched_switch` stack lasts
+ * until the next switch whose `next_pid` is the switched out task.
+ *
+ * @param index: built index of the stream
+ * @param by_cpu_and_state: whether events on different CPUs or with
+ * different prev_states are aggregated separately
+ *
+ * @returns Aggregated stacks, ordered by PID, stack ID, CPU and prev_state.
+ */
+std::vector<SlAggregatedStack> aggregate_stacks(const SlStreamIndex& index,
+                                                bool by_cpu_and_state) {
+    const kshark_data_container* events = index.events();
+
+    std::vector<SlAggregatedStack> aggregated;
+    // Position in `aggregated` by the aggregate's key
+    std::unordered_map<_AggregateKey, size_t, _AggregateKeyHash> slots;
+
+    // Switched out tasks' aggregates and times of their switches
+    struct _OffCpu {
+        size_t slot;
+        int64_t since;
+    };
+    std::unordered_map<int32_t, _OffCpu> off_cpu;
+
+    for (ssize_t i = 0; i < index.size(); ++i) {
+        const kshark_entry* entry = events->data[i]->entry;
+        const bool is_switch = (entry->event_id == index.sswitch_event_id());
+
+        if (is_switch) {
+            int64_t next_pid;
+            if (kshark_read_event_field_int(entry, "next_pid", &next_pid) >= 0) {
+                auto back_on_cpu = off_cpu.find(int32_t(next_pid));
+                if (back_on_cpu != off_cpu.end()) {
+                    aggregated[back_on_cpu->second.slot].off_cpu_ns +=
+                        uint64_t(entry->ts - back_on_cpu->second.since);
+                    off_cpu.erase(back_on_cpu);
+                }
+            }
+        }
+
+        const uint32_t stack_id = index.stack_of(i);
+        if (stack_id == SlStreamIndex::NO_STACK)
+            continue;
+
+        // Stack belongs to the task which ran when it was taken
+        const int32_t pid = kshark_get_pid(entry);
+        const int32_t cpu = by_cpu_and_state ? entry->cpu : -1;
+        const char prev_state = by_cpu_and_state ? index.prev_state_of(i) : 0;
+        const _AggregateKey key {
+            (uint64_t(uint32_t(pid)) << 32) | stack_id,
+            (uint64_t(uint32_t(cpu)) << 32) | uint8_t(prev_state)
+        };
+        auto [slot, inserted] = slots.try_emplace(key, aggregated.size());
+        if (inserted)
+            aggregated.push_back({pid, stack_id, cpu, prev_state, 0, 0, i});
+        ++aggregated[slot->second].count;
+
+        if (is_switch && pid > 0)
+            off_cpu[pid] = {slot->second, entry->ts};
+    }
+
+    std::sort(aggregated.begin(), aggregated.end(),
+              [](const SlAggregatedStack& a, const SlAggregatedStack& b) {
+                  return std::tie(a.pid, a.stack_id, a.cpu, a.prev_state)
+                         < std::tie(b.pid, b.stack_id, b.cpu, b.prev_state);
+              });
+    return aggregated;
+}
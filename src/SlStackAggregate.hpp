@@ -0,0 +1,70 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackAggregate.hpp
+ * @brief   Declares aggregation of a stream's interned kernel stacks per
+ *          task (and optionally CPU and prev_state), with event counts and
+ *          off-CPU time, which exporters of the plugin write out.
+ *
+ * @note    Definitions in `SlStackAggregate.cpp`.
+*/
+
+#ifndef _SL_STACK_AGGREGATE_HPP
+#define _SL_STACK_AGGREGATE_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <string>
+#include <vector>
+
+// Plugin
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief Events of one task sharing one interned kernel stack.
+ */
+struct SlAggregatedStack {
+    ///
+    /// @brief PID of the task which owned the stack.
+    int32_t pid;
+    ///
+    /// @brief ID of the interned stack.
+    uint32_t stack_id;
+    ///
+    /// @brief CPU of the events, `-1` if not aggregated by CPU.
+    int32_t cpu;
+    /// @brief Prev_state letter of the events, `0` if not aggregated by
+    /// prev_state or if the events aren't switches.
+    char prev_state;
+    ///
+    /// @brief Number of events of the task with the stack.
+    uint64_t count;
+    /// @brief Nanoseconds the task spent off CPU after switching out
+    /// with the stack, until it was switched in again.
+    uint64_t off_cpu_ns;
+    ///
+    /// @brief Container index of one of the events, e.g. for task names.
+    ssize_t sample_event;
+};
+
+/**
+ * @brief Result of an export.
+ */
+struct SlExportResult {
+    ///
+    /// @brief Whether the whole output was written.
+    bool ok;
+    ///
+    /// @brief Number of written stacks (lines or samples).
+    uint64_t stacks;
+    ///
+    /// @brief Description of the failure, empty on success.
+    std::string error;
+};
+
+std::vector<SlAggregatedStack> aggregate_stacks(const SlStreamIndex& index,
+                                                bool by_cpu_and_state = false);
+
+#endif
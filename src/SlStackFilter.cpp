@@ -0,0 +1,176 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackFilter.cpp
+ * @brief   Defines compilation and evaluation of kernel stack filters.
+*/
+
+// C
+#include <fnmatch.h>
+
+// C++
+#include <algorithm>
+#include <regex>
+
+// Plugin
+#include "SlStackFilter.hpp"
+
+// Class functions - specification
+
+/**
+ * @brief Checks whether the specification has no criteria at all.
+ *
+ * @returns True if every stack would pass the filter, false otherwise.
+ */
+bool SlStackFilterSpec::is_empty() const {
+    return symbol_glob.empty() && symbol_regex.empty()
+           && above_frame.empty() && below_frame.empty()
+           && min_depth == 0;
+}
+
+// Class functions - compiled filter
+
+/**
+ * @brief Compiles a filter specification for a stream index. Glob and
+ * regular expression are matched against every interned symbol here,
+ * never again. An invalid regular expression matches no symbol.
+ *
+ * @param index: stream index whose stacks will be filtered
+ * @param spec: criteria of the filter
+ */
+SlStackFilter::SlStackFilter(const SlStreamIndex* index,
+                             const SlStackFilterSpec& spec)
+    : _index(index),
+      _spec(spec),
+      _memo(index->stacks().size(), -1)
+{
+    const SlSymbolTable& symbols = _index->symbols();
+
+    if (!_spec.symbol_glob.empty()) {
+        _glob_symbols.resize(symbols.size());
+        for (uint32_t id = 0; id < symbols.size(); ++id) {
+            const std::string text{symbols.text(id)};
+            _glob_symbols[id] = (fnmatch(_spec.symbol_glob.c_str(),
+                                         text.c_str(), 0) == 0);
+        }
+    }
+
+    if (!_spec.symbol_regex.empty()) {
+        _regex_symbols.resize(symbols.size());
+        try {
+            const std::regex regex{_spec.symbol_regex};
+            for (uint32_t id = 0; id < symbols.size(); ++id) {
+                const std::string text{symbols.text(id)};
+                _regex_symbols[id] = std::regex_search(text, regex);
+            }
+        } catch (const std::regex_error&) {
+            // Already all false, nothing matches
+        }
+    }
+
+    // Exact symbols are looked up among the interned ones, missing
+    // symbols keep an ID which no frame has.
+    for (uint32_t id = 0; id < symbols.size(); ++id) {
+        if (symbols.text(id) == _spec.above_frame)
+            _above_symbol = id;
+        if (symbols.text(id) == _spec.below_frame)
+            _below_symbol = id;
+    }
+}
+
+/**
+ * @brief Evaluates all criteria for a stack.
+ *
+ * @param stack_id: ID of an interned stack
+ *
+ * @returns True if the stack passes the filter, false otherwise.
+ */
+bool SlStackFilter::_evaluate(uint32_t stack_id) const {
+    std::span<const uint32_t> frames = _index->stacks().frames(stack_id);
+
+    if (frames.size() < _spec.min_depth)
+        return false;
+
+    if (!_glob_symbols.empty()
+        && std::none_of(frames.begin(), frames.end(),
+                        [this](uint32_t s) { return _glob_symbols[s]; })) {
+        return false;
+    }
+
+    if (!_regex_symbols.empty()
+        && std::none_of(frames.begin(), frames.end(),
+                        [this](uint32_t s) { return _regex_symbols[s]; })) {
+        return false;
+    }
+
+    const bool wants_above = !_spec.above_frame.empty();
+    const bool wants_below = !_spec.below_frame.empty();
+    if (wants_above || wants_below) {
+        // Frames are top first - the topmost "above" frame has to come
+        // before the bottommost "below" frame.
+        ssize_t first_above = -1;
+        ssize_t last_below = -1;
+        for (ssize_t i = 0; i < (ssize_t)frames.size(); ++i) {
+            if (frames[i] == _above_symbol && first_above < 0)
+                first_above = i;
+            if (frames[i] == _below_symbol)
+                last_below = i;
+        }
+
+        if (wants_above && first_above < 0)
+            return false;
+        if (wants_below && last_below < 0)
+            return false;
+        if (wants_above && wants_below && first_above >= last_below)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Gets the stream index the filter was compiled for.
+ *
+ * @returns Pointer to the index.
+ */
+const SlStreamIndex* SlStackFilter::index() const
+{ return _index; }
+
+/**
+ * @brief Gets the criteria the filter was compiled from.
+ *
+ * @returns Const reference to the specification.
+ */
+const SlStackFilterSpec& SlStackFilter::spec() const
+{ return _spec; }
+
+/**
+ * @brief Checks whether a stack passes the filter, evaluating the
+ * criteria only on the first check of the stack.
+ *
+ * @param stack_id: ID of an interned stack
+ *
+ * @returns True if the stack passes the filter, false otherwise.
+ */
+bool SlStackFilter::matches_stack(uint32_t stack_id) const {
+    if (stack_id >= _memo.size())
+        return false;
+
+    if (_memo[stack_id] < 0)
+        _memo[stack_id] = _evaluate(stack_id) ? 1 : 0;
+
+    return _memo[stack_id] == 1;
+}
+
+/**
+ * @brief Checks whether the kernel stack of a collected event passes
+ * the filter.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns True if the event's stack passes the filter, false otherwise
+ * or if the event has no stack.
+ */
+bool SlStackFilter::matches_event(ssize_t event_idx) const {
+    return matches_stack(_index->stack_of(event_idx));
+}
@@ -0,0 +1,95 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackFilter.hpp
+ * @brief   Declares the user-defined kernel stack filter - its textual
+ *          specification and the matcher compiled from it over interned
+ *          symbol IDs.
+ *
+ * @note    Definitions in `SlStackFilter.cpp`.
+*/
+
+#ifndef _SL_STACK_FILTER_HPP
+#define _SL_STACK_FILTER_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <string>
+#include <vector>
+
+// Plugin
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief Specification of a kernel stack filter, as entered by the user.
+ * All non-empty criteria must hold for a stack to pass the filter.
+ */
+struct SlStackFilterSpec {
+    ///
+    /// @brief Shell-like glob which some frame's symbol must match.
+    std::string symbol_glob;
+    ///
+    /// @brief Regular expression which some frame's symbol must match.
+    std::string symbol_regex;
+    ///
+    /// @brief Symbol which must be in the stack above `below_frame`.
+    std::string above_frame;
+    ///
+    /// @brief Symbol which must be in the stack below `above_frame`.
+    std::string below_frame;
+    ///
+    /// @brief Minimal number of frames of the stack.
+    uint32_t min_depth{0};
+
+    bool is_empty() const;
+    bool operator==(const SlStackFilterSpec&) const = default;
+};
+
+/**
+ * @brief Kernel stack filter compiled for one stream index. Textual
+ * criteria are evaluated once per interned symbol during compilation,
+ * results for stacks are memoized on first use, so filtering an event
+ * costs one lookup of its stack's result.
+ */
+class SlStackFilter {
+private: // Data members
+    ///
+    /// @brief Index the filter was compiled for, not owned.
+    const SlStreamIndex* _index;
+
+    ///
+    /// @brief Criteria the filter was compiled from.
+    SlStackFilterSpec _spec;
+
+    ///
+    /// @brief Whether each symbol matches the glob, by symbol ID.
+    std::vector<bool> _glob_symbols;
+
+    ///
+    /// @brief Whether each symbol matches the regular expression.
+    std::vector<bool> _regex_symbols;
+
+    ///
+    /// @brief ID of the symbol which must be above, if interned.
+    uint32_t _above_symbol{UINT32_MAX};
+
+    ///
+    /// @brief ID of the symbol which must be below, if interned.
+    uint32_t _below_symbol{UINT32_MAX};
+
+    /// @brief Memoized results by stack ID, `-1` if not evaluated yet,
+    /// `0` if the stack didn't pass, `1` if it did.
+    mutable std::vector<int8_t> _memo;
+private: // Functions
+    bool _evaluate(uint32_t stack_id) const;
+public: // Functions
+    SlStackFilter(const SlStreamIndex* index, const SlStackFilterSpec& spec);
+    const SlStreamIndex* index() const;
+    const SlStackFilterSpec& spec() const;
+    bool matches_stack(uint32_t stack_id) const;
+    bool matches_event(ssize_t event_idx) const;
+};
+
+#endif
@@ -0,0 +1,259 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackSearch.cpp
+ * @brief   Defines the kernel stack search window and its hits model.
+*/
+
+// C++
+#include <algorithm>
+#include <utility>
+
+// KernelShark
+#include "libkshark.h"
+#include "KsMainWindow.hpp"
+
+// Plugin headers
+#include "stacklook.h"
+#include "SlConfig.hpp"
+#include "SlStackSearch.hpp"
+
+// Static functions
+
+/**
+ * @brief Redraws KernelShark's graph, so that Stacklook buttons pick up
+ * changed highlights.
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+static void _redraw_graph() {
+    // Configuration access here
+    if (SlConfig::main_w_ptr != nullptr)
+        SlConfig::main_w_ptr->graphPtr()->glPtr()->update();
+}
+
+// Class functions - hits model
+
+/**
+ * @brief Constructor of an empty hits model.
+ *
+ * @param parent: Qt object owning the model
+ */
+SlSearchHitsModel::SlSearchHitsModel(QObject* parent)
+    : QAbstractListModel(parent) {}
+
+/**
+ * @brief Replaces the hits of the model.
+ *
+ * @param index: index the hits point into, may be nullptr if there are none
+ * @param hits: ascending container indices of the hit events
+ */
+void SlSearchHitsModel::set_hits(const SlStreamIndex* index,
+                                 std::vector<uint32_t> hits) {
+    beginResetModel();
+    _index = index;
+    _hits = std::move(hits);
+    endResetModel();
+}
+
+/**
+ * @brief Gets the hits of the model.
+ *
+ * @returns Ascending container indices of the hit events.
+ */
+const std::vector<uint32_t>& SlSearchHitsModel::hits() const
+{ return _hits; }
+
+/**
+ * @brief Gets the number of hits.
+ *
+ * @returns Number of rows for the top level, `0` for any other parent.
+ */
+int SlSearchHitsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : int(_hits.size());
+}
+
+/**
+ * @brief Gets the text of a hit's row - its time, CPU, task and event.
+ *
+ * @param index: model index of the row
+ * @param role: Qt data role, only the display role is supported
+ *
+ * @returns Text of the row or an invalid variant.
+ */
+QVariant SlSearchHitsModel::data(const QModelIndex& index, int role) const {
+    if (role != Qt::DisplayRole || _index == nullptr || !index.isValid()
+        || index.row() >= int(_hits.size())) {
+        return QVariant();
+    }
+
+    const kshark_entry* entry =
+        _index->events()->data[_hits[index.row()]]->entry;
+    return QString("%1 s  CPU %2  %3-%4  %5")
+        .arg(double(entry->ts) / 1e9, 0, 'f', 6)
+        .arg(entry->cpu)
+        .arg(kshark_get_task(entry))
+        .arg(entry->pid)
+        .arg(kshark_get_event_name(entry));
+}
+
+// Class functions - search window
+
+/**
+ * @brief Constructor of the stack search window.
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+SlStackSearch::SlStackSearch()
+    : QWidget(SlConfig::main_w_ptr), // Configuration access here
+    _query(this),
+    _exact_check("Exact symbol", this),
+    _search_button("Search", this),
+    _clear_button("Clear", this),
+    _status_label(this),
+    _hits_model(this),
+    _hits_view(this),
+    _close_button("Close", this)
+{
+    setWindowTitle("Stacklook - Stack Search");
+    // Set window flags to make header buttons
+    setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint
+                   | Qt::WindowMaximizeButtonHint
+                   | Qt::WindowCloseButtonHint);
+    resize(700, 500);
+
+    _query.setPlaceholderText("Symbol in the stack, e.g. io_schedule");
+    _query_layout.addWidget(&_query);
+    _query_layout.addWidget(&_exact_check);
+    _query_layout.addWidget(&_search_button);
+    _query_layout.addWidget(&_clear_button);
+
+    _hits_view.setModel(&_hits_model);
+    _hits_view.setUniformItemSizes(true);
+    _hits_view.setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    _layout.addLayout(&_query_layout);
+    _layout.addWidget(&_status_label);
+    _layout.addWidget(&_hits_view);
+    _layout.addWidget(&_close_button);
+
+    connect(&_query, &QLineEdit::returnPressed,
+            this, &SlStackSearch::_search);
+    connect(&_search_button, &QPushButton::pressed,
+            this, &SlStackSearch::_search);
+    connect(&_clear_button, &QPushButton::pressed,
+            this, &SlStackSearch::_clear);
+    connect(&_hits_view, &QListView::doubleClicked,
+            this, &SlStackSearch::_mark_hit);
+    connect(&_close_button, &QPushButton::pressed,
+            this, &QWidget::close);
+
+    setLayout(&_layout);
+}
+
+/**
+ * @brief Searches the stream's stacks for the query and highlights
+ * Stacklook buttons of the hits.
+ */
+void SlStackSearch::_search() {
+    if (_index == nullptr) {
+        _status_label.setText("No kernel stacks to search.");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const std::string query = _query.text().trimmed().toStdString();
+    const std::vector<uint32_t> symbols = find_symbols(
+        _index->symbols(), query, _exact_check.isChecked());
+    _hits_model.set_hits(_index, _index->symbol_index().search(symbols));
+
+    _status_label.setText(QString("%1 hits in %2 matching symbols, "
+                                  "found in %3 ms.")
+                          .arg(_hits_model.hits().size())
+                          .arg(symbols.size())
+                          .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2));
+    _redraw_graph();
+}
+
+/**
+ * @brief Removes the hits and their highlights.
+ */
+void SlStackSearch::_clear() {
+    _hits_model.set_hits(nullptr, {});
+    _status_label.clear();
+    _redraw_graph();
+}
+
+/**
+ * @brief Marks a hit with KernelShark's marker A.
+ *
+ * @param hit: model index of the hit's row
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+void SlStackSearch::_mark_hit(const QModelIndex& hit) {
+    if (_index == nullptr || !hit.isValid())
+        return;
+
+    const uint32_t event_idx = _hits_model.hits()[hit.row()];
+    // Configuration access here
+    SlConfig::main_w_ptr->markEntry(_index->events()->data[event_idx]->entry,
+                                    DualMarkerState::A);
+}
+
+/**
+ * @brief Shows the window for searching a stream's stacks, building the
+ * stream's index first if needed. Hits of a previously searched stream
+ * are dropped.
+ *
+ * @param stream_id: stream to search
+ */
+void SlStackSearch::show_stream(int stream_id) {
+    const SlStreamIndex* index = (stream_id >= 0) ?
+        get_stream_index(stream_id) : nullptr;
+    if (index != _index) {
+        _hits_model.set_hits(nullptr, {});
+        _status_label.setText((index != nullptr) ?
+            QString("Searching stream %1.").arg(stream_id) :
+            QString("No kernel stacks to search."));
+    }
+
+    _stream_id = stream_id;
+    _index = index;
+    show();
+}
+
+/**
+ * @brief Checks whether an entry is one of the search hits.
+ *
+ * @param entry: entry of a collected event
+ *
+ * @returns True if the entry's Stacklook button should be highlighted,
+ * false otherwise.
+ */
+bool SlStackSearch::is_highlighted(const kshark_entry* entry) const {
+    const std::vector<uint32_t>& hits = _hits_model.hits();
+    if (hits.empty() || _index == nullptr || entry->stream_id != _stream_id)
+        return false;
+
+    const ssize_t event_idx = _index->index_of(entry);
+    return event_idx >= 0
+           && std::binary_search(hits.begin(), hits.end(),
+                                 uint32_t(event_idx));
+}
+
+/**
+ * @brief Drops the hits if they point into an index which is about to
+ * be freed.
+ *
+ * @param index: index to be freed
+ */
+void SlStackSearch::index_freed(const SlStreamIndex* index) {
+    if (_index == index) {
+        _index = nullptr;
+        _hits_model.set_hits(nullptr, {});
+        _status_label.setText("No kernel stacks to search.");
+    }
+}
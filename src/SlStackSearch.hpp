@@ -0,0 +1,117 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStackSearch.hpp
+ * @brief   Declares the window for searching kernel stacks by symbol,
+ *          which lists hits and highlights their Stacklook buttons.
+ *
+ * @note    Definitions in `SlStackSearch.cpp`.
+*/
+
+#ifndef _SL_STACK_SEARCH_HPP
+#define _SL_STACK_SEARCH_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <vector>
+
+// Qt
+#include <QtWidgets>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief List model over search hits. Rows' texts are made only when
+ * the view asks for them, so even millions of hits are listed at once.
+ */
+class SlSearchHitsModel : public QAbstractListModel {
+private: // Data members
+    ///
+    /// @brief Index the hits point into, not owned.
+    const SlStreamIndex* _index{nullptr};
+
+    ///
+    /// @brief Container indices of the hit events, ascending.
+    std::vector<uint32_t> _hits;
+public: // Functions
+    explicit SlSearchHitsModel(QObject* parent);
+    void set_hits(const SlStreamIndex* index, std::vector<uint32_t> hits);
+    const std::vector<uint32_t>& hits() const;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+};
+
+/**
+ * @brief Window with a search box for kernel stack symbols. Search uses
+ * the inverted symbol index of the stream, hits are listed and their
+ * Stacklook buttons get highlighted outlines. Double clicking a hit marks
+ * it with KernelShark's marker A.
+ */
+class SlStackSearch : public QWidget {
+private: // Data members
+    ///
+    /// @brief Stream which was searched, -1 if none.
+    int _stream_id{-1};
+
+    ///
+    /// @brief Index which was searched, not owned.
+    const SlStreamIndex* _index{nullptr};
+private: // Qt data members
+    ///
+    /// @brief Layout for the widget's control elements.
+    QVBoxLayout         _layout;
+
+    ///
+    /// @brief Layout for the search box and its options.
+    QHBoxLayout         _query_layout;
+
+    ///
+    /// @brief Search box for the symbol.
+    QLineEdit           _query;
+
+    /// @brief If checked, symbols must equal the query,
+    /// otherwise they must only contain it.
+    QCheckBox           _exact_check;
+
+    ///
+    /// @brief Starts the search.
+    QPushButton         _search_button;
+
+    ///
+    /// @brief Removes the hits and their highlights.
+    QPushButton         _clear_button;
+
+    ///
+    /// @brief Shows the number of hits and how long the search took.
+    QLabel              _status_label;
+
+    ///
+    /// @brief Model of the hits list.
+    SlSearchHitsModel   _hits_model;
+
+    ///
+    /// @brief List of the hits.
+    QListView           _hits_view;
+public: // Qt data members
+    ///
+    /// @brief Close button for the widget.
+    QPushButton         _close_button;
+private: // Functions
+    void _search();
+    void _clear();
+    void _mark_hit(const QModelIndex& hit);
+public: // Functions
+    SlStackSearch();
+    void show_stream(int stream_id);
+    bool is_highlighted(const kshark_entry* entry) const;
+    void index_freed(const SlStreamIndex* index);
+};
+
+#endif
@@ -0,0 +1,643 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStreamIndex.cpp
+ * @brief   Defines interning of kernel stack symbols and stacks and the
+ *          per-stream index of collected events' kernel stacks.
+*/
+
+// C
+#include <stdint.h>
+#include <stdlib.h>
+
+// C++
+#include <algorithm>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlStreamIndex.hpp"
+#include "SlPrevState.hpp"
+#include "SlSelfTrace.h"
+
+// Static variables
+
+///
+/// @brief Number of symbols resolved by one task of the thread pool.
+static constexpr size_t SYMBOLIZE_CHUNK = 1 << 12;
+
+// Static functions
+
+/**
+ * @brief Computes a 64-bit FNV-1a hash of a sequence of symbol IDs.
+ *
+ * @param frames: symbol IDs of a stack's frames
+ *
+ * @returns Hash of the frames.
+ */
+static uint64_t _hash_frames(std::span<const uint32_t> frames) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint32_t frame : frames) {
+        hash ^= frame;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Trims spaces and tabs from both ends of a string view.
+ *
+ * @param text: view to trim
+ *
+ * @returns Trimmed view.
+ */
+static std::string_view _trim(std::string_view text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+        return {};
+    const size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+/**
+ * @brief Gets the symbol of a user stack frame given as a bare address,
+ * either `<00007f...>` or `0x7f...`. Leading zeros are cut off, so that
+ * both forms of the same address are the same symbol.
+ *
+ * @param frame: text of the frame after "=>"
+ * @param symbol: output location for the address' hexadecimal digits,
+ * empty for a zero address
+ *
+ * @returns True if the frame is a bare address, false otherwise.
+ */
+static bool _user_address(std::string_view frame, std::string_view& symbol) {
+    if (frame.size() > 2 && frame.front() == '<' && frame.back() == '>') {
+        frame = frame.substr(1, frame.size() - 2);
+    } else if (frame.substr(0, 2) == "0x") {
+        frame = frame.substr(2);
+    } else {
+        return false;
+    }
+
+    if (frame.find_first_not_of("0123456789abcdefABCDEF") != std::string_view::npos)
+        return false;
+
+    const size_t first_digit = frame.find_first_not_of('0');
+    symbol = (first_digit == std::string_view::npos) ?
+        std::string_view{} : frame.substr(first_digit);
+    return true;
+}
+
+// Global functions
+
+/**
+ * @brief Splits the textual kernel stack of an `ftrace/kernel_stack` entry
+ * into frame symbols. Lines not starting with "=>" (e.g. the
+ * "<stack trace >" header) are skipped, return addresses in parentheses
+ * and offsets after '+' are cut off, so that the same function is always
+ * the same symbol.
+ *
+ * User stacks of `ftrace/user_stack` entries are split too. Bare addresses
+ * keep their hexadecimal digits without leading zeros, zero addresses
+ * ending the stack are skipped and `object[+0x1a2b]` frames are kept
+ * whole, as their offsets are all there is to tell them apart.
+ *
+ * @param stack_text: info field of a kernel or user stack entry
+ * @param frames: output vector for the frame symbols, which will point
+ * into `stack_text`; it is cleared first
+ */
+void parse_stack_frames(const char* stack_text,
+                        std::vector<std::string_view>& frames) {
+    frames.clear();
+    if (stack_text == nullptr)
+        return;
+
+    std::string_view rest{stack_text};
+    while (!rest.empty()) {
+        const size_t eol = rest.find('\n');
+        std::string_view line = _trim(rest.substr(0, eol));
+        rest = (eol == std::string_view::npos) ?
+            std::string_view{} : rest.substr(eol + 1);
+
+        if (line.substr(0, 2) != "=>")
+            continue;
+
+        line = _trim(line.substr(2));
+        // User frames - "<00007f12345678>" -> "7f12345678", "??" is unknown
+        std::string_view address;
+        if (_user_address(line, address)) {
+            if (!address.empty())
+                frames.push_back(address);
+            continue;
+        }
+        if (line == "??")
+            continue;
+        // "libc.so.6[+0x2a1c9]" stays whole
+        if (line.back() == ']' && line.find("[+") != std::string_view::npos) {
+            frames.push_back(line);
+            continue;
+        }
+        // "func (ffffffff81000000)" -> "func"
+        const size_t addr_start = line.find(" (");
+        if (addr_start != std::string_view::npos)
+            line = line.substr(0, addr_start);
+        // "func+0x1a/0x40" -> "func"
+        const size_t offset_start = line.find('+');
+        if (offset_start != std::string_view::npos && offset_start > 0)
+            line = line.substr(0, offset_start);
+
+        if (!line.empty())
+            frames.push_back(line);
+    }
+}
+
+// Class functions - symbol table
+
+/**
+ * @brief Gets the ID of a symbol's text, interning it first if it
+ * wasn't seen before.
+ *
+ * @param text: text of the symbol
+ *
+ * @returns ID of the symbol.
+ */
+uint32_t SlSymbolTable::intern(std::string_view text) {
+    auto found = _ids.find(text);
+    if (found != _ids.end())
+        return found->second;
+
+    const uint32_t new_id = static_cast<uint32_t>(_texts.size());
+    const std::string& stored = _texts.emplace_back(text);
+    _ids.emplace(std::string_view{stored}, new_id);
+    return new_id;
+}
+
+/**
+ * @brief Gets the text of an interned symbol.
+ *
+ * @param id: ID of the symbol
+ *
+ * @returns View of the symbol's text, empty view for unknown IDs.
+ */
+std::string_view SlSymbolTable::text(uint32_t id) const {
+    return (id < _texts.size()) ? std::string_view{_texts[id]}
+                                : std::string_view{};
+}
+
+/**
+ * @brief Gets the number of interned symbols.
+ *
+ * @returns Count of symbols in the table.
+ */
+size_t SlSymbolTable::size() const
+{ return _texts.size(); }
+
+// Class functions - stack table
+
+/**
+ * @brief Gets the ID of a stack, interning it first if no stack with
+ * the same frames was interned before.
+ *
+ * @param frames: symbol IDs of the stack's frames, top of the stack first
+ *
+ * @returns ID of the stack.
+ */
+uint32_t SlStackTable::intern(std::span<const uint32_t> frames) {
+    const uint64_t hash = _hash_frames(frames);
+
+    auto [candidate, candidates_end] = _ids.equal_range(hash);
+    for (; candidate != candidates_end; ++candidate) {
+        std::span<const uint32_t> known = this->frames(candidate->second);
+        if (std::equal(known.begin(), known.end(),
+                       frames.begin(), frames.end())) {
+            return candidate->second;
+        }
+    }
+
+    const uint32_t new_id = static_cast<uint32_t>(size());
+    _frames.insert(_frames.end(), frames.begin(), frames.end());
+    _offsets.push_back(static_cast<uint32_t>(_frames.size()));
+    _ids.emplace(hash, new_id);
+    return new_id;
+}
+
+/**
+ * @brief Gets frames of an interned stack.
+ *
+ * @param id: ID of the stack
+ *
+ * @returns Symbol IDs of the stack's frames, top of the stack first.
+ * Unknown IDs get an empty span.
+ */
+std::span<const uint32_t> SlStackTable::frames(uint32_t id) const {
+    if (id >= size())
+        return {};
+    return std::span<const uint32_t>{_frames}.subspan(
+        _offsets[id], _offsets[id + 1] - _offsets[id]);
+}
+
+/**
+ * @brief Gets the number of interned stacks.
+ *
+ * @returns Count of stacks in the table.
+ */
+size_t SlStackTable::size() const
+{ return _offsets.size() - 1; }
+
+// Class functions - stream index
+
+/**
+ * @brief Constructor of the stream index. The index is empty until
+ * `build` is called.
+ *
+ * @param events: sorted container of collected events, whose fields
+ * already hold pointers to their kernel stack entries
+ * @param sswitch_event_id: numerical id of the stream's sched_switch event
+ * @param user_stacks: user stacks associated with the collected events,
+ * nullptr if there are none; they must outlive the index
+ */
+SlStreamIndex::SlStreamIndex(const kshark_data_container* events,
+                             int sswitch_event_id,
+                             const SlUserStacks* user_stacks)
+    : _events(events),
+      _sswitch_event_id(sswitch_event_id),
+      _user_stacks(user_stacks) {}
+
+/**
+ * @brief Interns kernel stacks of all collected events, followed by their
+ * user stacks if there are any. Each stack entry's info is parsed only
+ * once, during this call. Each event with a stack is fed to the heavy
+ * hitters aggregator as soon as its stack is interned. With a kernel symbol
+ * table, raw addresses among the interned symbols are resolved afterwards;
+ * that renumbers stacks, so the events are fed only after it then. The
+ * inverted index from symbols to events is built at the end.
+ *
+ * @param kallsyms: kernel symbol table to resolve raw addresses with,
+ * nullptr to keep them
+ * @param group: task group to resolve addresses in, nullptr to resolve
+ * them on the calling thread only
+ */
+void SlStreamIndex::build(const SlKallsyms* kallsyms, SlTaskGroup* group) {
+    SL_TRACE_SCOPE("build_stream_index");
+
+    const ssize_t events_count = size();
+    _event_stacks.assign(static_cast<size_t>(events_count), NO_STACK);
+    _prev_states.assign(static_cast<size_t>(events_count), 0);
+    _heavy_hitters.clear();
+
+    // Symbolization renumbers stacks, heavy hitters have to wait for it
+    const bool symbolize = kallsyms != nullptr && kallsyms->size() > 0;
+
+    // Reused between events to avoid reallocations
+    std::vector<std::string_view> frame_texts;
+    std::vector<uint32_t> frame_ids;
+
+    for (ssize_t i = 0; i < events_count; ++i) {
+        const kshark_data_field_int64* event = _events->data[i];
+        // Field is -1 if the kernel stack wasn't found
+        if (event->field == -1)
+            continue;
+
+        // Frames are views into the info text, interning copies them
+        const kshark_entry* kstack_entry = (const kshark_entry*)(event->field);
+        char* kstack_info = kshark_get_info(kstack_entry);
+        parse_stack_frames(kstack_info, frame_texts);
+
+        frame_ids.clear();
+        for (std::string_view frame_text : frame_texts) {
+            frame_ids.push_back(_symbols.intern(frame_text));
+        }
+        free(kstack_info);
+
+        // User space frames go below the kernel ones, as they called them
+        const kshark_entry* ustack_entry = (_user_stacks != nullptr) ?
+            _user_stacks->entries[i] : nullptr;
+        if (ustack_entry != nullptr) {
+            char* ustack_info = kshark_get_info(ustack_entry);
+            parse_stack_frames(ustack_info, frame_texts);
+            for (std::string_view frame_text : frame_texts) {
+                frame_ids.push_back(_symbols.intern(frame_text));
+            }
+            free(ustack_info);
+        }
+
+        _event_stacks[i] = _stacks.intern(frame_ids);
+
+        if (event->entry->event_id == _sswitch_event_id)
+            _prev_states[i] = get_switch_prev_state(event->entry)[0];
+
+        if (!symbolize)
+            _heavy_hitters.add(event->entry, i, _event_stacks[i], _prev_states[i]);
+    }
+
+    if (symbolize) {
+        _symbolize(*kallsyms, group);
+
+        for (ssize_t i = 0; i < events_count; ++i) {
+            if (_event_stacks[i] != NO_STACK)
+                _heavy_hitters.add(_events->data[i]->entry, i, _event_stacks[i],
+                                   _prev_states[i]);
+        }
+    }
+
+    _symbol_index.build(_symbols, _stacks, _event_stacks);
+    _build_occurrences();
+}
+
+/**
+ * @brief Replaces raw kernel addresses among the interned symbols with
+ * names of the functions they are in. Each distinct address is resolved
+ * once, as symbols are interned already. Stacks are then interned again
+ * with the resolved symbols, stacks differing only in addresses within
+ * the same functions become one.
+ *
+ * @param kallsyms: kernel symbol table to resolve addresses with
+ * @param group: task group to resolve addresses in, nullptr to resolve
+ * them on the calling thread only
+ */
+void SlStreamIndex::_symbolize(const SlKallsyms& kallsyms, SlTaskGroup* group) {
+    SL_TRACE_SCOPE("symbolize_stacks");
+
+    const size_t symbols_count = _symbols.size();
+    // Views into the symbol table or into the kallsyms, both outlive this
+    std::vector<std::string_view> resolved(symbols_count);
+
+    auto resolve_range = [this, &kallsyms, &resolved](size_t begin, size_t end) {
+        for (size_t id = begin; id < end; ++id) {
+            const std::string_view text = _symbols.text(uint32_t(id));
+            uint64_t address;
+            std::string_view name;
+            if (parse_raw_address(text, address))
+                name = kallsyms.resolve(address);
+            resolved[id] = name.empty() ? text : name;
+        }
+    };
+
+    if (group == nullptr || symbols_count <= SYMBOLIZE_CHUNK
+        || SlThreadPool::get_instance().size() < 2) {
+        resolve_range(0, symbols_count);
+    } else {
+        for (size_t begin = 0; begin < symbols_count; begin += SYMBOLIZE_CHUNK) {
+            const size_t end = std::min(begin + SYMBOLIZE_CHUNK, symbols_count);
+            group->run([&resolve_range, begin, end]() {
+                resolve_range(begin, end);
+            });
+        }
+        group->wait();
+        // Chunks skipped because of cancellation keep the raw addresses
+        if (group->is_cancelled())
+            return;
+    }
+
+    SlSymbolTable symbols;
+    std::vector<uint32_t> symbol_remap(symbols_count);
+    for (size_t id = 0; id < symbols_count; ++id) {
+        symbol_remap[id] = symbols.intern(resolved[id]);
+    }
+
+    SlStackTable stacks;
+    std::vector<uint32_t> stack_remap(_stacks.size());
+    std::vector<uint32_t> frame_ids;
+    for (uint32_t id = 0; id < _stacks.size(); ++id) {
+        frame_ids.clear();
+        for (uint32_t frame : _stacks.frames(id)) {
+            frame_ids.push_back(symbol_remap[frame]);
+        }
+        stack_remap[id] = stacks.intern(frame_ids);
+    }
+
+    for (uint32_t& stack_id : _event_stacks) {
+        if (stack_id != NO_STACK)
+            stack_id = stack_remap[stack_id];
+    }
+
+    _symbols = std::move(symbols);
+    _stacks = std::move(stacks);
+}
+
+/**
+ * @brief Builds the lists of events of each stack with a counting sort
+ * of the events by their stack IDs, so each list is ascending.
+ */
+void SlStreamIndex::_build_occurrences() {
+    const size_t stacks_count = _stacks.size();
+    _occurrence_offsets.assign(stacks_count + 1, 0);
+
+    for (uint32_t stack_id : _event_stacks) {
+        if (stack_id != NO_STACK)
+            ++_occurrence_offsets[stack_id + 1];
+    }
+    for (size_t i = 1; i <= stacks_count; ++i) {
+        _occurrence_offsets[i] += _occurrence_offsets[i - 1];
+    }
+
+    _stack_occurrences.resize(_occurrence_offsets[stacks_count]);
+    std::vector<uint32_t> next(_occurrence_offsets.begin(),
+                               _occurrence_offsets.end() - 1);
+    for (size_t i = 0; i < _event_stacks.size(); ++i) {
+        const uint32_t stack_id = _event_stacks[i];
+        if (stack_id != NO_STACK)
+            _stack_occurrences[next[stack_id]++] = static_cast<uint32_t>(i);
+    }
+}
+
+/**
+ * @brief Gets the container of collected events the index was built over.
+ *
+ * @returns Pointer to the container.
+ */
+const kshark_data_container* SlStreamIndex::events() const
+{ return _events; }
+
+/**
+ * @brief Gets the numerical id of the stream's sched_switch event.
+ *
+ * @returns Event ID of sched_switch.
+ */
+int SlStreamIndex::sswitch_event_id() const
+{ return _sswitch_event_id; }
+
+/**
+ * @brief Gets the symbol interning table.
+ *
+ * @returns Const reference to the symbol table.
+ */
+const SlSymbolTable& SlStreamIndex::symbols() const
+{ return _symbols; }
+
+/**
+ * @brief Gets the stack interning table.
+ *
+ * @returns Const reference to the stack table.
+ */
+const SlStackTable& SlStreamIndex::stacks() const
+{ return _stacks; }
+
+/**
+ * @brief Gets the number of indexed events.
+ *
+ * @returns Size of the container of collected events.
+ */
+ssize_t SlStreamIndex::size() const
+{ return (_events != nullptr) ? _events->size : 0; }
+
+/**
+ * @brief Gets the stack ID of a collected event.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns ID of the event's kernel stack or `NO_STACK`.
+ */
+uint32_t SlStreamIndex::stack_of(ssize_t event_idx) const {
+    return (event_idx >= 0 && event_idx < (ssize_t)_event_stacks.size()) ?
+        _event_stacks[event_idx] : NO_STACK;
+}
+
+/**
+ * @brief Gets the prev_state of a collected sched_switch event.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns Prev_state letter, `0` for other events or events without
+ * a kernel stack.
+ */
+char SlStreamIndex::prev_state_of(ssize_t event_idx) const {
+    return (event_idx >= 0 && event_idx < (ssize_t)_prev_states.size()) ?
+        _prev_states[event_idx] : 0;
+}
+
+/**
+ * @brief Gets stack IDs of all collected events.
+ *
+ * @returns Stack ID of each event, by container index.
+ */
+std::span<const uint32_t> SlStreamIndex::event_stacks() const
+{ return _event_stacks; }
+
+/**
+ * @brief Gets the aggregator of the most frequent stacks.
+ *
+ * @returns Const reference to the aggregator.
+ */
+const SlStackHeavyHitters& SlStreamIndex::heavy_hitters() const
+{ return _heavy_hitters; }
+
+/**
+ * @brief Gets the inverted index from symbols to events.
+ *
+ * @returns Const reference to the symbol index.
+ */
+const SlSymbolIndex& SlStreamIndex::symbol_index() const
+{ return _symbol_index; }
+
+/**
+ * @brief Finds the first collected event at or after a timestamp.
+ *
+ * @param ts: timestamp to search for
+ *
+ * @returns Index of the first event with timestamp not lower than `ts`,
+ * or the size of the container if there is none.
+ */
+ssize_t SlStreamIndex::lower_bound(int64_t ts) const {
+    if (size() == 0)
+        return 0;
+
+    kshark_data_field_int64** first = _events->data;
+    kshark_data_field_int64** last = _events->data + _events->size;
+    auto found = std::lower_bound(first, last, ts,
+        [](const kshark_data_field_int64* event, int64_t time) {
+            return event->entry->ts < time;
+        });
+    return found - first;
+}
+
+/**
+ * @brief Finds the container index of a collected event's entry.
+ *
+ * @param entry: entry of a collected event
+ *
+ * @returns Index of the event in the container, -1 if it isn't there.
+ */
+ssize_t SlStreamIndex::index_of(const kshark_entry* entry) const {
+    if (entry == nullptr)
+        return -1;
+
+    // Entries with the same timestamp are few, walk over them
+    for (ssize_t i = lower_bound(entry->ts); i < size(); ++i) {
+        const kshark_entry* candidate = _events->data[i]->entry;
+        if (candidate->ts != entry->ts)
+            break;
+        if (candidate == entry)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Finds the container index of a collected event by its timestamp,
+ * CPU and PID, which identify an event even without its entry.
+ *
+ * @param ts: timestamp of the event
+ * @param cpu: CPU of the event
+ * @param pid: PID of the event
+ *
+ * @returns Index of the event in the container, -1 if it isn't there.
+ */
+ssize_t SlStreamIndex::find_event(int64_t ts, int16_t cpu, int32_t pid) const {
+    for (ssize_t i = lower_bound(ts); i < size(); ++i) {
+        const kshark_entry* candidate = _events->data[i]->entry;
+        if (candidate->ts != ts)
+            break;
+        if (candidate->cpu == cpu && candidate->pid == pid)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Gets container indices of all events of a stack.
+ *
+ * @param stack_id: ID of the stack
+ *
+ * @returns Indices of the stack's events in ascending order, empty for
+ * unknown stacks.
+ */
+std::span<const uint32_t> SlStreamIndex::occurrences(uint32_t stack_id) const {
+    if (stack_id == NO_STACK || stack_id + 1 >= _occurrence_offsets.size())
+        return {};
+
+    const uint32_t begin = _occurrence_offsets[stack_id];
+    const uint32_t end = _occurrence_offsets[stack_id + 1];
+    return std::span<const uint32_t>(_stack_occurrences).subspan(begin, end - begin);
+}
+
+/**
+ * @brief Finds the next event with the same kernel stack as an event.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns Index of the next event with the same stack, -1 if there is
+ * none or the event has no stack.
+ */
+ssize_t SlStreamIndex::next_same_stack(ssize_t event_idx) const {
+    const std::span<const uint32_t> events = occurrences(stack_of(event_idx));
+    auto found = std::upper_bound(events.begin(), events.end(),
+                                  static_cast<uint32_t>(event_idx));
+    return (found != events.end()) ? ssize_t(*found) : -1;
+}
+
+/**
+ * @brief Finds the previous event with the same kernel stack as an event.
+ *
+ * @param event_idx: index of the event in the container
+ *
+ * @returns Index of the previous event with the same stack, -1 if there
+ * is none or the event has no stack.
+ */
+ssize_t SlStreamIndex::prev_same_stack(ssize_t event_idx) const {
+    const std::span<const uint32_t> events = occurrences(stack_of(event_idx));
+    auto found = std::lower_bound(events.begin(), events.end(),
+                                  static_cast<uint32_t>(event_idx));
+    return (found != events.begin()) ? ssize_t(*(found - 1)) : -1;
+}
@@ -0,0 +1,175 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlStreamIndex.hpp
+ * @brief   Declares interning tables for kernel stack symbols and whole
+ *          stacks, as well as the per-stream index which maps collected
+ *          Stacklook-relevant events to their interned kernel stacks.
+ *
+ * @note    Definitions in `SlStreamIndex.cpp`.
+*/
+
+#ifndef _SL_STREAM_INDEX_HPP
+#define _SL_STREAM_INDEX_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlAssociation.hpp"
+#include "SlHeavyHitters.hpp"
+#include "SlKallsyms.hpp"
+#include "SlSymbolIndex.hpp"
+#include "SlThreadPool.hpp"
+
+/**
+ * @brief Interning table of stack frame symbols. Every distinct
+ * symbol text gets a small, dense numerical ID, which is what all
+ * stack aggregations of the plugin work with instead of strings.
+ */
+class SlSymbolTable {
+private: // Data members
+    /// @brief Storage of the interned texts. A deque is used, as it
+    /// never moves its elements and lookup keys may point into them.
+    std::deque<std::string> _texts;
+
+    ///
+    /// @brief Lookup of symbol IDs by their text.
+    std::unordered_map<std::string_view, uint32_t> _ids;
+public: // Functions
+    uint32_t intern(std::string_view text);
+    std::string_view text(uint32_t id) const;
+    size_t size() const;
+};
+
+/**
+ * @brief Interning table of whole stacks, i.e. sequences of symbol IDs.
+ * Frames of a stack are kept in the order trace-cmd writes them, so the
+ * top of the stack is the first frame.
+ */
+class SlStackTable {
+private: // Data members
+    ///
+    /// @brief Frames of all interned stacks, one after another.
+    std::vector<uint32_t> _frames;
+
+    /// @brief Offsets of stacks' first frames in `_frames`. There is one
+    /// more offset than stacks, so that a stack's end is the next offset.
+    std::vector<uint32_t> _offsets{0};
+
+    ///
+    /// @brief Candidate stack IDs keyed by the hash of their frames.
+    std::unordered_multimap<uint64_t, uint32_t> _ids;
+public: // Functions
+    uint32_t intern(std::span<const uint32_t> frames);
+    std::span<const uint32_t> frames(uint32_t id) const;
+    size_t size() const;
+};
+
+/**
+ * @brief Per-stream index of kernel stacks of Stacklook-relevant events.
+ * Holds the symbol and stack interning tables and, for each entry in the
+ * plugin's (sorted) container of collected events, the ID of its interned
+ * kernel stack. If user stacks were associated, an event's stack is its
+ * kernel stack followed by its user stack. Raw kernel addresses in stacks
+ * can be symbolized with a saved kernel symbol table. For each stack, it
+ * holds the ascending container indices of its events, so moving between
+ * events with the same stack is a binary search.
+ *
+ * The index doesn't own the container, it only refers to it. It is expected
+ * to be freed before the container is.
+ */
+class SlStreamIndex {
+public: // Class data members
+    ///
+    /// @brief Stack ID of events whose kernel stack wasn't found.
+    static constexpr uint32_t NO_STACK = UINT32_MAX;
+private: // Data members
+    ///
+    /// @brief Container of collected events the index was built over.
+    const kshark_data_container* _events;
+
+    ///
+    /// @brief Numerical id of the stream's sched_switch event.
+    int _sswitch_event_id;
+
+    ///
+    /// @brief User stacks of the collected events, nullptr if there are none.
+    const SlUserStacks* _user_stacks;
+
+    ///
+    /// @brief Interned symbols of all stack frames.
+    SlSymbolTable _symbols;
+
+    ///
+    /// @brief Interned kernel stacks.
+    SlStackTable _stacks;
+
+    ///
+    /// @brief Stack ID of each collected event, by container index.
+    std::vector<uint32_t> _event_stacks;
+
+    /// @brief Prev_state letter of each collected sched_switch event,
+    /// by container index, `0` for other events.
+    std::vector<char> _prev_states;
+
+    ///
+    /// @brief Most frequent stacks, fed once stacks are interned.
+    SlStackHeavyHitters _heavy_hitters;
+
+    ///
+    /// @brief Inverted index from symbols to events, built with the index.
+    SlSymbolIndex _symbol_index;
+
+    /// @brief Offsets of stacks' occurrences in `_stack_occurrences`, one
+    /// more than stacks, so that a stack's end is the next offset.
+    std::vector<uint32_t> _occurrence_offsets;
+
+    /// @brief Container indices of events of each stack, ascending, one
+    /// stack after another.
+    std::vector<uint32_t> _stack_occurrences;
+private: // Functions
+    void _symbolize(const SlKallsyms& kallsyms, SlTaskGroup* group);
+    void _build_occurrences();
+public: // Functions
+    explicit SlStreamIndex(const kshark_data_container* events,
+                           int sswitch_event_id,
+                           const SlUserStacks* user_stacks = nullptr);
+
+    void build(const SlKallsyms* kallsyms = nullptr,
+               SlTaskGroup* group = nullptr);
+
+    const kshark_data_container* events() const;
+    int sswitch_event_id() const;
+    const SlSymbolTable& symbols() const;
+    const SlStackTable& stacks() const;
+    ssize_t size() const;
+    uint32_t stack_of(ssize_t event_idx) const;
+    char prev_state_of(ssize_t event_idx) const;
+    std::span<const uint32_t> event_stacks() const;
+    const SlStackHeavyHitters& heavy_hitters() const;
+    const SlSymbolIndex& symbol_index() const;
+    ssize_t lower_bound(int64_t ts) const;
+    ssize_t index_of(const kshark_entry* entry) const;
+    ssize_t find_event(int64_t ts, int16_t cpu, int32_t pid) const;
+    std::span<const uint32_t> occurrences(uint32_t stack_id) const;
+    ssize_t next_same_stack(ssize_t event_idx) const;
+    ssize_t prev_same_stack(ssize_t event_idx) const;
+};
+
+// Global functions
+void parse_stack_frames(const char* stack_text,
+                        std::vector<std::string_view>& frames);
+
+#endif
@@ -0,0 +1,233 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlSymbolIndex.cpp
+ * @brief   Defines compressed posting lists and the inverted index from
+ *          kernel stack symbols to collected events.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin
+#include "SlStreamIndex.hpp"
+#include "SlSymbolIndex.hpp"
+
+// Class functions - posting list
+
+/**
+ * @brief Appends a variable-length integer, seven bits per byte, the
+ * highest bit of a byte marking that another byte follows.
+ *
+ * @param value: number to encode
+ */
+void SlPostingList::_put_varint(uint32_t value) {
+    while (value >= 0x80) {
+        _bytes.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    _bytes.push_back(uint8_t(value));
+}
+
+/**
+ * @brief Encodes the pending run, if there is one.
+ */
+void SlPostingList::_flush_run() {
+    if (_run_length == 0)
+        return;
+
+    _put_varint(_run_start - _encoded_end);
+    _put_varint(_run_length - 1);
+    _encoded_end = _run_start + _run_length;
+    _run_length = 0;
+}
+
+/**
+ * @brief Appends an event index to the list. Indices must be appended
+ * in ascending order and without repetitions.
+ *
+ * @param event_idx: index of the event
+ */
+void SlPostingList::append(uint32_t event_idx) {
+    if (_run_length > 0 && event_idx == _run_start + _run_length) {
+        ++_run_length;
+    } else {
+        _flush_run();
+        _run_start = event_idx;
+        _run_length = 1;
+    }
+    ++_count;
+}
+
+/**
+ * @brief Encodes the last run and releases unused memory. Must be called
+ * after the last `append`, before decoding.
+ */
+void SlPostingList::finish() {
+    _flush_run();
+    _bytes.shrink_to_fit();
+}
+
+/**
+ * @brief Gets the number of event indices in the list.
+ *
+ * @returns Count of the indices.
+ */
+uint32_t SlPostingList::count() const
+{ return _count; }
+
+/**
+ * @brief Gets the size of the encoded list.
+ *
+ * @returns Number of bytes the encoded runs take.
+ */
+size_t SlPostingList::byte_size() const
+{ return _bytes.size(); }
+
+/**
+ * @brief Decodes the list and appends its indices to a vector.
+ *
+ * @param out: vector to append the indices to
+ */
+void SlPostingList::decode(std::vector<uint32_t>& out) const {
+    out.reserve(out.size() + _count);
+
+    size_t pos = 0;
+    auto get_varint = [&]() {
+        uint32_t value = 0;
+        for (int shift = 0; pos < _bytes.size(); shift += 7) {
+            const uint8_t byte = _bytes[pos++];
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        return value;
+    };
+
+    uint32_t end = 0;
+    while (pos < _bytes.size()) {
+        const uint32_t start = end + get_varint();
+        end = start + get_varint() + 1;
+        for (uint32_t idx = start; idx < end; ++idx) {
+            out.push_back(idx);
+        }
+    }
+}
+
+// Class functions - symbol index
+
+/**
+ * @brief Builds posting lists of all symbols. Each event is appended
+ * to the list of every distinct symbol of its stack exactly once.
+ *
+ * @param symbols: interned symbols
+ * @param stacks: interned stacks
+ * @param event_stacks: stack ID of each collected event
+ */
+void SlSymbolIndex::build(const SlSymbolTable& symbols,
+                          const SlStackTable& stacks,
+                          std::span<const uint32_t> event_stacks) {
+    _postings.assign(symbols.size(), SlPostingList{});
+
+    // Distinct symbols of each stack, recursive functions would
+    // otherwise append the same event more than once.
+    std::vector<std::vector<uint32_t>> stack_symbols(stacks.size());
+    for (uint32_t stack_id = 0; stack_id < stacks.size(); ++stack_id) {
+        std::span<const uint32_t> frames = stacks.frames(stack_id);
+        std::vector<uint32_t>& distinct = stack_symbols[stack_id];
+        distinct.assign(frames.begin(), frames.end());
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                       distinct.end());
+    }
+
+    for (uint32_t i = 0; i < event_stacks.size(); ++i) {
+        if (event_stacks[i] == SlStreamIndex::NO_STACK)
+            continue;
+        for (uint32_t symbol : stack_symbols[event_stacks[i]]) {
+            _postings[symbol].append(i);
+        }
+    }
+
+    for (SlPostingList& postings : _postings) {
+        postings.finish();
+    }
+}
+
+/**
+ * @brief Gets the posting list of a symbol.
+ *
+ * @param symbol: ID of the symbol
+ *
+ * @returns Pointer to the posting list, nullptr for unknown symbols.
+ */
+const SlPostingList* SlSymbolIndex::postings(uint32_t symbol) const {
+    return (symbol < _postings.size()) ? &_postings[symbol] : nullptr;
+}
+
+/**
+ * @brief Gets the memory taken by all encoded posting lists.
+ *
+ * @returns Number of bytes of all lists.
+ */
+size_t SlSymbolIndex::byte_size() const {
+    size_t total = 0;
+    for (const SlPostingList& postings : _postings) {
+        total += postings.byte_size();
+    }
+    return total;
+}
+
+/**
+ * @brief Finds events whose stack contains any of the symbols.
+ *
+ * @param symbols: IDs of the symbols to search for
+ *
+ * @returns Ascending indices of the events, without repetitions.
+ */
+std::vector<uint32_t> SlSymbolIndex::search(
+    std::span<const uint32_t> symbols) const {
+    std::vector<uint32_t> hits;
+    for (uint32_t symbol : symbols) {
+        const SlPostingList* list = postings(symbol);
+        if (list == nullptr)
+            continue;
+        const size_t old_size = hits.size();
+        list->decode(hits);
+        // Keep the hits sorted as lists get added
+        if (old_size > 0) {
+            std::inplace_merge(hits.begin(), hits.begin() + old_size,
+                               hits.end());
+        }
+    }
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    return hits;
+}
+
+// Global functions
+
+/**
+ * @brief Finds interned symbols matching a query.
+ *
+ * @param symbols: interned symbols
+ * @param query: text to look for
+ * @param exact: whether symbols must equal the query, otherwise it is
+ * enough if they contain it
+ *
+ * @returns IDs of the matching symbols.
+ */
+std::vector<uint32_t> find_symbols(const SlSymbolTable& symbols,
+                                   std::string_view query, bool exact) {
+    std::vector<uint32_t> found;
+    if (query.empty())
+        return found;
+
+    for (uint32_t id = 0; id < symbols.size(); ++id) {
+        std::string_view text = symbols.text(id);
+        const bool matches = exact ? (text == query)
+                                   : (text.find(query) != std::string_view::npos);
+        if (matches)
+            found.push_back(id);
+    }
+    return found;
+}
@@ -0,0 +1,87 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlSymbolIndex.hpp
+ * @brief   Declares the inverted index from interned kernel stack symbols
+ *          to compressed posting lists of collected events' indices.
+ *
+ * @note    Definitions in `SlSymbolIndex.cpp`.
+*/
+
+#ifndef _SL_SYMBOL_INDEX_HPP
+#define _SL_SYMBOL_INDEX_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Forward declarations
+class SlSymbolTable;
+class SlStackTable;
+
+/**
+ * @brief Compressed, ascending list of event indices. Consecutive indices
+ * form runs and each run is stored as two variable-length integers - the
+ * gap from the end of the previous run and the run's length minus one.
+ * Lists of symbols present in nearly every stack thus take very little
+ * memory.
+ */
+class SlPostingList {
+private: // Data members
+    ///
+    /// @brief Encoded runs.
+    std::vector<uint8_t> _bytes;
+
+    ///
+    /// @brief Number of indices in the list.
+    uint32_t _count{0};
+
+    ///
+    /// @brief One past the last index of the last encoded run.
+    uint32_t _encoded_end{0};
+
+    ///
+    /// @brief First index of the run not encoded yet.
+    uint32_t _run_start{0};
+
+    ///
+    /// @brief Length of the run not encoded yet, `0` if there is none.
+    uint32_t _run_length{0};
+private: // Functions
+    void _put_varint(uint32_t value);
+    void _flush_run();
+public: // Functions
+    void append(uint32_t event_idx);
+    void finish();
+    uint32_t count() const;
+    size_t byte_size() const;
+    void decode(std::vector<uint32_t>& out) const;
+};
+
+/**
+ * @brief Inverted index from interned symbols to posting lists of indices
+ * of collected events whose kernel stack contains the symbol. It is built
+ * once per stream, from the stream index's stack IDs.
+ */
+class SlSymbolIndex {
+private: // Data members
+    ///
+    /// @brief Posting list of each symbol, by symbol ID.
+    std::vector<SlPostingList> _postings;
+public: // Functions
+    void build(const SlSymbolTable& symbols, const SlStackTable& stacks,
+               std::span<const uint32_t> event_stacks);
+    const SlPostingList* postings(uint32_t symbol) const;
+    size_t byte_size() const;
+    std::vector<uint32_t> search(std::span<const uint32_t> symbols) const;
+};
+
+// Global functions
+std::vector<uint32_t> find_symbols(const SlSymbolTable& symbols,
+                                   std::string_view query, bool exact);
+
+#endif
@@ -0,0 +1,356 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlThreadPool.cpp
+ * @brief   Defines the work-stealing thread pool and task groups.
+ *
+ *          Resizing stops all workers after their current tasks, keeps
+ *          queued tasks and hands them out to the new workers. Waiting for
+ *          a group runs its queued tasks meanwhile, so a task may wait for
+ *          tasks it submitted without starving the pool.
+*/
+
+// C++
+#include <algorithm>
+#include <iterator>
+
+// Plugin
+#include "SlThreadPool.hpp"
+
+// Static variables
+
+///
+/// @brief Queue of the worker running on this thread, if it is a worker.
+static thread_local size_t worker_queue = 0;
+
+///
+/// @brief Whether this thread is a worker of the pool.
+static thread_local bool is_worker = false;
+
+// SlThreadPool
+
+/**
+ * @brief Creates the pool with one worker per core.
+ */
+SlThreadPool::SlThreadPool() {
+    _start(0);
+}
+
+/**
+ * @brief Stops the workers. Tasks still queued are skipped, as if their
+ * groups were cancelled.
+ */
+SlThreadPool::~SlThreadPool() {
+    _stop();
+    for (std::unique_ptr<_Queue>& queue : _queues) {
+        for (_Task& task : queue->tasks) {
+            task.group->_task_done();
+        }
+    }
+}
+
+/**
+ * @brief Gets the pool, creating it on the first call.
+ *
+ * @returns The process-wide pool.
+ */
+SlThreadPool& SlThreadPool::get_instance() {
+    static SlThreadPool instance;
+    return instance;
+}
+
+/**
+ * @brief Starts workers and moves queued tasks to their queues.
+ *
+ * @param workers: number of workers, `0` meaning one per core
+ *
+ * @note No worker may be running.
+ */
+void SlThreadPool::_start(unsigned workers) {
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    std::deque<_Task> queued;
+    for (std::unique_ptr<_Queue>& queue : _queues) {
+        std::move(queue->tasks.begin(), queue->tasks.end(),
+                  std::back_inserter(queued));
+    }
+
+    _queues.clear();
+    for (unsigned i = 0; i < workers; ++i) {
+        _queues.push_back(std::make_unique<_Queue>());
+    }
+    for (size_t i = 0; i < queued.size(); ++i) {
+        _queues[i % workers]->tasks.push_back(std::move(queued[i]));
+    }
+
+    _stopping.store(false, std::memory_order_relaxed);
+    for (unsigned i = 0; i < workers; ++i) {
+        _workers.emplace_back(&SlThreadPool::_work, this, size_t(i));
+    }
+}
+
+/**
+ * @brief Stops all workers once they finish their current tasks.
+ * Queued tasks stay queued, workers don't take any once stopping.
+ */
+void SlThreadPool::_stop() {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping.store(true, std::memory_order_release);
+    }
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+}
+
+/**
+ * @brief Queues a task. Workers queue to their own queue, other threads
+ * spread their tasks over all queues.
+ *
+ * @param task: task to queue
+ */
+void SlThreadPool::_submit(_Task&& task) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        const size_t index = is_worker ? worker_queue :
+            _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+        _Queue& queue = *_queues[index];
+
+        std::lock_guard<std::mutex> queue_guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+        _queued.fetch_add(1, std::memory_order_release);
+    }
+    _wake.notify_one();
+}
+
+/**
+ * @brief Takes a task, the newest of the first queue or, if it is empty,
+ * the oldest of any other queue.
+ *
+ * @param first_queue: queue to take from first
+ * @param task: output location for the taken task
+ *
+ * @returns True if a task was taken, false if all queues were empty.
+ *
+ * @note Caller must hold `_lock`, or be a worker, which is never
+ * running while queues are replaced.
+ */
+bool SlThreadPool::_take(size_t first_queue, _Task& task) {
+    if (_queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    const size_t count = _queues.size();
+    for (size_t i = 0; i < count; ++i) {
+        _Queue& queue = *_queues[(first_queue + i) % count];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty())
+            continue;
+
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        _queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Takes the newest queued task of a group, from whichever queue
+ * it is in.
+ *
+ * @param group: group whose task to take
+ * @param task: output location for the taken task
+ *
+ * @returns True if a task was taken, false if the group has none queued.
+ *
+ * @note Caller must hold `_lock`, or be a worker, which is never
+ * running while queues are replaced.
+ */
+bool SlThreadPool::_take_of(const SlTaskGroup* group, _Task& task) {
+    if (_queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    for (std::unique_ptr<_Queue>& queue : _queues) {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        for (auto it = queue->tasks.rbegin(); it != queue->tasks.rend(); ++it) {
+            if (it->group != group)
+                continue;
+
+            task = std::move(*it);
+            queue->tasks.erase(std::next(it).base());
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Runs a task, unless its group was cancelled, and tells the
+ * group that it's done.
+ *
+ * @param task: task to run
+ */
+void SlThreadPool::_execute(_Task& task) {
+    SlTaskGroup* group = task.group;
+    if (!group->is_cancelled())
+        task.work();
+    task.work = nullptr;
+    group->_task_done();
+}
+
+/**
+ * @brief Loop of a worker, runs tasks until the pool stops.
+ *
+ * @param own_queue: index of the worker's queue
+ */
+void SlThreadPool::_work(size_t own_queue) {
+    is_worker = true;
+    worker_queue = own_queue;
+
+    _Task task;
+    while (true) {
+        // Checked before taking, so that stopping doesn't wait for the queues
+        if (_stopping.load(std::memory_order_acquire))
+            return;
+
+        if (_take(own_queue, task)) {
+            _execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(_lock);
+        _wake.wait(guard, [this]() {
+            return _stopping.load(std::memory_order_relaxed)
+                   || _queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+/**
+ * @brief Gets the number of workers.
+ *
+ * @returns Number of workers.
+ */
+unsigned SlThreadPool::size() const
+{ return unsigned(_queues.size()); }
+
+/**
+ * @brief Changes the number of workers. Running tasks finish first,
+ * queued tasks are kept and run by the new workers.
+ *
+ * @param workers: number of workers, `0` meaning one per core
+ *
+ * @note Must not be called from a task.
+ */
+void SlThreadPool::resize(unsigned workers) {
+    const unsigned wanted = (workers == 0) ?
+        std::max(1u, std::thread::hardware_concurrency()) : workers;
+    if (wanted == size())
+        return;
+
+    _stop();
+    std::lock_guard<std::mutex> guard(_lock);
+    _start(wanted);
+}
+
+/**
+ * @brief Runs one queued task of a group on the calling thread, if the
+ * group has any.
+ *
+ * @param group: group whose task to run
+ *
+ * @returns True if a task was run, false otherwise.
+ */
+bool SlThreadPool::_run_one_of(const SlTaskGroup* group) {
+    _Task task;
+    bool taken;
+    if (is_worker) {
+        taken = _take_of(group, task);
+    } else {
+        std::lock_guard<std::mutex> guard(_lock);
+        taken = _take_of(group, task);
+    }
+
+    if (taken)
+        _execute(task);
+    return taken;
+}
+
+// SlTaskGroup
+
+/**
+ * @brief Cancels tasks which haven't started and waits for the rest.
+ */
+SlTaskGroup::~SlTaskGroup() {
+    cancel();
+    wait();
+}
+
+/**
+ * @brief Notes that a task of the group is done, waking waiters if it
+ * was the last one.
+ *
+ * @note Counted under the lock, so that a waiter, which takes the lock
+ * before returning, can't destroy the group while it is being notified.
+ */
+void SlTaskGroup::_task_done() {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        _done.notify_all();
+}
+
+/**
+ * @brief Submits work to the pool as a task of the group. Nothing is
+ * submitted if the group was cancelled.
+ *
+ * @param work: work to run on some worker
+ */
+void SlTaskGroup::run(std::function<void()> work) {
+    if (is_cancelled())
+        return;
+
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    SlThreadPool::get_instance()._submit({std::move(work), this});
+}
+
+/**
+ * @brief Waits until all tasks of the group are done or skipped. Queued
+ * tasks of the group are run on the calling thread meanwhile, tasks of
+ * other groups are left to the workers.
+ */
+void SlTaskGroup::wait() {
+    SlThreadPool& pool = SlThreadPool::get_instance();
+    while (pool._run_one_of(this)) {}
+
+    // The rest is running, or queued by a running task to its own worker
+    std::unique_lock<std::mutex> guard(_lock);
+    _done.wait(guard, [this]() {
+        return _pending.load(std::memory_order_acquire) == 0;
+    });
+}
+
+/**
+ * @brief Cancels the group, so that its tasks which haven't started are
+ * skipped and no new ones are submitted. Running tasks can check
+ * `is_cancelled` to stop early.
+ */
+void SlTaskGroup::cancel()
+{ _cancelled.store(true, std::memory_order_relaxed); }
+
+/**
+ * @brief Checks whether the group was cancelled.
+ *
+ * @returns True if the group was cancelled, false otherwise.
+ */
+bool SlTaskGroup::is_cancelled() const
+{ return _cancelled.load(std::memory_order_relaxed); }
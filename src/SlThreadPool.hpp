@@ -0,0 +1,148 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlThreadPool.hpp
+ * @brief   Declares the process-wide work-stealing thread pool of the
+ *          plugin and task groups, through which work is submitted to it.
+ *
+ *          Each worker has its own queue, it takes its newest tasks first
+ *          and, when the queue is empty, steals the oldest tasks of other
+ *          workers. A task group tracks tasks of one owner, e.g. a stream,
+ *          so that they can be cancelled and waited for together.
+ *
+ * @note    Definitions in `SlThreadPool.cpp`.
+*/
+
+#ifndef _SL_THREAD_POOL_HPP
+#define _SL_THREAD_POOL_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// For friending purposes
+class SlTaskGroup;
+
+/**
+ * @brief Work-stealing thread pool shared by everything in the process.
+ * Created with one worker per core, resized by the configuration.
+ */
+class SlThreadPool {
+friend class SlTaskGroup;
+private: // Types
+    /**
+     * @brief Queued task along with the group it belongs to.
+     */
+    struct _Task {
+        ///
+        /// @brief Work of the task.
+        std::function<void()> work;
+        ///
+        /// @brief Group of the task, notified once the task is done.
+        SlTaskGroup* group;
+    };
+
+    /**
+     * @brief Queue of one worker, locked separately from other queues.
+     */
+    struct _Queue {
+        ///
+        /// @brief Guards the tasks.
+        std::mutex lock;
+        ///
+        /// @brief Tasks, the owning worker takes from the back, thieves
+        /// from the front.
+        std::deque<_Task> tasks;
+    };
+private: // Data members
+    ///
+    /// @brief Queues, one per worker.
+    std::vector<std::unique_ptr<_Queue>> _queues;
+
+    ///
+    /// @brief Threads of the workers.
+    std::vector<std::thread> _workers;
+
+    /// @brief Guards starting and stopping of workers, along with
+    /// sleeping of idle workers.
+    std::mutex _lock;
+
+    ///
+    /// @brief Wakes idle workers when tasks come or workers should stop.
+    std::condition_variable _wake;
+
+    ///
+    /// @brief Number of queued tasks, so that idle workers know to look.
+    std::atomic<size_t> _queued{0};
+
+    ///
+    /// @brief Queue the next task submitted from outside the pool goes to.
+    std::atomic<size_t> _next_queue{0};
+
+    /// @brief Whether workers should exit, set under `_lock` but read
+    /// by workers between tasks without it.
+    std::atomic<bool> _stopping{false};
+private: // Functions
+    SlThreadPool();
+    void _start(unsigned workers);
+    void _stop();
+    void _submit(_Task&& task);
+    bool _take(size_t first_queue, _Task& task);
+    bool _take_of(const SlTaskGroup* group, _Task& task);
+    bool _run_one_of(const SlTaskGroup* group);
+    static void _execute(_Task& task);
+    void _work(size_t own_queue);
+public: // Functions
+    static SlThreadPool& get_instance();
+    ~SlThreadPool();
+    SlThreadPool(const SlThreadPool&) = delete;
+    SlThreadPool& operator=(const SlThreadPool&) = delete;
+
+    unsigned size() const;
+    void resize(unsigned workers);
+};
+
+/**
+ * @brief Group of tasks run by the thread pool. Tasks of a cancelled
+ * group which have not started yet are skipped. The group must not be
+ * destroyed before its tasks are done, `cancel` and `wait` ensure that.
+ */
+class SlTaskGroup {
+friend class SlThreadPool;
+private: // Data members
+    ///
+    /// @brief Number of submitted tasks which aren't done yet.
+    std::atomic<size_t> _pending{0};
+
+    ///
+    /// @brief Whether tasks which haven't started yet should be skipped.
+    std::atomic<bool> _cancelled{false};
+
+    ///
+    /// @brief Guards waiting for the tasks.
+    std::mutex _lock;
+
+    ///
+    /// @brief Wakes waiters once no task is pending.
+    std::condition_variable _done;
+private: // Functions
+    void _task_done();
+public: // Functions
+    SlTaskGroup() = default;
+    ~SlTaskGroup();
+    SlTaskGroup(const SlTaskGroup&) = delete;
+    SlTaskGroup& operator=(const SlTaskGroup&) = delete;
+
+    void run(std::function<void()> work);
+    void wait();
+    void cancel();
+    bool is_cancelled() const;
+};
+
+#endif
@@ -0,0 +1,258 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlTopStacksView.cpp
+ * @brief   Defines the window with the table of the most frequent kernel
+ *          stacks.
+*/
+
+// KernelShark
+#include "libkshark.h"
+#include "KsMainWindow.hpp"
+
+// Plugin headers
+#include "stacklook.h"
+#include "SlConfig.hpp"
+#include "SlPrevState.hpp"
+#include "SlTopStacksView.hpp"
+
+// Static functions
+
+///
+/// @brief Indices of the table's columns.
+enum _top_stacks_column : int {
+    GROUP_COL = 0,
+    COUNT_COL,
+    ERROR_COL,
+    DEPTH_COL,
+    STACK_COL,
+    COLUMNS_COUNT
+};
+
+/**
+ * @brief Creates a table item which sorts by its numerical value.
+ *
+ * @param value: number to show
+ *
+ * @returns Pointer to the new item, to be owned by a table.
+ */
+static QTableWidgetItem* _number_item(qulonglong value) {
+    auto item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, value);
+    return item;
+}
+
+/**
+ * @brief Joins frames of a stack into one line, top of the stack first.
+ *
+ * @param index: index holding the interned stack
+ * @param stack_id: ID of the stack
+ *
+ * @returns Text of the stack.
+ */
+static QString _stack_text(const SlStreamIndex* index, uint32_t stack_id) {
+    QStringList frames;
+    for (uint32_t symbol : index->stacks().frames(stack_id)) {
+        frames.append(QString::fromUtf8(index->symbols().text(symbol)));
+    }
+    return frames.join(" <- ");
+}
+
+// Class functions
+
+/**
+ * @brief Constructor of the most frequent stacks window.
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+SlTopStacksView::SlTopStacksView()
+    : QWidget(SlConfig::main_w_ptr), // Configuration access here
+    _group_label("Group by: ", this),
+    _group_combo(this),
+    _per_group_label("Stacks per group: ", this),
+    _per_group(this),
+    _table(this),
+    _status_label(this),
+    _close_button("Close", this)
+{
+    setWindowTitle("Stacklook - Most Frequent Stacks");
+    // Set window flags to make header buttons
+    setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint
+                   | Qt::WindowMaximizeButtonHint
+                   | Qt::WindowCloseButtonHint);
+    resize(1000, 500);
+
+    // Order must match SlHitterGroup
+    _group_combo.addItems({"CPU", "Task", "Prev state"});
+    _per_group.setMinimum(1);
+    _per_group.setMaximum(1000);
+    _per_group.setValue(10);
+
+    _group_layout.addWidget(&_group_label);
+    _group_layout.addWidget(&_group_combo);
+    _group_layout.addStretch();
+    _group_layout.addWidget(&_per_group_label);
+    _group_layout.addWidget(&_per_group);
+
+    _table.setColumnCount(COLUMNS_COUNT);
+    _table.setHorizontalHeaderLabels({"Group", "Count", "Error (+/-)",
+                                      "Depth", "Stack (top first)"});
+    _table.horizontalHeader()->setStretchLastSection(true);
+    _table.setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _table.setSelectionBehavior(QAbstractItemView::SelectRows);
+    _table.setSelectionMode(QAbstractItemView::SingleSelection);
+
+    _layout.addLayout(&_group_layout);
+    _layout.addWidget(&_table);
+    _layout.addWidget(&_status_label);
+    _layout.addWidget(&_close_button);
+
+    connect(&_group_combo, &QComboBox::currentIndexChanged,
+            this, [this]() { _fill_table(); });
+    connect(&_per_group, &QSpinBox::valueChanged,
+            this, [this]() { _fill_table(); });
+    connect(&_table, &QTableWidget::cellClicked,
+            this, [this](int row, int) { _jump_to_row(row); });
+    connect(&_close_button, &QPushButton::pressed,
+            this, &QWidget::close);
+
+    setLayout(&_layout);
+}
+
+/**
+ * @brief Gets a human readable name of a group.
+ *
+ * @param group_value: CPU, PID or prev_state letter
+ *
+ * @returns Text naming the group.
+ */
+QString SlTopStacksView::_group_text(uint32_t group_value) const {
+    switch ((SlHitterGroup)_group_combo.currentIndex()) {
+        case SlHitterGroup::CPU:
+            return QString("CPU %1").arg(group_value);
+        case SlHitterGroup::TASK:
+            return QString("PID %1").arg(group_value);
+        default: {
+            const char letter = (char)group_value;
+            const char* name = LETTER_TO_NAME.count(letter) ?
+                LETTER_TO_NAME.at(letter) : "unknown";
+            return QString("%1 - %2").arg(QChar(letter)).arg(name);
+        }
+    }
+}
+
+/**
+ * @brief Fills the table with the most frequent stacks of the current
+ * grouping. Sorting is disabled while the table is being filled, as
+ * recommended by Qt.
+ */
+void SlTopStacksView::_fill_table() {
+    _table.setSortingEnabled(false);
+    _table.setRowCount(0);
+    _rows.clear();
+    _cursors.clear();
+
+    if (_index == nullptr) {
+        _status_label.setText("No kernel stacks to show.");
+        return;
+    }
+
+    const auto group = (SlHitterGroup)_group_combo.currentIndex();
+    _rows = _index->heavy_hitters().top(group, size_t(_per_group.value()));
+    _cursors.assign(_rows.size(), -1);
+
+    _table.setRowCount(int(_rows.size()));
+    for (int row = 0; row < int(_rows.size()); ++row) {
+        const SlStackHitter& hitter = _rows[row];
+        auto group_item = new QTableWidgetItem(_group_text(hitter.group_value));
+        // Rows get reordered by sorting, remember which one this is
+        group_item->setData(Qt::UserRole, row);
+
+        _table.setItem(row, GROUP_COL, group_item);
+        _table.setItem(row, COUNT_COL, _number_item(hitter.count));
+        _table.setItem(row, ERROR_COL, _number_item(hitter.error));
+        _table.setItem(row, DEPTH_COL, _number_item(
+            _index->stacks().frames(hitter.stack_id).size()));
+        _table.setItem(row, STACK_COL, new QTableWidgetItem(
+            _stack_text(_index, hitter.stack_id)));
+    }
+
+    _table.setSortingEnabled(true);
+    _table.sortByColumn(COUNT_COL, Qt::DescendingOrder);
+    _status_label.setText(QString("Stream %1, click a row to mark the next "
+                                  "occurrence of its stack.").arg(_stream_id));
+}
+
+/**
+ * @brief Marks the next occurrence of a row's stack in the row's group
+ * with KernelShark's marker A. The search wraps around the end of the
+ * trace.
+ *
+ * @param row: row of the table which was clicked
+ *
+ * @note It uses the main window pointer kept by 'SlConfig'.
+ */
+void SlTopStacksView::_jump_to_row(int row) {
+    QTableWidgetItem* group_item = _table.item(row, GROUP_COL);
+    if (_index == nullptr || group_item == nullptr)
+        return;
+
+    const size_t hitter_idx = group_item->data(Qt::UserRole).toULongLong();
+    const SlStackHitter& hitter = _rows[hitter_idx];
+    const auto group = (SlHitterGroup)_group_combo.currentIndex();
+    const kshark_data_container* events = _index->events();
+
+    auto in_group = [&](ssize_t i) {
+        const kshark_entry* entry = events->data[i]->entry;
+        switch (group) {
+            case SlHitterGroup::CPU:
+                return uint32_t(entry->cpu) == hitter.group_value;
+            case SlHitterGroup::TASK:
+                return uint32_t(entry->pid) == hitter.group_value;
+            default:
+                return uint32_t(_index->prev_state_of(i)) == hitter.group_value;
+        }
+    };
+
+    const ssize_t size = _index->size();
+    const ssize_t start = _cursors[hitter_idx] + 1;
+    for (ssize_t step = 0; step < size; ++step) {
+        const ssize_t i = (start + step) % size;
+        if (_index->stack_of(i) != hitter.stack_id || !in_group(i))
+            continue;
+
+        _cursors[hitter_idx] = i;
+        // Configuration access here
+        SlConfig::main_w_ptr->markEntry(events->data[i]->entry,
+                                        DualMarkerState::A);
+        _status_label.setText(QString("Marked occurrence at %1 s.")
+            .arg(double(events->data[i]->entry->ts) / 1e9, 0, 'f', 6));
+        return;
+    }
+}
+
+/**
+ * @brief Shows the most frequent stacks of a stream, building the
+ * stream's index first if needed.
+ *
+ * @param stream_id: stream whose stacks to show
+ */
+void SlTopStacksView::show_stream(int stream_id) {
+    _stream_id = stream_id;
+    _index = (stream_id >= 0) ? get_stream_index(stream_id) : nullptr;
+    _fill_table();
+    show();
+}
+
+/**
+ * @brief Empties the table if its rows were taken from an index which
+ * is about to be freed.
+ *
+ * @param index: index to be freed
+ */
+void SlTopStacksView::index_freed(const SlStreamIndex* index) {
+    if (_index == index) {
+        _index = nullptr;
+        _fill_table();
+    }
+}
@@ -0,0 +1,93 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlTopStacksView.hpp
+ * @brief   Declares the window with a sortable table of the most frequent
+ *          kernel stacks per CPU, task or prev_state.
+ *
+ * @note    Definitions in `SlTopStacksView.cpp`.
+*/
+
+#ifndef _SL_TOP_STACKS_VIEW_HPP
+#define _SL_TOP_STACKS_VIEW_HPP
+
+// C++
+#include <vector>
+
+// Qt
+#include <QtWidgets>
+
+// Plugin
+#include "SlStreamIndex.hpp"
+
+/**
+ * @brief Window showing the most frequent kernel stacks of a stream, as
+ * estimated by the heavy hitters aggregator of the stream's index. Rows
+ * can be sorted by any column. Clicking a row marks the next occurrence
+ * of the row's stack in the row's group with KernelShark's marker A,
+ * clicking it again moves on to the following occurrence.
+ */
+class SlTopStacksView : public QWidget {
+private: // Data members
+    ///
+    /// @brief Stream whose stacks are shown, -1 if none.
+    int _stream_id{-1};
+
+    ///
+    /// @brief Index the rows were taken from, not owned.
+    const SlStreamIndex* _index{nullptr};
+
+    ///
+    /// @brief Rows of the table, in the order they were inserted.
+    std::vector<SlStackHitter> _rows;
+
+    /// @brief Container index of the last marked occurrence of each
+    /// row's stack, -1 if no occurrence was marked yet.
+    std::vector<ssize_t> _cursors;
+private: // Qt data members
+    ///
+    /// @brief Layout for the widget's control elements.
+    QVBoxLayout     _layout;
+
+    ///
+    /// @brief Layout for the grouping controls.
+    QHBoxLayout     _group_layout;
+
+    ///
+    /// @brief Explanation of the grouping combo box.
+    QLabel          _group_label;
+
+    ///
+    /// @brief Chooses the grouping - CPU, task or prev_state.
+    QComboBox       _group_combo;
+
+    ///
+    /// @brief Explanation of the spinbox next to it.
+    QLabel          _per_group_label;
+
+    ///
+    /// @brief How many stacks to show for each group.
+    QSpinBox        _per_group;
+
+    ///
+    /// @brief Table of the most frequent stacks.
+    QTableWidget    _table;
+
+    ///
+    /// @brief Shows which stream is shown or why nothing is.
+    QLabel          _status_label;
+public: // Qt data members
+    ///
+    /// @brief Close button for the widget.
+    QPushButton     _close_button;
+private: // Functions
+    void _fill_table();
+    void _jump_to_row(int row);
+    QString _group_text(uint32_t group_value) const;
+public: // Functions
+    SlTopStacksView();
+    void show_stream(int stream_id);
+    void index_freed(const SlStreamIndex* index);
+};
+
+#endif
@@ -0,0 +1,203 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlWarmStart.cpp
+ * @brief   Defines warm-start records of trace files and their storage.
+*/
+
+// C++
+#include <algorithm>
+
+// Plugin
+#include "SlWarmStart.hpp"
+
+// Static variables
+
+///
+/// @brief Version of the file's format, files of other versions are ignored.
+static constexpr int WARM_START_VERSION = 2;
+
+///
+/// @brief Records kept at most, least recently used ones are dropped.
+static constexpr size_t MAX_RECORDS = 256;
+
+// Static functions
+
+/**
+ * @brief Gets the key and the current state of a trace file.
+ *
+ * @param trace_file: path of the trace file
+ * @param key: output location for the canonical path
+ * @param size: output location for the file's size
+ * @param mtime: output location for the file's modification time
+ *
+ * @returns True if the file exists, false otherwise.
+ */
+static bool _stat_trace(const char* trace_file, std::string& key,
+                        int64_t& size, int64_t& mtime) {
+    if (trace_file == nullptr || *trace_file == '\0')
+        return false;
+
+    const QFileInfo info(QString::fromLocal8Bit(trace_file));
+    if (!info.exists())
+        return false;
+
+    key = info.canonicalFilePath().toStdString();
+    size = info.size();
+    mtime = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+// SlWarmStart
+
+/**
+ * @brief Gets the warm-start state. Utilizes Meyers singleton creation
+ * (static local variable).
+ *
+ * @returns Reference to the warm-start state.
+ */
+SlWarmStart& SlWarmStart::get_instance() {
+    static SlWarmStart instance;
+    return instance;
+}
+
+/**
+ * @brief Gets the path of the file with the records.
+ *
+ * @returns Path of the JSON file.
+ */
+QString SlWarmStart::_path() {
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + "/stacklook/warm-start.json";
+}
+
+/**
+ * @brief Reads the records from the disk, once. A missing or unreadable
+ * file means no records.
+ */
+void SlWarmStart::_load() {
+    if (_loaded)
+        return;
+    _loaded = true;
+
+    QFile file(_path());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != WARM_START_VERSION)
+        return;
+
+    const QJsonObject traces = root.value("traces").toObject();
+    for (auto it = traces.begin(); it != traces.end(); ++it) {
+        const QJsonObject record = it.value().toObject();
+        std::vector<int> collected_events;
+        for (const QJsonValue event_id : record.value("collected_events").toArray()) {
+            collected_events.push_back(event_id.toInt());
+        }
+
+        _traces[it.key().toStdString()] = {
+            (int64_t)record.value("size").toDouble(),
+            (int64_t)record.value("mtime").toDouble(),
+            std::move(collected_events),
+            record.value("kstacks_exist").toBool(),
+            (int64_t)record.value("last_used").toDouble()
+        };
+    }
+}
+
+/**
+ * @brief Writes the records to the disk, creating the directory if
+ * needed. Failures are ignored, the records are only an optimization.
+ */
+void SlWarmStart::_save() const {
+    QJsonObject traces;
+    for (const auto& [path, record] : _traces) {
+        QJsonObject entry;
+        entry["size"] = (double)record.size;
+        entry["mtime"] = (double)record.mtime;
+        QJsonArray collected_events;
+        for (int event_id : record.collected_events) {
+            collected_events.append(event_id);
+        }
+        entry["collected_events"] = collected_events;
+        entry["kstacks_exist"] = record.kstacks_exist;
+        entry["last_used"] = (double)record.last_used;
+        traces[QString::fromStdString(path)] = entry;
+    }
+
+    QJsonObject root;
+    root["version"] = WARM_START_VERSION;
+    root["traces"] = traces;
+
+    const QString path = _path();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+/**
+ * @brief Looks up whether kernel stacks were found in a trace file
+ * in an earlier session.
+ *
+ * @param trace_file: path of the trace file
+ * @param collected_events: numerical ids of the events collected from
+ * the trace, in any order
+ *
+ * @returns Whether kernel stacks exist in the trace, nothing if the trace
+ * is unknown, changed since or other events were collected then.
+ */
+std::optional<bool> SlWarmStart::known_kstacks(const char* trace_file,
+                                               std::vector<int> collected_events) {
+    std::string key;
+    int64_t size, mtime;
+    if (!_stat_trace(trace_file, key, size, mtime))
+        return std::nullopt;
+
+    _load();
+    std::sort(collected_events.begin(), collected_events.end());
+    auto found = _traces.find(key);
+    if (found == _traces.end() || found->second.size != size
+        || found->second.mtime != mtime
+        || found->second.collected_events != collected_events)
+        return std::nullopt;
+
+    found->second.last_used = QDateTime::currentMSecsSinceEpoch();
+    return found->second.kstacks_exist;
+}
+
+/**
+ * @brief Remembers whether kernel stacks were found in a trace file
+ * and writes the records to the disk.
+ *
+ * @param trace_file: path of the trace file
+ * @param collected_events: numerical ids of the events collected from
+ * the trace, in any order
+ * @param kstacks_exist: whether kernel stacks were found
+ */
+void SlWarmStart::remember_kstacks(const char* trace_file,
+                                   std::vector<int> collected_events,
+                                   bool kstacks_exist) {
+    std::string key;
+    int64_t size, mtime;
+    if (!_stat_trace(trace_file, key, size, mtime))
+        return;
+
+    _load();
+    std::sort(collected_events.begin(), collected_events.end());
+    _traces[key] = {size, mtime, std::move(collected_events), kstacks_exist,
+                    QDateTime::currentMSecsSinceEpoch()};
+
+    while (_traces.size() > MAX_RECORDS) {
+        auto oldest = std::min_element(_traces.begin(), _traces.end(),
+            [](const auto& a, const auto& b) {
+                return a.second.last_used < b.second.last_used;
+            });
+        _traces.erase(oldest);
+    }
+
+    _save();
+}
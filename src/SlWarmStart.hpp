@@ -0,0 +1,77 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    SlWarmStart.hpp
+ * @brief   Declares warm-start state of the plugin - facts computed for
+ *          trace files which are kept across KernelShark sessions, so that
+ *          reopening a trace doesn't compute them again.
+ *
+ * @note    Definitions in `SlWarmStart.cpp`.
+*/
+
+#ifndef _SL_WARM_START_HPP
+#define _SL_WARM_START_HPP
+
+// C
+#include <stdint.h>
+
+// C++
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Qt
+#include <QtCore>
+
+/**
+ * @brief Facts remembered about one trace file.
+ */
+struct SlTraceRecord {
+    ///
+    /// @brief Size of the file when the facts were computed.
+    int64_t size;
+    ///
+    /// @brief Modification time of the file in milliseconds since epoch.
+    int64_t mtime;
+    /// @brief Sorted numerical ids of the events collected when the facts
+    /// were computed, as the facts depend on them.
+    std::vector<int> collected_events;
+    ///
+    /// @brief Whether kernel stacks were found in the trace.
+    bool kstacks_exist;
+    ///
+    /// @brief When the record was last used, in milliseconds since epoch.
+    int64_t last_used;
+};
+
+/**
+ * @brief Singleton holding warm-start records of trace files, keyed by
+ * their canonical paths. Records are stored as JSON in
+ * `$XDG_CACHE_HOME/stacklook/warm-start.json` and are valid only while
+ * the file keeps its size and modification time and the same events are
+ * collected from it. Only the most recently used records are kept.
+ */
+class SlWarmStart {
+private: // Data members
+    ///
+    /// @brief Records keyed by canonical paths of trace files.
+    std::map<std::string, SlTraceRecord> _traces;
+
+    ///
+    /// @brief Whether the records were read from the disk already.
+    bool _loaded{false};
+private: // Functions
+    SlWarmStart() = default;
+    static QString _path();
+    void _load();
+    void _save() const;
+public: // Functions
+    static SlWarmStart& get_instance();
+    std::optional<bool> known_kstacks(const char* trace_file,
+                                      std::vector<int> collected_events);
+    void remember_kstacks(const char* trace_file,
+                          std::vector<int> collected_events, bool kstacks_exist);
+};
+
+#endif
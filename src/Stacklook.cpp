@@ -10,11 +10,18 @@
 
 // C
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 // C++
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <optional>
 #include <unordered_set>
 
 // KernelShark
@@ -26,8 +33,26 @@
 
 // Plugin headers
 #include "stacklook.h"
+#include "SlAssociation.hpp"
 #include "SlButton.hpp"
 #include "SlConfig.hpp"
+#include "SlDetailedView.hpp"
+#include "SlDrawRecord.hpp"
+#include "SlEventRegistry.hpp"
+#include "SlFlameView.hpp"
+#include "SlFoldedExport.hpp"
+#include "SlKallsyms.hpp"
+#include "SlLatency.hpp"
+#include "SlLatencyView.hpp"
+#include "SlPprofExport.hpp"
+#include "SlRangeCounts.hpp"
+#include "SlSelfTrace.h"
+#include "SlStackFilter.hpp"
+#include "SlStackSearch.hpp"
+#include "SlStreamIndex.hpp"
+#include "SlThreadPool.hpp"
+#include "SlTopStacksView.hpp"
+#include "SlWarmStart.hpp"
 
 // #########################################################################
 // Static variables
@@ -36,6 +61,81 @@
  */
 static SlConfigWindow* cfg_window;
 
+/**
+ * @brief Static pointer to the window inspecting kernel stacks.
+ */
+static SlDetailedView* detailed_window;
+
+/**
+ * @brief Static pointer to the flame graph window.
+ */
+static SlFlameView* flame_window;
+
+/**
+ * @brief Static pointer to the most frequent stacks window.
+ */
+static SlTopStacksView* top_stacks_window;
+
+/**
+ * @brief Static pointer to the stack search window.
+ */
+static SlStackSearch* search_window;
+
+/**
+ * @brief Static pointer to the scheduling latency window.
+ */
+static SlLatencyView* latency_window;
+
+/**
+ * @brief Stream which was drawn last, windows showing data of a single
+ * stream show this one. -1 if nothing was drawn yet.
+ */
+static int last_drawn_stream = -1;
+
+/**
+ * @brief Kernel stack filter compiled from the configuration's
+ * specification, along with the configuration's generation it was
+ * last checked against.
+ */
+struct _CompiledStackFilter {
+    ///
+    /// @brief Generation of the configuration checked last.
+    uint64_t generation;
+    ///
+    /// @brief The compiled filter.
+    std::unique_ptr<SlStackFilter> filter;
+};
+
+/**
+ * @brief Kernel stack filters compiled from the configuration's
+ * specification, keyed by the stream they were compiled for.
+ */
+static std::map<int, _CompiledStackFilter> stack_filters;
+
+/**
+ * @brief Kernel symbol table loaded from the configured path, nullptr
+ * if no path is configured or loading it failed.
+ */
+static std::unique_ptr<SlKallsyms> kallsyms;
+
+/**
+ * @brief Path `kallsyms` was loaded from, so that it's loaded again only
+ * once the configured path changes.
+ */
+static std::string kallsyms_path;
+
+/**
+ * @brief Kernel symbol table paths stream indices were built with, keyed
+ * by the indices.
+ */
+static std::map<const SlStreamIndex*, std::string> index_kallsyms_paths;
+
+/**
+ * @brief Recorder of draw calls, created on the first draw if the
+ * environment variable `SL_DRAW_RECORD` names a recording file.
+ */
+static std::unique_ptr<SlDrawRecorder> draw_recorder;
+
 // #########################################################################
 // Static functions
 
@@ -46,32 +146,85 @@ static SlConfigWindow* cfg_window;
  * @param entry: KernelShark entry whose properties must be checked
  * @param kstack_entry: KernelShark entry containing the correct kernel stack
  * of the event in `entry`.
- * @param ctx: Stacklook plugin context
+ * @param registry: event registry of the stream, up to date with the
+ * configuration snapshot of the draw
+ * @param stack_filter: compiled kernel stack filter, nullptr if no filter
+ * is configured
+ * @param event_idx: index of the entry in the container of collected events
  * 
  * @returns True if the entry fulfills all of function's requirements,
  *          false otherwise.
- *
- * @note It is dependent on the configuration 'SlConfig' singleton.
 */
 static bool _check_function_general(const kshark_entry* entry,
                                     const kshark_entry* kstack_entry,
-                                    const plugin_stacklook_ctx* ctx) {
+                                    const SlEventRegistry* registry,
+                                    const SlStackFilter* stack_filter,
+                                    ssize_t event_idx) {
     if (!entry || !kstack_entry)
         return false;
     
-    bool correct_event_id = (ctx->sswitch_event_id == entry->event_id)
-                            || (ctx->swaking_event_id == entry->event_id);
-    
-    // Configuration access here.
-    bool is_config_allowed = SlConfig::get_instance().is_event_allowed(entry);
+    // Configuration access here, resolved by event id.
+    const SlEventDescriptor* descriptor = registry->find(entry->event_id);
+    bool is_config_allowed = (descriptor != nullptr) && descriptor->enabled;
 
     bool is_visible_event = entry->visible
                             & kshark_filter_masks::KS_EVENT_VIEW_FILTER_MASK;
     bool is_visible_graph = entry->visible
                             & kshark_filter_masks::KS_GRAPH_VIEW_FILTER_MASK;
     
-    return correct_event_id && is_config_allowed
-           && is_visible_event && is_visible_graph;
+    // Evaluated last, but costs only one memoized lookup anyway.
+    return is_config_allowed
+           && is_visible_event && is_visible_graph
+           && (!stack_filter || stack_filter->matches_event(event_idx));
+}
+
+/**
+ * @brief Gets the kernel stack filter compiled for a stream. The filter is
+ * compiled again only if the stream's index changed or a new configuration
+ * generation brought different criteria since the last compilation.
+ * 
+ * @param sd: data stream identifier
+ * @param cfg: configuration snapshot of the draw
+ * 
+ * @returns Pointer to the compiled filter, nullptr if no criteria are
+ * configured or the stream has no index.
+*/
+static const SlStackFilter* _get_stack_filter(int sd, const SlConfig& cfg) {
+    // Configuration access here.
+    const SlStackFilterSpec& spec = cfg.get_stack_filter();
+    if (spec.is_empty())
+        return nullptr;
+
+    const SlStreamIndex* index = get_stream_index(sd);
+    if (index == nullptr)
+        return nullptr;
+
+    _CompiledStackFilter& compiled = stack_filters[sd];
+    const bool config_changed = compiled.generation != cfg.get_generation();
+    if (!compiled.filter || compiled.filter->index() != index
+        || (config_changed && !(compiled.filter->spec() == spec)))
+        compiled.filter = std::make_unique<SlStackFilter>(index, spec);
+    compiled.generation = cfg.get_generation();
+
+    return compiled.filter.get();
+}
+
+/**
+ * @brief Gets the event registry of a stream, brought up to date with
+ * a configuration snapshot if its generation differs.
+ * 
+ * @param ctx: Stacklook plugin context of the stream
+ * @param cfg: configuration snapshot of the draw
+ * 
+ * @returns Pointer to the stream's event registry.
+*/
+static const SlEventRegistry* _get_event_registry(plugin_stacklook_ctx* ctx,
+                                                  const SlConfig& cfg) {
+    // Configuration access here.
+    if (ctx->event_registry->generation() != cfg.get_generation())
+        ctx->event_registry->update(cfg.get_events_meta(), cfg.get_generation());
+
+    return ctx->event_registry;
 }
 
 /**
@@ -115,18 +268,23 @@ static float _get_color_intensity(const KsPlot::Color& c) {
  * 
  * @returns Pointer to the created button.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It reads the current configuration snapshot, once per button.
+ * Declared in `SlButton.hpp`, so that benchmarks can make buttons.
 */
-static SlTriangleButton* _make_sl_button(std::vector<const KsPlot::Graph*> graph,
-                                         std::vector<int> bin,
-                                         std::vector<kshark_data_field_int64*> data,
-                                         KsPlot::Color col, float) {
+SlTriangleButton* make_sl_button(std::vector<const KsPlot::Graph*> graph,
+                                 std::vector<int> bin,
+                                 std::vector<kshark_data_field_int64*> data,
+                                 KsPlot::Color col, float) {
+    SL_TRACE_SCOPE("make_sl_button");
+
     // Constants
     constexpr int32_t BUTTON_TEXT_OFFSET = 14;
     const std::string STACK_BUTTON_TEXT = "STACK";
+    const static KsPlot::Color SEARCH_HIT_OUTLINE_COL {0xFF, 0, 0xFF};
+    constexpr float SEARCH_HIT_OUTLINE_SIZE = 3.f;
 
-    // Configuration access here.
-    const SlConfig& cfg = SlConfig::get_instance();
+    // Configuration access here, one snapshot for the whole button.
+    const std::shared_ptr<const SlConfig> cfg = SlConfig::get_snapshot();
 
     kshark_entry* event_entry = data[0]->entry;
     const kshark_entry* kstack_entry = (const kshark_entry*)(data[0]->field);
@@ -166,9 +324,15 @@ static SlTriangleButton* _make_sl_button(std::vector<const KsPlot::Graph*> graph
     // Inner triangle
     auto back_triangle = KsPlot::Triangle(inner_triangle);
     // Configuration access here.
-    back_triangle._color = cfg.get_button_outline_col();
+    back_triangle._color = cfg->get_button_outline_col();
     back_triangle.setFill(false);
 
+    // Buttons of stack search hits get a thick, bright outline
+    if (search_window && search_window->is_highlighted(event_entry)) {
+        back_triangle._color = SEARCH_HIT_OUTLINE_COL;
+        back_triangle._size = SEARCH_HIT_OUTLINE_SIZE;
+    }
+
     // Text coords
     int text_x = x - BUTTON_TEXT_OFFSET;
     int text_y = y - BUTTON_TEXT_OFFSET - 2;
@@ -194,21 +358,177 @@ static SlTriangleButton* _make_sl_button(std::vector<const KsPlot::Graph*> graph
  * @param dc: Input location for the container of the event's data
  * @param check_func: Check function used to select events from data container
  * @param make_button: Function which specifies what will be drawn and how
- *
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @param config: configuration snapshot of the draw
 */
 static void _draw_stacklook_buttons(KsCppArgV* argv, 
                                     kshark_data_container* dc,
                                     IsApplicableFunc check_func,
-                                    pluginShapeFunc make_button) {
+                                    pluginShapeFunc make_button,
+                                    const SlConfig& config) {
     // -1 means default size
     // The default color of buttons will hopefully be overriden when
     // the button's entry's task PID is found.
     
     // Configuration access here.
     eventFieldPlotMin(argv, dc, check_func, make_button,
-                      SlConfig::get_instance().get_default_btn_col(),
-                      -1);
+                      config.get_default_btn_col(), -1);
+}
+
+/**
+ * @brief Draws a thin strip under a graph with too many entries for
+ * buttons, showing where enabled events with kernel stacks are. Each bin
+ * with such events gets the color of their dominant kind (see
+ * `dominant_kind`), paler the fewer events it has compared to the densest
+ * bin. Bins are counted from the stream's range counts, so the cost doesn't
+ * grow with events.
+ * 
+ * @param argv: The C++ arguments of the drawing function of the plugin
+ * @param sd: data stream identifier
+ * @param val: process or CPU ID value
+ * @param draw_action: draw action identifier
+ * @param config: configuration snapshot of the draw
+ */
+static void _draw_density_strip(KsCppArgV* argv, int sd, int val,
+                                int draw_action, const SlConfig& config) {
+    SL_TRACE_SCOPE("draw_density_strip");
+
+    constexpr int32_t STRIP_HEIGHT = 3;
+    // Colors of kinds in the order of `SlCountKind`
+    static const std::array<KsPlot::Color, SL_COUNT_KINDS> KIND_COLORS{{
+        {0x3C, 0x6E, 0xD8},  // S - blue
+        {0xD8, 0x3C, 0x3C},  // D - red
+        {0x3C, 0xB4, 0x50},  // R - green
+        {0x96, 0x96, 0x96},  // I - grey
+        {0x96, 0x50, 0xC8},  // Other prev_states - purple
+        {0xE6, 0xB4, 0x1E},  // Wakings - amber
+        {0x50, 0x50, 0x50}   // Other events - dark grey
+    }};
+    // Reused between draws, drawing happens on the GUI thread only
+    static std::vector<SlKindCounts> bins;
+
+    plugin_stacklook_ctx* ctx = __get_context(sd);
+    if (ctx == nullptr)
+        return;
+
+    // Counts follow the registry's enabled events
+    _get_event_registry(ctx, config);
+    const SlRangeCounts* counts = get_range_counts(sd);
+    if (counts == nullptr)
+        return;
+
+    const kshark_trace_histo* histo = argv->_histo;
+    const size_t n_bins = (histo->n_bins > 0) ? size_t(histo->n_bins) : 0;
+    if (draw_action == KSHARK_CPU_DRAW) {
+        counts->count_cpu_bins(int16_t(val), histo->min, histo->bin_size,
+                               n_bins, bins);
+    } else {
+        counts->count_task_bins(val, histo->min, histo->bin_size, n_bins, bins);
+    }
+
+    uint32_t densest = 0;
+    for (const SlKindCounts& bin : bins) {
+        densest = std::max(densest, total_count(bin));
+    }
+    if (densest == 0)
+        return;
+
+    const float log_densest = std::log1p(float(densest));
+    for (size_t b = 0; b < n_bins; ++b) {
+        const uint32_t total = total_count(bins[b]);
+        if (total == 0)
+            continue;
+
+        // Logarithmic, so that sparse bins don't vanish next to dense ones
+        const float weight = 0.25f + 0.75f * std::log1p(float(total)) / log_densest;
+        const KsPlot::Color& full = KIND_COLORS[size_t(dominant_kind(bins[b]))];
+        const auto blend = [weight](uint8_t channel) {
+            return uint8_t(0xFF - weight * float(0xFF - channel));
+        };
+
+        const KsPlot::Point base = argv->_graph->bin(int(b))._base;
+        const int next_x = (b + 1 < n_bins) ?
+            argv->_graph->bin(int(b + 1))._base.x() : base.x() + 1;
+
+        auto strip = new KsPlot::Rectangle();
+        strip->setFill(true);
+        strip->setPoint(0, base.x(), base.y() + 1);
+        strip->setPoint(1, base.x(), base.y() + STRIP_HEIGHT);
+        strip->setPoint(2, next_x, base.y() + STRIP_HEIGHT);
+        strip->setPoint(3, next_x, base.y() + 1);
+        strip->_color = {blend(full.r()), blend(full.g()), blend(full.b())};
+        argv->_shapes->push_front(strip);
+    }
+}
+
+/**
+ * @brief Draws a few buttons on a graph with too many entries for all of
+ * them. The graph's bins are split into at most the configured number of
+ * strata, each gets a button of one representative event (see
+ * `SlRangeCounts::sample_cpu_bins`), so dense ranges stay explorable.
+ * Only events which would get a button when zoomed in are sampled, except
+ * that the stack filter applies only once the stream index exists.
+ * 
+ * @param argv: The C++ arguments of the drawing function of the plugin
+ * @param sd: data stream identifier
+ * @param val: process or CPU ID value
+ * @param draw_action: draw action identifier
+ * @param config: configuration snapshot of the draw
+ */
+static void _draw_sampled_buttons(KsCppArgV* argv, int sd, int val,
+                                  int draw_action, const SlConfig& config) {
+    SL_TRACE_SCOPE("draw_sampled_buttons");
+
+    // Reused between draws, drawing happens on the GUI thread only
+    static std::vector<uint32_t> samples;
+
+    plugin_stacklook_ctx* ctx = __get_context(sd);
+    if (ctx == nullptr)
+        return;
+
+    const SlEventRegistry* registry = _get_event_registry(ctx, config);
+    const SlRangeCounts* counts = get_range_counts(sd);
+    if (counts == nullptr)
+        return;
+
+    const kshark_trace_histo* histo = argv->_histo;
+    if (histo->n_bins <= 0 || histo->bin_size <= 0)
+        return;
+
+    // Compiled once, so that the predicate does only one lookup. Indexing
+    // all stacks of a zoomed-out trace would stall the draw, so the filter
+    // waits for something else to build the index.
+    const SlStackFilter* stack_filter = (ctx->stream_index != nullptr) ?
+        _get_stack_filter(sd, config) : nullptr;
+    const kshark_data_container* events = ctx->collected_events;
+
+    // CPU or PID is given by the sampled series already
+    const SlRangeCounts::accept_t accept = [=] (uint32_t event_idx) {
+        return _check_function_general(events->data[event_idx]->entry,
+            (const kshark_entry*)(events->data[event_idx]->field),
+            registry, stack_filter, event_idx);
+    };
+
+    const size_t n_bins = size_t(histo->n_bins);
+    if (draw_action == KSHARK_CPU_DRAW) {
+        counts->sample_cpu_bins(int16_t(val), histo->min, histo->bin_size,
+                                n_bins, config.get_sampled_buttons(),
+                                accept, samples);
+    } else {
+        counts->sample_task_bins(val, histo->min, histo->bin_size, n_bins,
+                                 config.get_sampled_buttons(), accept, samples);
+    }
+
+    for (uint32_t event_idx : samples) {
+        kshark_data_field_int64* field = events->data[event_idx];
+        const int64_t bin = (field->entry->ts - histo->min) / histo->bin_size;
+        const int clamped = int(std::clamp<int64_t>(bin, 0, histo->n_bins - 1));
+
+        // Configuration access here.
+        argv->_shapes->push_front(make_sl_button({argv->_graph}, {clamped},
+                                                 {field},
+                                                 config.get_default_btn_col(),
+                                                 -1));
+    }
 }
 
 /**
@@ -221,30 +541,255 @@ static void config_show([[maybe_unused]] KsMainWindow*) {
 }
 
 /**
- * @brief To be called only once per stream load. Stores kernel
- * stack entry pointers to the field of Stacklook-relevant
- * entries in the container in the argument.
+ * @brief Refreshes and shows the flame graph window.
+ */
+static void flame_show([[maybe_unused]] KsMainWindow*) {
+    flame_window->show();
+    flame_window->refresh();
+}
+
+/**
+ * @brief Shows the most frequent stacks of the last drawn stream.
+ */
+static void top_stacks_show([[maybe_unused]] KsMainWindow*) {
+    top_stacks_window->show_stream(last_drawn_stream);
+}
+
+/**
+ * @brief Marks the previous event with the same kernel stack as the event
+ * of the stack window's current tab, i.e. the last double-clicked button.
+ */
+static void prev_same_stack_show([[maybe_unused]] KsMainWindow*) {
+    detailed_window->step_same_stack(false);
+}
+
+/**
+ * @brief Marks the next event with the same kernel stack as the event
+ * of the stack window's current tab, i.e. the last double-clicked button.
+ */
+static void next_same_stack_show([[maybe_unused]] KsMainWindow*) {
+    detailed_window->step_same_stack(true);
+}
+
+/**
+ * @brief Shows the stack search window for the last drawn stream.
+ */
+static void search_show([[maybe_unused]] KsMainWindow*) {
+    search_window->show_stream(last_drawn_stream);
+}
+
+/**
+ * @brief Shows scheduling latencies of the last drawn stream.
+ */
+static void latency_show([[maybe_unused]] KsMainWindow*) {
+    latency_window->show_stream(last_drawn_stream);
+}
+
+/**
+ * @brief Gets the index of the last drawn stream for an export. If there
+ * is none, the user is told so.
  * 
- * @param dct Data container of Stacklook-relevant entries
- * @return True if any kernel stack entry was found, false
- * otherwise.
+ * @param main_w: KernelShark's main window, parent of the dialog
+ * 
+ * @returns Pointer to the index, nullptr if there are no stacks to export.
  */
-static bool search_for_kstacks(const kshark_data_container* dct) {
-    if (dct == nullptr || dct->size == 0)
-        return false;
-    
-    bool found_at_least_one = false;
-
-    for (ssize_t i = 0; i < dct->size; ++i) {
-        kshark_data_field_int64* sl_relevant = dct->data[i];
-        const kshark_entry* kstack_entry = get_kstack_entry(sl_relevant->entry);
-        if (kstack_entry != nullptr) {
-            sl_relevant->field = (int64_t)(kstack_entry);
-            found_at_least_one = true;
+static const SlStreamIndex* _index_to_export(KsMainWindow* main_w) {
+    const SlStreamIndex* index = (last_drawn_stream >= 0) ?
+        get_stream_index(last_drawn_stream) : nullptr;
+    if (index == nullptr) {
+        auto info_dialog = new QMessageBox(QMessageBox::Warning,
+            "Export failed", "There are no kernel stacks to export.",
+            QMessageBox::StandardButton::Ok, main_w);
+        info_dialog->show();
+    }
+    return index;
+}
+
+/**
+ * @brief Tells the user how an export went.
+ * 
+ * @param main_w: KernelShark's main window, parent of the dialog
+ * @param result: result of the export
+ */
+static void _show_export_result(KsMainWindow* main_w,
+                                const SlExportResult& result) {
+    auto info_dialog = new QMessageBox(
+        result.ok ? QMessageBox::Information : QMessageBox::Warning,
+        result.ok ? "Export success" : "Export failed",
+        result.ok ? QString("Exported %1 stacks.").arg(result.stacks) :
+                    QString::fromStdString(result.error),
+        QMessageBox::StandardButton::Ok, main_w);
+    info_dialog->show();
+}
+
+/**
+ * @brief Exports kernel stacks of the last drawn stream to a file in the
+ * folded stack format. The user picks the file and the weight of stacks.
+ * 
+ * @param main_w: KernelShark's main window, parent of the dialogs
+ */
+static void folded_export_show(KsMainWindow* main_w) {
+    const SlStreamIndex* index = _index_to_export(main_w);
+    if (index == nullptr)
+        return;
+
+    const QString path = QFileDialog::getSaveFileName(main_w,
+        "Export Folded Stacks", "stacks.folded");
+    if (path.isEmpty())
+        return;
+
+    // Order must match SlFoldedWeight
+    const QStringList weights {"Event count", "Off-CPU time (ns)"};
+    bool picked = false;
+    const QString weight = QInputDialog::getItem(main_w, "Export Folded Stacks",
+        "Weight of stacks:", weights, 0, false, &picked);
+    if (!picked)
+        return;
+
+    _show_export_result(main_w, export_folded_stacks(*index,
+        path.toStdString(), (SlFoldedWeight)weights.indexOf(weight)));
+}
+
+/**
+ * @brief Exports kernel stacks of the last drawn stream to a file as
+ * a gzip-compressed pprof profile. The user picks the file.
+ * 
+ * @param main_w: KernelShark's main window, parent of the dialogs
+ */
+static void pprof_export_show(KsMainWindow* main_w) {
+    const SlStreamIndex* index = _index_to_export(main_w);
+    if (index == nullptr)
+        return;
+
+    const QString path = QFileDialog::getSaveFileName(main_w,
+        "Export pprof Profile", "stacks.pb.gz");
+    if (path.isEmpty())
+        return;
+
+    _show_export_result(main_w,
+                        export_pprof_profile(*index, path.toStdString()));
+}
+
+/**
+ * @brief Gets the stream's group of tasks on the shared thread pool,
+ * creating it on the first call.
+ * 
+ * @param ctx: plugin context of the stream
+ * 
+ * @returns The stream's task group.
+ */
+static SlTaskGroup* _get_task_group(plugin_stacklook_ctx* ctx) {
+    if (ctx->task_group == nullptr)
+        ctx->task_group = new SlTaskGroup();
+
+    return ctx->task_group;
+}
+
+/**
+ * @brief Gets the kernel symbol table of the configured path, loading
+ * it if the path changed since the last call. A failed load isn't
+ * retried until the path changes again.
+ * 
+ * @param path: configured path of the table, empty for none
+ * 
+ * @returns Pointer to the table, nullptr if there is none.
+ */
+static const SlKallsyms* _get_kallsyms(const std::string& path) {
+    if (path != kallsyms_path) {
+        kallsyms_path = path;
+        kallsyms.reset();
+
+        std::string error;
+        auto loaded = std::make_unique<SlKallsyms>();
+        if (!path.empty() && loaded->load(path, error)) {
+            kallsyms = std::move(loaded);
+        } else if (!path.empty()) {
+            fprintf(stderr, "Stacklook: %s\n", error.c_str());
         }
     }
 
-    return found_at_least_one;
+    return kallsyms.get();
+}
+
+/**
+ * @brief Gets the trace file of a stream.
+ * 
+ * @param sd: data stream identifier
+ * 
+ * @returns Path of the stream's trace file, nullptr if there is none.
+ */
+static const char* _stream_file(int sd) {
+    kshark_context* kshark_ctx = nullptr;
+    kshark_data_stream* stream = kshark_instance(&kshark_ctx) ?
+        kshark_get_data_stream(kshark_ctx, sd) : nullptr;
+    return stream ? stream->file : nullptr;
+}
+
+/**
+ * @brief Searches for kernel stacks of collected events, along with their
+ * user stacks if the stream has them, if this hasn't been done for the
+ * stream yet. A trace file known from an earlier session to have no
+ * kernel stacks among the same collected events isn't searched again.
+ * 
+ * @param sd: data stream identifier
+ * @param ctx: Stacklook plugin context of the stream
+ * @return True if any kernel stack entry exists in the stream, false
+ * otherwise.
+ */
+static bool _ensure_kstacks(int sd, plugin_stacklook_ctx* ctx) {
+    if (!ctx->searched_for_kstacks) {
+        const char* trace_file = _stream_file(sd);
+        // Stacks are searched for among these events only
+        const std::vector<int>& collected_events = ctx->event_registry->event_ids();
+        SlWarmStart& warm_start = SlWarmStart::get_instance();
+        const std::optional<bool> known = warm_start.known_kstacks(trace_file,
+                                                                   collected_events);
+
+        // User stacks are found in the same pass as kernel stacks
+        if (ctx->ustack_event_id >= 0 && ctx->user_stacks == nullptr)
+            ctx->user_stacks = new SlUserStacks{ctx->ustack_event_id, {}};
+
+        // Update context variable to indicate whether any
+        // kernel stack entry exists.
+        ctx->kstacks_exist = (known == false) ? false :
+            associate_kstacks(ctx->collected_events, ctx->kstack_event_id,
+                              _get_task_group(ctx), ctx->user_stacks);
+        ctx->searched_for_kstacks = true;
+
+        if (known != ctx->kstacks_exist)
+            warm_start.remember_kstacks(trace_file, collected_events,
+                                        ctx->kstacks_exist);
+    }
+
+    return ctx->kstacks_exist;
+}
+
+/**
+ * @brief Records a draw call, if recording was requested via the
+ * environment variable `SL_DRAW_RECORD`. It is checked on the first
+ * call only.
+ * 
+ * @param argv: the C++ arguments of the draw call
+ * @param sd: data stream identifier
+ * @param val: process or CPU ID value
+ * @param draw_action: draw action identifier
+ */
+static void _record_draw(const KsCppArgV* argv, int sd, int val,
+                         int draw_action) {
+    static bool checked_env = false;
+    if (!checked_env) {
+        checked_env = true;
+        const char* path = getenv("SL_DRAW_RECORD");
+        if (path != nullptr && *path != '\0')
+            draw_recorder = std::make_unique<SlDrawRecorder>(path);
+    }
+
+    if (!draw_recorder || !draw_recorder->is_open())
+        return;
+
+    draw_recorder->record({sd, val, draw_action, argv->_histo->min,
+                           argv->_histo->max, argv->_histo->n_bins},
+                          _stream_file(sd));
 }
 
 // #########################################################################
@@ -254,16 +799,15 @@ static bool search_for_kstacks(const kshark_data_container* dct) {
 /**
  * @brief Finds the `ftrace/kernel_stack` event entry if it was
  * recorded in the trace and is directly after the event entry on
- * the same CPU and belongs to the same task.
+ * the same CPU and belongs to the same task. Looks up the kernel stack
+ * event's id in the plugin's context of the entry's stream.
  * 
  * @param kstack_owner Entry, whose kernel stack trace we want to find.
  * @return Pointer to the `ftrace/kernel_stack` event entry if it was
  * found, nullptr otherwise (or if there was an error in data access).
  */
 const struct kshark_entry* get_kstack_entry(const struct kshark_entry* kstack_owner) {
-    const kshark_entry* kstack_entry = kstack_owner;
-    
-    if (kstack_entry == nullptr)
+    if (kstack_owner == nullptr)
         return nullptr;
 
     plugin_stacklook_ctx* ctx = __get_context(kstack_owner->stream_id);
@@ -271,29 +815,28 @@ const struct kshark_entry* get_kstack_entry(const struct kshark_entry* kstack_ow
     if (ctx == nullptr)
         return nullptr;
 
-    int relevant_owner_pid = (kstack_owner->visible & KS_PLUGIN_UNTOUCHED_MASK) ?
-        kstack_owner->pid :
-        // "Emergency get" if some plugins messed around with the entry before
-        kshark_get_pid(kstack_owner);
-    bool is_kstack = (kstack_entry->event_id == ctx->kstack_event_id);
-    bool is_correct_task = (relevant_owner_pid == kstack_entry->pid);
-    
-    // This loop will usually stop either after one or two iterations.
-    // This will be the case unless some plugin aggressively reorders
-    // and changes innards of entries.
-    while (!(is_kstack && is_correct_task)) {
-        // Move onto next entry on the same CPU
-        // Kernelstack trace will be on the same CPU as the event
-        // directly after which it is made.
-        kstack_entry = kstack_entry->next;
-        if (kstack_entry == nullptr)
-            return nullptr;
-        // Update conditions
-        is_kstack = (kstack_entry->event_id == ctx->kstack_event_id);
-        is_correct_task = (relevant_owner_pid == kstack_entry->pid);
-    }
+    return find_kstack_entry(kstack_owner, ctx->kstack_event_id);
+}
 
-    return kstack_entry;
+/**
+ * @brief Finds the `ftrace/user_stack` event entry recorded along with
+ * a kernel stack, if the stream has user stacks. Looks up the user stack
+ * event's id in the plugin's context of the entry's stream.
+ * 
+ * @param kstack_entry Kernel stack entry of an event.
+ * @return Pointer to the `ftrace/user_stack` event entry if it was
+ * found, nullptr otherwise.
+ */
+const struct kshark_entry* get_ustack_entry(const struct kshark_entry* kstack_entry) {
+    if (kstack_entry == nullptr)
+        return nullptr;
+
+    plugin_stacklook_ctx* ctx = __get_context(kstack_entry->stream_id);
+
+    if (ctx == nullptr)
+        return nullptr;
+
+    return find_ustack_entry(kstack_entry, ctx->ustack_event_id);
 }
 
 /**
@@ -304,17 +847,27 @@ const struct kshark_entry* get_kstack_entry(const struct kshark_entry* kstack_ow
  * @param val: process or CPU ID value
  * @param draw_action: draw action identifier
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It reads one configuration snapshot for the whole draw.
 */
 void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
                             int val, int draw_action) {
+    SL_TRACE_SCOPE("draw_stacklook_objects");
     KsCppArgV* argVCpp KS_ARGV_TO_CPP(argv_c);
     plugin_stacklook_ctx* ctx = __get_context(sd);
     kshark_data_container* plugin_data;
 
-    // Configuration access here.
-    const SlConfig& config = SlConfig::get_instance();
-    const int32_t HISTO_ENTRIES_LIMIT = config.get_histo_limit();
+    // Stream wasn't initialized by the plugin, e.g. it has no kernel stacks
+    if (ctx == nullptr)
+        return;
+
+    // Loading is over by the first draw after it
+    trace_loading(ctx);
+
+    // Configuration access here, one snapshot for the whole draw.
+    const std::shared_ptr<const SlConfig> config = SlConfig::get_snapshot();
+    const int32_t HISTO_ENTRIES_LIMIT = config->get_histo_limit();
+
+    _record_draw(argVCpp, sd, val, draw_action);
     
     // Don't draw if not drawing tasks or CPUs.
     if (!(draw_action == KSHARK_CPU_DRAW 
@@ -322,8 +875,21 @@ void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
         return;
     }
     
-    // Don't draw with too many bins (configurable zoom-in indicator).
+    last_drawn_stream = sd;
+
+    // Let the flame graph follow the visible range, even if zoomed out.
+    if (flame_window) {
+        flame_window->follow_range(sd, argVCpp->_histo->min,
+                                   argVCpp->_histo->max);
+    }
+
+    // Don't draw all buttons with too many bins (configurable zoom-in
+    // indicator), at most a strip telling where to zoom and a sample.
     if (argVCpp->_histo->tot_count > HISTO_ENTRIES_LIMIT) {
+        if (config->get_density_strip())
+            _draw_density_strip(argVCpp, sd, val, draw_action, *config);
+        if (config->get_sampled_buttons() > 0)
+            _draw_sampled_buttons(argVCpp, sd, val, draw_action, *config);
         return;
     }
 
@@ -334,19 +900,31 @@ void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
     }
 
     // Search for kernelstack events once per stream on load.
-    if (!ctx->searched_for_kstacks) {
-        // Update context variable to indicate whether any
-        // kernel stack entry exists.
-        ctx->kstacks_exist = search_for_kstacks(plugin_data);
-        ctx->searched_for_kstacks = true;
-    }
-
-    if (!ctx->kstacks_exist) {
+    if (!_ensure_kstacks(sd, ctx)) {
         // No reason to draw anything, if no kernelstacks are present in
         // the trace.
         return;
     }
 
+    const SlEventRegistry* registry = _get_event_registry(ctx, *config);
+
+    // Once counts exist, graphs with no stacks in range aren't scanned.
+    // Buttons don't build them, only the density strip and sampling do.
+    // Counts of an older configuration may miss newly enabled events.
+    if (ctx->range_counts != nullptr
+        && ctx->range_counts->generation() == registry->generation()) {
+        const SlKindCounts in_range = (draw_action == KSHARK_CPU_DRAW) ?
+            ctx->range_counts->count_cpu(int16_t(val), argVCpp->_histo->min,
+                                         argVCpp->_histo->max) :
+            ctx->range_counts->count_task(val, argVCpp->_histo->min,
+                                          argVCpp->_histo->max);
+        if (total_count(in_range) == 0)
+            return;
+    }
+
+    // Compiled once, so that the draw predicate does only one lookup.
+    const SlStackFilter* stack_filter = _get_stack_filter(sd, *config);
+
     IsApplicableFunc check_func;
     
     if (draw_action == KSHARK_TASK_DRAW) {
@@ -356,7 +934,8 @@ void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
             if (!entry)
                 return false;
             bool correct_pid = (entry->pid == val);
-            return _check_function_general(entry, kstack_ptr, ctx) && correct_pid;
+            return correct_pid && _check_function_general(entry, kstack_ptr, registry,
+                                                          stack_filter, t);
         };
         
     } else if (draw_action == KSHARK_CPU_DRAW) {
@@ -366,13 +945,249 @@ void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
             if (!entry)
                 return false;
             bool correct_cpu = (entry->cpu == val);
-            return _check_function_general(entry, kstack_ptr, ctx) && correct_cpu;
+            return correct_cpu && _check_function_general(entry, kstack_ptr, registry,
+                                                          stack_filter, t);
         };
     }
 
-    _draw_stacklook_buttons(argVCpp, plugin_data, check_func, _make_sl_button);
+    _draw_stacklook_buttons(argVCpp, plugin_data, check_func, make_sl_button,
+                            *config);
+}
+
+/**
+ * @brief Gets the index of interned kernel stacks of a stream's collected
+ * events. The index is built on the first call for the stream, which
+ * also searches for kernel stacks if drawing hasn't done so yet. Raw
+ * addresses in stacks are resolved with the configured kernel symbol
+ * table, the index is built again once the configured table changes.
+ * 
+ * @param sd: data stream identifier
+ * 
+ * @returns Pointer to the stream's index, nullptr if the plugin isn't
+ * loaded for the stream or there are no kernel stacks in it.
+ * 
+ * @note It holds the current configuration snapshot while the index is
+ * built, so that the kallsyms path stays valid.
+ */
+SlStreamIndex* get_stream_index(int sd) {
+    plugin_stacklook_ctx* ctx = __get_context(sd);
+    if (ctx == nullptr || ctx->collected_events == nullptr)
+        return nullptr;
+
+    if (!_ensure_kstacks(sd, ctx))
+        return nullptr;
+
+    // Configuration access here, the path is held by the snapshot.
+    const std::shared_ptr<const SlConfig> config = SlConfig::get_snapshot();
+    const std::string& path = config->get_kallsyms_path();
+    if (ctx->stream_index != nullptr
+        && index_kallsyms_paths[ctx->stream_index] != path) {
+        free_stream_index(ctx->stream_index);
+        ctx->stream_index = nullptr;
+    }
+
+    if (ctx->stream_index == nullptr) {
+        ctx->stream_index = new SlStreamIndex(ctx->collected_events,
+                                              ctx->sswitch_event_id,
+                                              ctx->user_stacks);
+        ctx->stream_index->build(_get_kallsyms(path), _get_task_group(ctx));
+        index_kallsyms_paths[ctx->stream_index] = path;
+    }
+
+    return ctx->stream_index;
+}
+
+/**
+ * @brief Frees a stream's index of kernel stacks. Windows which
+ * aggregate data from the index are notified first.
+ * 
+ * @param index: index to free, may be nullptr
+ */
+void free_stream_index(SlStreamIndex* index) {
+    if (index == nullptr)
+        return;
+
+    if (flame_window)
+        flame_window->index_freed(index);
+    if (top_stacks_window)
+        top_stacks_window->index_freed(index);
+    if (search_window)
+        search_window->index_freed(index);
+
+    for (auto it = stack_filters.begin(); it != stack_filters.end();) {
+        it = (it->second.filter && it->second.filter->index() == index) ?
+            stack_filters.erase(it) : std::next(it);
+    }
+    index_kallsyms_paths.erase(index);
+
+    delete index;
+}
+
+/**
+ * @brief Gets scheduling latencies of a stream's collected events. They
+ * are measured on the first call for the stream.
+ * 
+ * @param sd: data stream identifier
+ * 
+ * @returns Pointer to the stream's latencies, nullptr if the plugin isn't
+ * loaded for the stream.
+ */
+SlLatencyStats* get_latency_stats(int sd) {
+    plugin_stacklook_ctx* ctx = __get_context(sd);
+    if (ctx == nullptr || ctx->collected_events == nullptr)
+        return nullptr;
+
+    if (ctx->latency_stats == nullptr) {
+        // Sorting now keeps indices of an index built later stable
+        if (!ctx->collected_events->sorted)
+            kshark_data_container_sort(ctx->collected_events);
+
+        ctx->latency_stats = new SlLatencyStats();
+        ctx->latency_stats->build(ctx->collected_events,
+                                  ctx->swaking_event_id,
+                                  ctx->sswitch_event_id);
+    }
+
+    return ctx->latency_stats;
+}
+
+/**
+ * @brief Frees a stream's scheduling latencies. The latency window is
+ * notified first.
+ * 
+ * @param stats: latencies to free, may be nullptr
+ */
+void free_latency_stats(SlLatencyStats* stats) {
+    if (stats == nullptr)
+        return;
+
+    if (latency_window)
+        latency_window->stats_freed(stats);
+
+    delete stats;
+}
+
+/**
+ * @brief Gets per-CPU and per-task counts of a stream's enabled collected
+ * events with kernel stacks in time ranges. They are built on the first
+ * call for the stream straight from the association of kernel stacks,
+ * which is done first if drawing hasn't done it yet, and rebuilt once the
+ * stream's event registry was updated to a newer configuration. Stacks
+ * aren't indexed.
+ * 
+ * @param sd: data stream identifier
+ * 
+ * @returns Pointer to the stream's counts, nullptr if the plugin isn't
+ * loaded for the stream or there are no kernel stacks in it.
+ */
+SlRangeCounts* get_range_counts(int sd) {
+    plugin_stacklook_ctx* ctx = __get_context(sd);
+    if (ctx == nullptr || ctx->collected_events == nullptr)
+        return nullptr;
+
+    const SlEventRegistry* registry = ctx->event_registry;
+    if (ctx->range_counts == nullptr
+        || ctx->range_counts->generation() != registry->generation()) {
+        if (!_ensure_kstacks(sd, ctx))
+            return nullptr;
+
+        if (ctx->range_counts == nullptr)
+            ctx->range_counts = new SlRangeCounts();
+        ctx->range_counts->build(ctx->collected_events, *registry,
+                                 ctx->sswitch_event_id, ctx->swaking_event_id);
+    }
+
+    return ctx->range_counts;
+}
+
+/**
+ * @brief Frees a stream's counts of events in time ranges.
+ * 
+ * @param counts: counts to free, may be nullptr
+ */
+void free_range_counts(SlRangeCounts* counts) {
+    delete counts;
+}
+
+/**
+ * @brief Frees a stream's task group. Its tasks which haven't started
+ * are cancelled, running ones are waited for.
+ * 
+ * @param group: task group to free, may be nullptr
+ */
+void free_task_group(SlTaskGroup* group) {
+    if (group == nullptr)
+        return;
+
+    group->cancel();
+    group->wait();
+    delete group;
 }
 
+/**
+ * @brief Makes the registry of events a stream collects, from the current
+ * configuration snapshot.
+ * 
+ * @param stream: KernelShark's data stream
+ * 
+ * @returns New registry, freed by `free_event_registry`.
+ * 
+ * @note It reads the current configuration snapshot.
+ */
+SlEventRegistry* make_event_registry(kshark_data_stream* stream) {
+    // Configuration access here.
+    const std::shared_ptr<const SlConfig> cfg = SlConfig::get_snapshot();
+    return new SlEventRegistry(stream, cfg->get_events_meta(),
+                               cfg->get_generation());
+}
+
+/**
+ * @brief Frees a stream's event registry.
+ * 
+ * @param registry: registry to free, may be nullptr
+ */
+void free_event_registry(SlEventRegistry* registry)
+{ delete registry; }
+
+/**
+ * @brief Frees a stream's user stacks.
+ * 
+ * @param user_stacks: user stacks to free, may be nullptr
+ * 
+ * @note The stream's index refers to them, it must be freed first.
+ */
+void free_user_stacks(SlUserStacks* user_stacks)
+{ delete user_stacks; }
+
+/**
+ * @brief Gets the number of events a stream collects.
+ * 
+ * @param registry: event registry of the stream, may be nullptr
+ * 
+ * @returns Number of collected events.
+ */
+size_t event_registry_size(const SlEventRegistry* registry)
+{ return (registry == nullptr) ? 0 : registry->event_ids().size(); }
+
+/**
+ * @brief Gets the numerical id of a collected event.
+ * 
+ * @param registry: event registry of the stream
+ * @param i: position of the event in the registry
+ * 
+ * @returns Numerical id of the event.
+ */
+int event_registry_event_id(const SlEventRegistry* registry, size_t i)
+{ return registry->event_ids()[i]; }
+
+/**
+ * @brief Gets the window inspecting kernel stacks.
+ * 
+ * @returns Pointer to the window, nullptr if the GUI isn't there.
+ */
+SlDetailedView* get_detailed_view()
+{ return detailed_window; }
+
 /**
  * @brief Give the plugin a pointer to KernalShark's main window to allow
  * GUI manipulation and menu creation.
@@ -384,19 +1199,71 @@ void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
  * 
  * @returns Pointer to the configuration menu instance.
  * 
- * @note It is dependent on the configuration 'SlConfig' singleton.
+ * @note It sets the main window pointer kept by 'SlConfig' and publishes
+ * the persisted configuration.
 */
 __hidden void* plugin_set_gui_ptr(void* gui_ptr) {
     KsMainWindow* main_w = static_cast<KsMainWindow*>(gui_ptr);
     // Configuration access here.
     SlConfig::main_w_ptr = main_w;
 
+    // Persisted configuration first, so that windows start with it
+    std::string cfg_error;
+    if (!SlConfig::load_persisted(cfg_error)) {
+        fprintf(stderr, "Stacklook: configuration not loaded: %s\n",
+                cfg_error.c_str());
+    }
+
     if (cfg_window == nullptr) {
         cfg_window = new SlConfigWindow();
     }
 
+    if (detailed_window == nullptr) {
+        detailed_window = new SlDetailedView();
+    }
+
+    if (flame_window == nullptr) {
+        flame_window = new SlFlameView();
+    }
+
+    if (top_stacks_window == nullptr) {
+        top_stacks_window = new SlTopStacksView();
+    }
+
+    if (search_window == nullptr) {
+        search_window = new SlStackSearch();
+    }
+
+    if (latency_window == nullptr) {
+        latency_window = new SlLatencyView();
+    }
+
     QString menu("Tools/Stacklook Configuration");
     main_w->addPluginMenu(menu, config_show);
 
+    QString flame_menu("Tools/Stacklook Flame Graph");
+    main_w->addPluginMenu(flame_menu, flame_show);
+
+    QString top_stacks_menu("Tools/Stacklook Most Frequent Stacks");
+    main_w->addPluginMenu(top_stacks_menu, top_stacks_show);
+
+    QString search_menu("Tools/Stacklook Stack Search");
+    main_w->addPluginMenu(search_menu, search_show);
+
+    QString prev_same_menu("Tools/Stacklook Previous Same Stack");
+    main_w->addPluginMenu(prev_same_menu, prev_same_stack_show);
+
+    QString next_same_menu("Tools/Stacklook Next Same Stack");
+    main_w->addPluginMenu(next_same_menu, next_same_stack_show);
+
+    QString latency_menu("Tools/Stacklook Wakeup Latency");
+    main_w->addPluginMenu(latency_menu, latency_show);
+
+    QString folded_menu("Tools/Stacklook Export Folded Stacks");
+    main_w->addPluginMenu(folded_menu, folded_export_show);
+
+    QString pprof_menu("Tools/Stacklook Export pprof Profile");
+    main_w->addPluginMenu(pprof_menu, pprof_export_show);
+
     return cfg_window;
 }
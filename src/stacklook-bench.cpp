@@ -0,0 +1,522 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    stacklook-bench.cpp
+ * @brief   Benchmarks of the plugin's hot paths, built on Google Benchmark
+ *          when CMake is given `-D_SL_BENCHMARKS=1`.
+ *
+ *          Micro benchmarks run on synthetic entries and need no trace:
+ *          kernel stack walks, association of collected events with
+ *          their stacks at 1M and 10M entries, prev_state parsing,
+ *          button creation and its hit test. Association at 100M entries
+ *          needs about 4 GB of memory, so it runs only with `--large`.
+ *          If a trace file is given after the benchmark flags, macro
+ *          benchmarks run on its entries as well, including those which
+ *          need a real stream, such as per-event configuration checks.
+ *
+ *          Usage: `stacklook-bench [--benchmark_...] [--large] [trace.dat]`.
+ *          For machine-readable results, use `--benchmark_format=json`
+ *          or `--benchmark_out=FILE --benchmark_out_format=json`.
+*/
+
+// C
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// C++
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// KernelShark
+#include "libkshark.h"
+#include "libkshark-model.h"
+#include "libkshark-plugin.h"
+#include "KsPlotTools.hpp"
+
+// Plugin headers
+#include "SlAssociation.hpp"
+#include "SlButton.hpp"
+#include "SlConfig.hpp"
+#include "SlEventRegistry.hpp"
+#include "SlPrevState.hpp"
+
+// Static variables
+
+///
+/// @brief Event IDs of synthetic entries.
+enum _synthetic_event : int16_t {
+    SYNTH_SWITCH = 1,
+    SYNTH_WAKING = 2,
+    SYNTH_KSTACK = 3,
+    SYNTH_OTHER = 4
+};
+
+///
+/// @brief CPUs synthetic entries are spread over.
+static constexpr int16_t SYNTH_CPUS = 8;
+
+///
+/// @brief Seed of synthetic traces, so that runs are comparable.
+static constexpr uint64_t SYNTH_SEED = 0x5eb4e3c;
+
+///
+/// @brief Owners of kernel stacks in walk benchmarks.
+static constexpr size_t WALK_OWNERS = 4096;
+
+// Static functions
+
+/**
+ * @brief Synthetic trace - entries linked per CPU the way KernelShark
+ * links loaded entries, with collected switch and waking events.
+ */
+struct _SyntheticTrace {
+    ///
+    /// @brief All entries, in timestamp order.
+    std::vector<kshark_entry> entries;
+    ///
+    /// @brief Switch and waking events, as the plugin collects them.
+    kshark_data_container* collected = nullptr;
+
+    _SyntheticTrace() = default;
+    _SyntheticTrace(const _SyntheticTrace&) = delete;
+    _SyntheticTrace& operator=(const _SyntheticTrace&) = delete;
+
+    ~_SyntheticTrace() {
+        if (collected != nullptr)
+            kshark_free_data_container(collected);
+    }
+};
+
+/**
+ * @brief Makes a synthetic entry untouched by other plugins.
+ *
+ * @param event_id: event ID of the entry
+ * @param cpu: CPU of the entry
+ * @param pid: PID of the entry's task
+ * @param ts: timestamp of the entry
+ *
+ * @returns The entry, not linked to any other yet.
+ */
+static kshark_entry _make_entry(int16_t event_id, int16_t cpu,
+                                int32_t pid, int64_t ts) {
+    kshark_entry entry{};
+    entry.visible = 0xFF;
+    entry.event_id = event_id;
+    entry.cpu = cpu;
+    entry.pid = pid;
+    entry.ts = ts;
+    return entry;
+}
+
+/**
+ * @brief Links entries to the next entry on the same CPU.
+ *
+ * @param entries: entries in timestamp order
+ */
+static void _link_per_cpu(std::vector<kshark_entry>& entries) {
+    std::vector<kshark_entry*> last(SYNTH_CPUS, nullptr);
+    for (kshark_entry& entry : entries) {
+        if (last[entry.cpu] != nullptr)
+            last[entry.cpu]->next = &entry;
+        last[entry.cpu] = &entry;
+    }
+}
+
+/**
+ * @brief Generates a synthetic trace of roughly the requested number of
+ * entries. Half of switch and waking events is followed by their kernel
+ * stack right away, others have an unrelated event of another task in
+ * between and a few have no stack, like events at the end of a buffer.
+ * A quarter of entries are unrelated events.
+ *
+ * @param count: number of entries to generate
+ * @param trace: trace to fill, its container is sorted already
+ */
+static void _generate_trace(size_t count, _SyntheticTrace& trace) {
+    std::mt19937_64 rng{SYNTH_SEED};
+    trace.entries.clear();
+    trace.entries.reserve(count + 2);
+
+    int64_t ts = 0;
+    while (trace.entries.size() < count) {
+        const uint64_t roll = rng();
+        const auto cpu = int16_t(roll % SYNTH_CPUS);
+        const auto pid = int32_t(1 + (roll >> 8) % 512);
+        const unsigned kind = (roll >> 20) % 64;
+
+        if (kind >= 48) {
+            trace.entries.push_back(_make_entry(SYNTH_OTHER, cpu, pid, ++ts));
+            continue;
+        }
+
+        const int16_t event_id = (kind % 2 == 0) ? SYNTH_SWITCH : SYNTH_WAKING;
+        trace.entries.push_back(_make_entry(event_id, cpu, pid, ++ts));
+        if (kind == 0)
+            continue; // Missing stack
+        if (kind < 24)
+            trace.entries.push_back(_make_entry(SYNTH_OTHER, cpu, pid + 1, ++ts));
+        trace.entries.push_back(_make_entry(SYNTH_KSTACK, cpu, pid, ++ts));
+    }
+
+    _link_per_cpu(trace.entries);
+
+    trace.collected = kshark_init_data_container();
+    for (kshark_entry& entry : trace.entries) {
+        if (entry.event_id == SYNTH_SWITCH || entry.event_id == SYNTH_WAKING)
+            kshark_data_container_append(trace.collected, &entry, (int64_t)-1);
+    }
+    kshark_data_container_sort(trace.collected);
+}
+
+/**
+ * @brief Generates owners of kernel stacks with a set number of events
+ * of another task between each owner and its stack, or with no stack
+ * at all, in which case the walk goes through all of the rest.
+ *
+ * @param distance: events between an owner and its stack
+ * @param with_stack: whether owners get their stack
+ * @param entries: entries to fill
+ *
+ * @returns Pointers to the owners.
+ */
+static std::vector<const kshark_entry*> _generate_walks(size_t distance,
+                                                        bool with_stack,
+                                                        std::vector<kshark_entry>& entries) {
+    entries.clear();
+    entries.reserve(WALK_OWNERS * (distance + 2));
+
+    int64_t ts = 0;
+    std::vector<size_t> owner_positions;
+    for (size_t i = 0; i < WALK_OWNERS; ++i) {
+        const auto pid = int32_t(1 + i % 512);
+        owner_positions.push_back(entries.size());
+        entries.push_back(_make_entry(SYNTH_SWITCH, 0, pid, ++ts));
+        for (size_t d = 0; d < distance; ++d) {
+            entries.push_back(_make_entry(SYNTH_OTHER, 0, pid + 1, ++ts));
+        }
+        if (with_stack)
+            entries.push_back(_make_entry(SYNTH_KSTACK, 0, pid, ++ts));
+    }
+    _link_per_cpu(entries);
+
+    std::vector<const kshark_entry*> owners;
+    for (size_t position : owner_positions) {
+        owners.push_back(&entries[position]);
+    }
+    return owners;
+}
+
+// Synthetic benchmarks
+
+/**
+ * @brief Walks from owners to their kernel stacks over a set number of
+ * unrelated events.
+ */
+static void BM_find_kstack_entry(benchmark::State& state) {
+    std::vector<kshark_entry> entries;
+    const auto owners = _generate_walks(size_t(state.range(0)), true, entries);
+
+    for (auto _ : state) {
+        for (const kshark_entry* owner : owners) {
+            benchmark::DoNotOptimize(find_kstack_entry(owner, SYNTH_KSTACK));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * owners.size()));
+}
+BENCHMARK(BM_find_kstack_entry)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+/**
+ * @brief Walks from owners whose kernel stack is missing. Every walk goes
+ * up to the end of the CPU's entries, so only the first owners are used.
+ */
+static void BM_find_kstack_entry_missing(benchmark::State& state) {
+    std::vector<kshark_entry> entries;
+    const auto owners = _generate_walks(size_t(state.range(0)), false, entries);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find_kstack_entry(owners.front(), SYNTH_KSTACK));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * entries.size()));
+}
+BENCHMARK(BM_find_kstack_entry_missing)->Arg(0)->Arg(4);
+
+/**
+ * @brief Associates all collected events of a synthetic trace with
+ * their kernel stacks. The 100M entries argument is registered in `main`,
+ * only if asked for.
+ */
+static void BM_associate_kstacks(benchmark::State& state) {
+    _SyntheticTrace trace;
+    _generate_trace(size_t(state.range(0)), trace);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(associate_kstacks(trace.collected, SYNTH_KSTACK));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * trace.collected->size));
+    state.counters["entries"] = double(trace.entries.size());
+}
+BENCHMARK(BM_associate_kstacks)
+    ->Arg(1'000'000)->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Parses prev_states out of info texts of switch events.
+ */
+static void BM_parse_switch_prev_state(benchmark::State& state) {
+    const std::vector<std::string> infos{
+        "bash:4012 [120] S ==> swapper/3:0 [120]",
+        "kworker/u16:2-events_unbound:30911 [120] I ==> trace-cmd:30907 [120]",
+        "jbd2/nvme0n1p2-8:412 [120] D ==> swapper/0:0 [120]",
+        "firefox:2211 [120] R+ ==> Web Content:2380 [120]"
+    };
+
+    for (auto _ : state) {
+        for (const std::string& info : infos) {
+            benchmark::DoNotOptimize(parse_switch_prev_state(info));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * infos.size()));
+}
+BENCHMARK(BM_parse_switch_prev_state);
+
+/**
+ * @brief Graph with bins at set positions, for making buttons without
+ * KernelShark's GL widget.
+ */
+struct _SyntheticGraph {
+    ///
+    /// @brief Model of the graph, without any data.
+    kshark_trace_histo histo;
+    ///
+    /// @brief Colors of the graph's tasks, empty.
+    KsPlot::ColorTable colors;
+    ///
+    /// @brief The graph.
+    KsPlot::Graph* graph;
+
+    explicit _SyntheticGraph(int bins) {
+        ksmodel_init(&histo);
+        ksmodel_set_bining(&histo, bins, 0, bins * 1000);
+        graph = new KsPlot::Graph(&histo, &colors, &colors);
+        for (int i = 0; i < bins; ++i) {
+            graph->bin(i)._val = KsPlot::Point{i, 100};
+        }
+    }
+
+    _SyntheticGraph(const _SyntheticGraph&) = delete;
+    _SyntheticGraph& operator=(const _SyntheticGraph&) = delete;
+
+    ~_SyntheticGraph() {
+        delete graph;
+        ksmodel_clear(&histo);
+    }
+};
+
+/**
+ * @brief Makes Stacklook buttons the way drawing of a graph does.
+ */
+static void BM_make_sl_button(benchmark::State& state) {
+    constexpr int BINS = 1024;
+    _SyntheticGraph graph{BINS};
+    kshark_entry entry = _make_entry(SYNTH_SWITCH, 0, 1, 1);
+    kshark_data_field_int64 field{&entry, -1};
+    // Configuration access here
+    const KsPlot::Color col = SlConfig::get_snapshot()->get_default_btn_col();
+
+    int bin = 0;
+    for (auto _ : state) {
+        SlTriangleButton* button = make_sl_button({graph.graph}, {bin}, {&field},
+                                                  col, -1);
+        benchmark::DoNotOptimize(button);
+        delete button;
+        bin = (bin + 1) % BINS;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_make_sl_button);
+
+/**
+ * @brief Hit tests of a button, as done for every button on each mouse
+ * move over the plot.
+ */
+static void BM_button_distance(benchmark::State& state) {
+    _SyntheticGraph graph{1};
+    kshark_entry entry = _make_entry(SYNTH_SWITCH, 0, 1, 1);
+    kshark_data_field_int64 field{&entry, -1};
+    SlTriangleButton* button = make_sl_button({graph.graph}, {0}, {&field},
+                                              {0xFF, 0xFF, 0xFF}, -1);
+
+    std::mt19937 rng{SYNTH_SEED};
+    std::uniform_int_distribution<int> coord{-64, 164};
+    std::vector<std::pair<int, int>> points(4096);
+    for (auto& [x, y] : points) {
+        x = coord(rng);
+        y = coord(rng);
+    }
+
+    for (auto _ : state) {
+        for (auto [x, y] : points) {
+            benchmark::DoNotOptimize(button->distance(x, y));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * points.size()));
+    delete button;
+}
+BENCHMARK(BM_button_distance);
+
+// Trace benchmarks
+
+/**
+ * @brief Loaded entries of a trace file, given on the command line.
+ */
+struct _LoadedTrace {
+    ///
+    /// @brief KernelShark's context.
+    kshark_context* kshark_ctx = nullptr;
+    ///
+    /// @brief Stream of the trace.
+    int sd = -1;
+    ///
+    /// @brief Loaded entries.
+    kshark_entry** rows = nullptr;
+    ///
+    /// @brief Number of loaded entries.
+    ssize_t count = 0;
+    ///
+    /// @brief Event IDs of the stream.
+    SlEventIds ids{-1, -1, -1, -1, {}};
+
+    /**
+     * @brief Opens a trace file and loads its entries.
+     *
+     * @param path: path of the trace file
+     *
+     * @returns True if entries were loaded, false otherwise.
+     */
+    bool load(const char* path) {
+        if (!kshark_instance(&kshark_ctx))
+            return false;
+        sd = kshark_open(kshark_ctx, path);
+        if (sd < 0)
+            return false;
+        count = kshark_load_entries(kshark_ctx, sd, &rows);
+
+        // Configuration access here, collected as the plugin would
+        std::vector<std::string> collected_events;
+        for (const SlEventDescriptor& event :
+             SlConfig::get_snapshot()->get_events_meta()) {
+            collected_events.push_back(event.name);
+        }
+        ids = find_event_ids(kshark_get_data_stream(kshark_ctx, sd),
+                             collected_events);
+        return count > 0;
+    }
+
+    ~_LoadedTrace() {
+        for (ssize_t i = 0; i < count; ++i) {
+            free(rows[i]);
+        }
+        free(rows);
+        if (sd >= 0)
+            kshark_close(kshark_ctx, sd);
+        if (kshark_ctx != nullptr)
+            kshark_free(kshark_ctx);
+    }
+};
+
+/**
+ * @brief Registers benchmarks which run on a loaded trace.
+ *
+ * @param trace: loaded trace, which must outlive the benchmarks
+ */
+static void _register_trace_benchmarks(const _LoadedTrace& trace) {
+    benchmark::RegisterBenchmark("BM_trace_collect_and_associate",
+                                 [&trace](benchmark::State& state) {
+        for (auto _ : state) {
+            kshark_data_container* dct = collect_events(trace.rows, size_t(trace.count),
+                                                        trace.ids);
+            benchmark::DoNotOptimize(associate_kstacks(dct, trace.ids.kstack));
+            kshark_free_data_container(dct);
+        }
+        state.SetItemsProcessed(int64_t(state.iterations() * trace.count));
+    })->Unit(benchmark::kMillisecond);
+
+    benchmark::RegisterBenchmark("BM_trace_get_switch_prev_state",
+                                 [&trace](benchmark::State& state) {
+        std::vector<const kshark_entry*> switches;
+        for (ssize_t i = 0; i < trace.count; ++i) {
+            if (trace.rows[i]->event_id == trace.ids.sswitch)
+                switches.push_back(trace.rows[i]);
+        }
+
+        for (auto _ : state) {
+            for (const kshark_entry* entry : switches) {
+                benchmark::DoNotOptimize(get_switch_prev_state(entry));
+            }
+        }
+        state.SetItemsProcessed(int64_t(state.iterations() * switches.size()));
+    })->Unit(benchmark::kMillisecond);
+
+    benchmark::RegisterBenchmark("BM_trace_event_registry_find",
+                                 [&trace](benchmark::State& state) {
+        // Configuration access here
+        const std::shared_ptr<const SlConfig> cfg = SlConfig::get_snapshot();
+        const SlEventRegistry registry{
+            kshark_get_data_stream(trace.kshark_ctx, trace.sd),
+            cfg->get_events_meta(), cfg->get_generation()};
+
+        for (auto _ : state) {
+            for (ssize_t i = 0; i < trace.count; ++i) {
+                benchmark::DoNotOptimize(registry.find(trace.rows[i]->event_id));
+            }
+        }
+        state.SetItemsProcessed(int64_t(state.iterations() * trace.count));
+    })->Unit(benchmark::kMillisecond);
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+
+    // Flags of the library are removed, `--large` and a trace file may remain
+    bool large = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--large") != 0)
+            continue;
+        large = true;
+        for (int j = i; j + 1 < argc; ++j) {
+            argv[j] = argv[j + 1];
+        }
+        --argc;
+        break;
+    }
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [--benchmark_...] [--large] [trace.dat]\n",
+                argv[0]);
+        return 1;
+    }
+
+    // Needs about 4 GB of memory
+    if (large) {
+        benchmark::RegisterBenchmark("BM_associate_kstacks", BM_associate_kstacks)
+            ->Arg(100'000'000)->Unit(benchmark::kMillisecond);
+    }
+
+    _LoadedTrace trace;
+    if (argc == 2) {
+        if (!trace.load(argv[1])) {
+            fprintf(stderr, "%s: can't load entries\n", argv[1]);
+            return 1;
+        }
+        _register_trace_benchmarks(trace);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
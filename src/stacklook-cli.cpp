@@ -0,0 +1,586 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    stacklook-cli.cpp
+ * @brief   Headless command-line tool for batch analysis of trace files.
+ *          Uses the core library only, i.e. no Qt and no display.
+ *
+ *          Each trace is analysed in a child process of its own, as
+ *          libkshark keeps a single global context. Up to `-j` children
+ *          run at once, their reports are printed whole as they finish.
+ *          With fewer traces than `-j`, each child spreads its work over
+ *          a thread pool, so that `-j` cores are used either way.
+*/
+
+// C
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlAssociation.hpp"
+#include "SlFoldedExport.hpp"
+#include "SlKallsyms.hpp"
+#include "SlPprofExport.hpp"
+#include "SlPrevState.hpp"
+#include "SlStackAggregate.hpp"
+#include "SlStreamIndex.hpp"
+#include "SlThreadPool.hpp"
+
+// Static variables
+
+///
+/// @brief Usage text of the tool.
+static const char* USAGE =
+    "Usage: stacklook-cli [options] TRACE.dat...\n"
+    "\n"
+    "Associates kernel stacks with collected events (sched_switch and\n"
+    "sched_waking by default) and prints prev_state breakdowns, top stacks\n"
+    "and off-CPU totals.\n"
+    "\n"
+    "Options:\n"
+    "  -j, --jobs N        cores used, one per trace analysed at once,\n"
+    "                      shared if there are fewer traces (default: all)\n"
+    "  -e, --event NAME    collect events NAME, e.g. block/block_rq_issue,\n"
+    "                      repeatable (default: sched/sched_switch and\n"
+    "                      sched/sched_waking)\n"
+    "  -n, --top N         stacks and tasks listed in top lists (default: 10)\n"
+    "  -o, --output DIR    directory for exports (default: .)\n"
+    "  -f, --folded        export folded stacks to DIR/TRACE.folded\n"
+    "      --off-cpu       weight folded stacks by off-CPU nanoseconds\n"
+    "  -p, --pprof         export a pprof profile to DIR/TRACE.pb.gz\n"
+    "      --kallsyms FILE resolve raw stack addresses with a saved\n"
+    "                      /proc/kallsyms or System.map\n"
+    "  -h, --help          print this help\n";
+
+/**
+ * @brief Options of a run of the tool.
+ */
+struct _CliOptions {
+    ///
+    /// @brief Maximum number of traces analysed at once.
+    unsigned jobs{std::max(1u, std::thread::hardware_concurrency())};
+    ///
+    /// @brief Number of entries in top lists.
+    size_t top{10};
+    ///
+    /// @brief Directory for exported files.
+    std::string output_dir{"."};
+    ///
+    /// @brief Whether to export folded stacks.
+    bool folded{false};
+    ///
+    /// @brief Whether folded stacks are weighted by off-CPU time.
+    bool off_cpu{false};
+    ///
+    /// @brief Whether to export a pprof profile.
+    bool pprof{false};
+    ///
+    /// @brief Saved kernel symbol table, empty for none.
+    std::string kallsyms_path;
+    ///
+    /// @brief Full names of the events to collect.
+    std::vector<std::string> events;
+    ///
+    /// @brief Trace files to analyse.
+    std::vector<std::string> traces;
+};
+
+/**
+ * @brief Child process analysing one trace.
+ */
+struct _RunningChild {
+    ///
+    /// @brief Temporary file the child writes its report to.
+    FILE* report;
+    ///
+    /// @brief Trace file the child analyses.
+    const std::string* trace;
+};
+
+// Static functions
+
+/**
+ * @brief Appends formatted text to a report.
+ *
+ * @param report: report to append to
+ * @param format: printf-like format
+ */
+[[gnu::format(printf, 2, 3)]]
+static void _append(std::string& report, const char* format, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    report += line;
+}
+
+/**
+ * @brief Gets the file name of a path without its directories and its
+ * last extension.
+ *
+ * @param path: path to a file
+ *
+ * @returns Base name of the file.
+ */
+static std::string _base_name(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    const size_t dot = name.find_last_of('.');
+    return (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+}
+
+/**
+ * @brief Joins frames of a stack into one line, top of the stack first.
+ *
+ * @param index: index holding the interned stack
+ * @param stack_id: ID of the stack
+ *
+ * @returns Text of the stack.
+ */
+static std::string _stack_text(const SlStreamIndex& index, uint32_t stack_id) {
+    std::string text;
+    for (uint32_t symbol : index.stacks().frames(stack_id)) {
+        if (!text.empty())
+            text += " <- ";
+        text += index.symbols().text(symbol);
+    }
+    return text;
+}
+
+/**
+ * @brief Adds prev_state breakdown of switches to a report.
+ *
+ * @param report: report to append to
+ * @param index: built index of the trace
+ */
+static void _report_prev_states(std::string& report, const SlStreamIndex& index) {
+    // Letter -> (all switches, switches with a stack)
+    std::map<char, std::pair<uint64_t, uint64_t>> states;
+    uint64_t switches = 0;
+
+    for (ssize_t i = 0; i < index.size(); ++i) {
+        const kshark_entry* entry = index.events()->data[i]->entry;
+        if (entry->event_id != index.sswitch_event_id())
+            continue;
+
+        // Known from the index for events with stacks, parsed otherwise
+        const bool has_stack = (index.stack_of(i) != SlStreamIndex::NO_STACK);
+        const char letter = has_stack ? index.prev_state_of(i)
+                                      : get_switch_prev_state(entry)[0];
+        ++states[letter].first;
+        states[letter].second += has_stack;
+        ++switches;
+    }
+
+    _append(report, "\nPrev-state breakdown (%lu switches):\n",
+            (unsigned long)switches);
+    for (const auto& [letter, counts] : states) {
+        const char* name = LETTER_TO_NAME.count(letter) ?
+            LETTER_TO_NAME.at(letter) : "unknown";
+        _append(report, "  %c %-30s %12lu  %6.2f %%  (%lu with stack)\n",
+                letter, name, (unsigned long)counts.first,
+                100.0 * double(counts.first) / double(switches),
+                (unsigned long)counts.second);
+    }
+}
+
+/**
+ * @brief Adds the most frequent stacks and tasks with the most off-CPU
+ * time to a report.
+ *
+ * @param report: report to append to
+ * @param index: built index of the trace
+ * @param top: number of entries of each list
+ */
+static void _report_top_lists(std::string& report, const SlStreamIndex& index,
+                              size_t top) {
+    const std::vector<SlAggregatedStack> aggregated = aggregate_stacks(index);
+
+    std::unordered_map<uint32_t, uint64_t> stack_counts;
+    // PID -> (off-CPU nanoseconds, index of a sample event)
+    std::unordered_map<int32_t, std::pair<uint64_t, ssize_t>> task_off_cpu;
+    uint64_t total_off_cpu = 0;
+    for (const SlAggregatedStack& stack : aggregated) {
+        stack_counts[stack.stack_id] += stack.count;
+        auto& task = task_off_cpu.try_emplace(stack.pid, 0, stack.sample_event)
+                         .first->second;
+        task.first += stack.off_cpu_ns;
+        total_off_cpu += stack.off_cpu_ns;
+    }
+
+    std::vector<std::pair<uint32_t, uint64_t>> stacks(stack_counts.begin(),
+                                                      stack_counts.end());
+    const size_t stacks_shown = std::min(top, stacks.size());
+    std::partial_sort(stacks.begin(), stacks.begin() + stacks_shown, stacks.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    _append(report, "\nTop %zu of %zu distinct stacks:\n", stacks_shown,
+            stacks.size());
+    for (size_t i = 0; i < stacks_shown; ++i) {
+        _append(report, "  %12lu  ", (unsigned long)stacks[i].second);
+        report += _stack_text(index, stacks[i].first);
+        report += '\n';
+    }
+
+    std::vector<std::pair<int32_t, std::pair<uint64_t, ssize_t>>> tasks(
+        task_off_cpu.begin(), task_off_cpu.end());
+    const size_t tasks_shown = std::min(top, tasks.size());
+    std::partial_sort(tasks.begin(), tasks.begin() + tasks_shown, tasks.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.second.first > b.second.first;
+                      });
+
+    _append(report, "\nOff-CPU time: %.6f s in total, top %zu tasks:\n",
+            double(total_off_cpu) / 1e9, tasks_shown);
+    for (size_t i = 0; i < tasks_shown; ++i) {
+        const kshark_entry* sample =
+            index.events()->data[tasks[i].second.second]->entry;
+        const char* task = kshark_get_task(sample);
+        _append(report, "  %14.6f s  %s-%d\n",
+                double(tasks[i].second.first) / 1e9,
+                (task != nullptr) ? task : "<unknown>", tasks[i].first);
+    }
+}
+
+/**
+ * @brief Adds results of requested exports to a report.
+ *
+ * @param report: report to append to
+ * @param index: built index of the trace
+ * @param options: options of the run
+ * @param trace: path of the trace
+ *
+ * @returns True if all exports succeeded, false otherwise.
+ */
+static bool _export(std::string& report, const SlStreamIndex& index,
+                    const _CliOptions& options, const std::string& trace) {
+    const std::string base = options.output_dir + "/" + _base_name(trace);
+    bool ok = true;
+
+    auto note = [&](const char* what, const std::string& path,
+                    const SlExportResult& result) {
+        if (result.ok) {
+            _append(report, "\nExported %lu %s stacks to %s\n",
+                    (unsigned long)result.stacks, what, path.c_str());
+        } else {
+            _append(report, "\nExport of %s stacks failed: %s\n",
+                    what, result.error.c_str());
+            ok = false;
+        }
+    };
+
+    if (options.folded) {
+        const std::string path = base + ".folded";
+        note("folded", path, export_folded_stacks(index, path,
+            options.off_cpu ? SlFoldedWeight::OFF_CPU_NS :
+                              SlFoldedWeight::EVENT_COUNT));
+    }
+
+    if (options.pprof) {
+        const std::string path = base + ".pb.gz";
+        note("pprof", path, export_pprof_profile(index, path));
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Analyses one trace and writes its report. Meant to run in
+ * a child process, as libkshark's context is global.
+ *
+ * The first line of the report holds the number of loaded events and
+ * seconds the analysis took, for the parent's totals.
+ *
+ * @param trace: path of the trace
+ * @param options: options of the run
+ * @param kallsyms: kernel symbol table to resolve raw addresses with,
+ * nullptr for none
+ * @param threads: number of threads the trace's work is spread over
+ * @param out: file to write the report to
+ *
+ * @returns Exit status of the child.
+ */
+static int _analyse_trace(const std::string& trace, const _CliOptions& options,
+                          const SlKallsyms* kallsyms, unsigned threads,
+                          FILE* out) {
+    const auto start = std::chrono::steady_clock::now();
+    std::string report;
+
+    // Created in the child, threads don't survive a fork
+    SlThreadPool::get_instance().resize(threads);
+    SlTaskGroup group;
+
+    kshark_context* kshark_ctx = nullptr;
+    if (!kshark_instance(&kshark_ctx)) {
+        fprintf(out, "0 0\n%s: couldn't initialize libkshark\n", trace.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const int sd = kshark_open(kshark_ctx, trace.c_str());
+    if (sd < 0) {
+        fprintf(out, "0 0\n%s: couldn't open the trace\n", trace.c_str());
+        kshark_free(kshark_ctx);
+        return EXIT_FAILURE;
+    }
+
+    kshark_entry** rows = nullptr;
+    const ssize_t rows_count = kshark_load_entries(kshark_ctx, sd, &rows);
+    const SlEventIds ids = find_event_ids(kshark_get_data_stream(kshark_ctx, sd),
+                                          options.events);
+
+    kshark_data_container* collected = (rows_count > 0) ?
+        collect_events(rows, size_t(rows_count), ids) : nullptr;
+    // User stacks, if recorded, are found in the same pass
+    SlUserStacks user_stacks{ids.ustack, {}};
+    SlUserStacks* wanted_user_stacks = (ids.ustack >= 0) ? &user_stacks : nullptr;
+    const bool kstacks_exist = (ids.kstack >= 0)
+        && associate_kstacks(collected, ids.kstack, &group, wanted_user_stacks);
+
+    bool ok = true;
+    _append(report, "%s\n", trace.c_str());
+    _append(report, "  %zd events, %zd collected events\n",
+            rows_count, (collected != nullptr) ? collected->size : 0);
+
+    if (kstacks_exist) {
+        SlStreamIndex index{collected, ids.sswitch, wanted_user_stacks};
+        index.build(kallsyms, &group);
+        _append(report, "  %zu distinct stacks, %zu distinct symbols\n",
+                index.stacks().size(), index.symbols().size());
+
+        _report_prev_states(report, index);
+        _report_top_lists(report, index, options.top);
+        ok = _export(report, index, options, trace);
+    } else {
+        report += "  No kernel stacks found.\n";
+    }
+
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    _append(report, "\nAnalysed in %.3f s, %.0f events/s\n", seconds,
+            (seconds > 0) ? double(std::max<ssize_t>(rows_count, 0)) / seconds : 0.0);
+
+    fprintf(out, "%zd %f\n%s", std::max<ssize_t>(rows_count, 0), seconds,
+            report.c_str());
+
+    if (collected != nullptr)
+        kshark_free_data_container(collected);
+    for (ssize_t i = 0; i < rows_count; ++i) {
+        free(rows[i]);
+    }
+    free(rows);
+    kshark_close(kshark_ctx, sd);
+    kshark_free(kshark_ctx);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Parses command-line arguments.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ * @param options: output location for parsed options
+ *
+ * @returns `-1` if the tool should run, otherwise the exit status the tool
+ * should exit with right away.
+ */
+static int _parse_args(int argc, char** argv, _CliOptions& options) {
+    enum { OFF_CPU_OPT = 256, KALLSYMS_OPT };
+    static const option LONG_OPTIONS[] = {
+        {"jobs",    required_argument, nullptr, 'j'},
+        {"event",   required_argument, nullptr, 'e'},
+        {"top",     required_argument, nullptr, 'n'},
+        {"output",  required_argument, nullptr, 'o'},
+        {"folded",  no_argument,       nullptr, 'f'},
+        {"off-cpu", no_argument,       nullptr, OFF_CPU_OPT},
+        {"pprof",   no_argument,       nullptr, 'p'},
+        {"kallsyms", required_argument, nullptr, KALLSYMS_OPT},
+        {"help",    no_argument,       nullptr, 'h'},
+        {nullptr,   0,                 nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "j:e:n:o:fph", LONG_OPTIONS,
+                              nullptr)) != -1) {
+        switch (opt) {
+            case 'j':
+                options.jobs = unsigned(std::max(1, atoi(optarg)));
+                break;
+            case 'e':
+                options.events.emplace_back(optarg);
+                break;
+            case 'n':
+                options.top = size_t(std::max(0, atoi(optarg)));
+                break;
+            case 'o':
+                options.output_dir = optarg;
+                break;
+            case 'f':
+                options.folded = true;
+                break;
+            case OFF_CPU_OPT:
+                options.off_cpu = true;
+                break;
+            case 'p':
+                options.pprof = true;
+                break;
+            case KALLSYMS_OPT:
+                options.kallsyms_path = optarg;
+                break;
+            case 'h':
+                fputs(USAGE, stdout);
+                return EXIT_SUCCESS;
+            default:
+                fputs(USAGE, stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    for (int i = optind; i < argc; ++i) {
+        options.traces.emplace_back(argv[i]);
+    }
+
+    if (options.traces.empty()) {
+        fputs(USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+
+    // Same as the plugin's default events
+    if (options.events.empty())
+        options.events = {"sched/sched_switch", "sched/sched_waking"};
+    return -1;
+}
+
+// Main
+
+/**
+ * @brief Analyses all given traces, up to `-j` at once, and prints their
+ * reports followed by the total throughput.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ *
+ * @returns `0` if all traces were analysed, `1` otherwise.
+ */
+int main(int argc, char** argv) {
+    _CliOptions options;
+    const int parse_status = _parse_args(argc, argv, options);
+    if (parse_status != -1)
+        return parse_status;
+
+    // Loaded once, children share it
+    SlKallsyms kallsyms;
+    if (!options.kallsyms_path.empty()) {
+        std::string error;
+        if (!kallsyms.load(options.kallsyms_path, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Cores left over by too few traces are shared by their children
+    const size_t children = std::min<size_t>(options.jobs, options.traces.size());
+    const unsigned threads = unsigned(std::max<size_t>(1, options.jobs / children));
+
+    const auto start = std::chrono::steady_clock::now();
+    // Child PID -> its report file and trace
+    std::map<pid_t, _RunningChild> running;
+    size_t next_trace = 0;
+    uint64_t total_events = 0;
+    bool all_ok = true;
+
+    while (next_trace < options.traces.size() || !running.empty()) {
+        while (next_trace < options.traces.size() && running.size() < options.jobs) {
+            FILE* report = tmpfile();
+            if (report == nullptr) {
+                perror("tmpfile");
+                return EXIT_FAILURE;
+            }
+            // Nothing buffered may be written twice by the child
+            fflush(stdout);
+
+            const pid_t child = fork();
+            if (child < 0) {
+                perror("fork");
+                return EXIT_FAILURE;
+            }
+            if (child == 0) {
+                const int status = _analyse_trace(options.traces[next_trace],
+                    options, (kallsyms.size() > 0) ? &kallsyms : nullptr,
+                    threads, report);
+                fflush(report);
+                _exit(status);
+            }
+            running.emplace(child, _RunningChild{report, &options.traces[next_trace]});
+            ++next_trace;
+        }
+
+        int status;
+        const pid_t finished = wait(&status);
+        if (finished < 0) {
+            perror("wait");
+            return EXIT_FAILURE;
+        }
+        auto child = running.find(finished);
+        if (child == running.end())
+            continue;
+
+        FILE* report = child->second.report;
+        const std::string& trace = *child->second.trace;
+        running.erase(child);
+        const bool child_ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        all_ok = all_ok && child_ok;
+
+        rewind(report);
+        unsigned long long events = 0;
+        double seconds = 0;
+        if (fscanf(report, "%llu %lf\n", &events, &seconds) == 2)
+            total_events += events;
+
+        char buffer[1 << 14];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), report)) > 0) {
+            fwrite(buffer, 1, read, stdout);
+        }
+        fputs("\n", stdout);
+        fclose(report);
+
+        // A crashed child may not have written any report
+        if (!child_ok)
+            fflush(stdout);
+        if (!child_ok && WIFSIGNALED(status)) {
+            fprintf(stderr, "%s: analysis killed by signal %d (%s)\n",
+                    trace.c_str(), WTERMSIG(status), strsignal(WTERMSIG(status)));
+        } else if (!child_ok) {
+            fprintf(stderr, "%s: analysis failed with exit status %d\n",
+                    trace.c_str(), WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    printf("Total: %zu traces, %llu events in %.3f s, %.0f events/s with "
+           "%u jobs\n", options.traces.size(), (unsigned long long)total_events,
+           seconds, (seconds > 0) ? double(total_events) / seconds : 0.0,
+           options.jobs);
+
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1000 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    stacklook-gen.cpp
+ * @brief   Generator of synthetic trace-cmd trace files (version 6, flyrecord)
+ *          with `sched/sched_switch`, `sched/sched_waking` and
+ *          `ftrace/kernel_stack` events, for scale and stress testing of
+ *          the plugin without real traces.
+ *
+ *          Each CPU runs its own share of tasks: wakings put sleeping tasks
+ *          into a run queue, switches take them off it, so that wakeup
+ *          latencies are meaningful too. Kernel stacks follow their events
+ *          on the same CPU, except for injected missing ones and misplaced
+ *          ones, which come only after the next event of the CPU.
+ *
+ *          Doesn't depend on KernelShark, it writes the file format directly.
+*/
+
+// C
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// C++
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Static variables
+
+///
+/// @brief Usage text of the tool.
+static const char* USAGE =
+    "Usage: stacklook-gen [options] -o OUTPUT.dat\n"
+    "\n"
+    "Writes a synthetic trace-cmd trace file with sched_switch, sched_waking\n"
+    "and kernel_stack events.\n"
+    "\n"
+    "Options:\n"
+    "  -o, --output FILE        trace file to write\n"
+    "  -c, --cpus N             number of CPUs (default: 4)\n"
+    "  -t, --tasks N            number of tasks, spread over CPUs (default: 64)\n"
+    "  -d, --duration SEC       traced time in seconds (default: 1)\n"
+    "      --switch-rate N      sched_switch events per CPU and second\n"
+    "                           (default: 2000)\n"
+    "      --waking-rate N      sched_waking events per CPU and second\n"
+    "                           (default: 2000)\n"
+    "      --depth MIN:MAX      kernel stack depths (default: 6:24)\n"
+    "      --depth-dist DIST    'uniform' or 'geometric' (default: uniform)\n"
+    "      --repeat RATIO       share of stacks reusing an earlier stack\n"
+    "                           (default: 0.8)\n"
+    "      --missing RATIO      share of events without a kernel stack\n"
+    "                           (default: 0.01)\n"
+    "      --misplaced RATIO    share of kernel stacks placed after the next\n"
+    "                           event of the CPU (default: 0.01)\n"
+    "  -s, --seed N             seed of the generator (default: 1)\n"
+    "  -h, --help               print this help\n";
+
+///
+/// @brief Size of ring buffer pages.
+static constexpr uint32_t PAGE_SIZE = 4096;
+
+///
+/// @brief Size of the header of a ring buffer page - timestamp and commit.
+static constexpr uint32_t PAGE_HEADER_SIZE = 16;
+
+///
+/// @brief Largest payload whose length fits into an event header.
+static constexpr uint32_t MAX_SMALL_DATA = 28 * 4;
+
+///
+/// @brief Largest time delta which fits into an event header.
+static constexpr uint64_t MAX_DELTA = (1u << 27) - 1;
+
+///
+/// @brief Ring buffer's type_len of time extends.
+static constexpr uint32_t TYPE_TIME_EXTEND = 30;
+
+///
+/// @brief Timestamp of the beginning of the trace.
+static constexpr uint64_t START_TS = 10'000'000'000ull;
+
+///
+/// @brief Event IDs written into the trace's formats.
+enum _event_id : uint16_t {
+    KSTACK_ID = 4,
+    SWITCH_ID = 316,
+    WAKING_ID = 318
+};
+
+///
+/// @brief Priority of all generated tasks.
+static constexpr int32_t TASK_PRIO = 120;
+
+///
+/// @brief Maximum number of distinct stacks kept for reuse per event.
+static constexpr size_t STACK_POOL_LIMIT = 4096;
+
+///
+/// @brief Number of generated symbols for the middle of stacks.
+static constexpr uint32_t GENERATED_SYMBOLS = 1024;
+
+///
+/// @brief Address of the first symbol.
+static constexpr uint64_t SYMBOLS_BASE = 0xffffffff81000000ull;
+
+///
+/// @brief Address space of each symbol.
+static constexpr uint64_t SYMBOL_SPAN = 0x200;
+
+///
+/// @brief Symbols at the leaf of switch stacks, leaf first.
+static const std::vector<std::string_view> SWITCH_LEAF{"__schedule", "schedule"};
+
+///
+/// @brief Symbols at the leaf of waking stacks, leaf first.
+static const std::vector<std::string_view> WAKING_LEAF{"try_to_wake_up",
+                                                       "wake_up_q"};
+
+///
+/// @brief Symbols at the root of all stacks, leaf first.
+static const std::vector<std::string_view> STACK_ROOT{"do_syscall_64",
+                                                      "entry_SYSCALL_64_after_hwframe"};
+
+///
+/// @brief Named symbols of the middle of stacks.
+static const std::vector<std::string_view> NAMED_SYMBOLS{
+    "schedule_timeout", "io_schedule", "mutex_lock", "__mutex_lock_slowpath",
+    "rwsem_down_read_slowpath", "futex_wait_queue", "futex_wait", "do_futex",
+    "__x64_sys_futex", "ep_poll", "do_epoll_wait", "__x64_sys_epoll_wait",
+    "pipe_read", "vfs_read", "ksys_read", "__x64_sys_read", "blk_mq_get_tag",
+    "submit_bio_wait", "ext4_read_block_bitmap", "jbd2_log_wait_commit",
+    "do_nanosleep", "hrtimer_nanosleep", "__x64_sys_nanosleep",
+    "unix_stream_read_generic", "sock_recvmsg", "__sys_recvfrom",
+    "__wake_up_common", "__wake_up_sync_key", "sock_def_readable",
+    "futex_wake", "pipe_write", "vfs_write", "ksys_write", "__x64_sys_write"
+};
+
+///
+/// @brief Format of ring buffer page headers.
+static const char* HEADER_PAGE_FORMAT =
+    "\tfield: u64 timestamp;\toffset:0;\tsize:8;\tsigned:0;\n"
+    "\tfield: local_t commit;\toffset:8;\tsize:8;\tsigned:1;\n"
+    "\tfield: int overwrite;\toffset:8;\tsize:1;\tsigned:1;\n"
+    "\tfield: char data;\toffset:16;\tsize:4080;\tsigned:1;\n";
+
+///
+/// @brief Format of ring buffer event headers.
+static const char* HEADER_EVENT_FORMAT =
+    "# compressed entry header\n"
+    "\ttype_len    :    5 bits\n"
+    "\ttime_delta  :   27 bits\n"
+    "\tarray       :   32 bits\n"
+    "\n"
+    "\tpadding     : type == 29\n"
+    "\ttime_extend : type == 30\n"
+    "\ttime_stamp : type == 31\n"
+    "\tdata max type_len  == 28\n";
+
+///
+/// @brief Common fields of all event formats.
+#define COMMON_FIELDS \
+    "\tfield:unsigned short common_type;\toffset:0;\tsize:2;\tsigned:0;\n" \
+    "\tfield:unsigned char common_flags;\toffset:2;\tsize:1;\tsigned:0;\n" \
+    "\tfield:unsigned char common_preempt_count;\toffset:3;\tsize:1;\tsigned:0;\n" \
+    "\tfield:int common_pid;\toffset:4;\tsize:4;\tsigned:1;\n\n"
+
+///
+/// @brief Format of `ftrace/kernel_stack`.
+static const char* KSTACK_FORMAT =
+    "name: kernel_stack\n"
+    "ID: 4\n"
+    "format:\n"
+    COMMON_FIELDS
+    "\tfield:int size;\toffset:8;\tsize:4;\tsigned:1;\n"
+    "\tfield:unsigned long caller[8];\toffset:16;\tsize:64;\tsigned:0;\n"
+    "\n"
+    "print fmt: \"\\t=> %ps\\n\\t=> %ps\\n\\t=> %ps\\n\" \"\\t=> %ps\\n\\t=> %ps\\n"
+    "\\t=> %ps\\n\" \"\\t=> %ps\\n\\t=> %ps\\n\", (void *)REC->caller[0], "
+    "(void *)REC->caller[1], (void *)REC->caller[2], (void *)REC->caller[3], "
+    "(void *)REC->caller[4], (void *)REC->caller[5], (void *)REC->caller[6], "
+    "(void *)REC->caller[7]\n";
+
+///
+/// @brief Format of `sched/sched_switch`.
+static const char* SWITCH_FORMAT =
+    "name: sched_switch\n"
+    "ID: 316\n"
+    "format:\n"
+    COMMON_FIELDS
+    "\tfield:char prev_comm[16];\toffset:8;\tsize:16;\tsigned:0;\n"
+    "\tfield:pid_t prev_pid;\toffset:24;\tsize:4;\tsigned:1;\n"
+    "\tfield:int prev_prio;\toffset:28;\tsize:4;\tsigned:1;\n"
+    "\tfield:long prev_state;\toffset:32;\tsize:8;\tsigned:1;\n"
+    "\tfield:char next_comm[16];\toffset:40;\tsize:16;\tsigned:0;\n"
+    "\tfield:pid_t next_pid;\toffset:56;\tsize:4;\tsigned:1;\n"
+    "\tfield:int next_prio;\toffset:60;\tsize:4;\tsigned:1;\n"
+    "\n"
+    "print fmt: \"prev_comm=%s prev_pid=%d prev_prio=%d prev_state=%s%s ==> "
+    "next_comm=%s next_pid=%d next_prio=%d\", REC->prev_comm, REC->prev_pid, "
+    "REC->prev_prio, (REC->prev_state & ((((0x00000000 | 0x00000001 | "
+    "0x00000002 | 0x00000004 | 0x00000008 | 0x00000010 | 0x00000020 | "
+    "0x00000040) + 1) << 1) - 1)) ? __print_flags(REC->prev_state & "
+    "((((0x00000000 | 0x00000001 | 0x00000002 | 0x00000004 | 0x00000008 | "
+    "0x00000010 | 0x00000020 | 0x00000040) + 1) << 1) - 1), \"|\", "
+    "{ 0x00000001, \"S\" }, { 0x00000002, \"D\" }, { 0x00000004, \"T\" }, "
+    "{ 0x00000008, \"t\" }, { 0x00000010, \"X\" }, { 0x00000020, \"Z\" }, "
+    "{ 0x00000040, \"P\" }, { 0x00000080, \"I\" }) : \"R\", REC->prev_state & "
+    "(((0x00000000 | 0x00000001 | 0x00000002 | 0x00000004 | 0x00000008 | "
+    "0x00000010 | 0x00000020 | 0x00000040) + 1) << 1) ? \"+\" : \"\", "
+    "REC->next_comm, REC->next_pid, REC->next_prio\n";
+
+///
+/// @brief Format of `sched/sched_waking`.
+static const char* WAKING_FORMAT =
+    "name: sched_waking\n"
+    "ID: 318\n"
+    "format:\n"
+    COMMON_FIELDS
+    "\tfield:char comm[16];\toffset:8;\tsize:16;\tsigned:0;\n"
+    "\tfield:pid_t pid;\toffset:24;\tsize:4;\tsigned:1;\n"
+    "\tfield:int prio;\toffset:28;\tsize:4;\tsigned:1;\n"
+    "\tfield:int target_cpu;\toffset:32;\tsize:4;\tsigned:1;\n"
+    "\n"
+    "print fmt: \"comm=%s pid=%d prio=%d target_cpu=%03d\", REC->comm, "
+    "REC->pid, REC->prio, REC->target_cpu\n";
+
+#undef COMMON_FIELDS
+
+/**
+ * @brief Shape of stack depths.
+ */
+enum class _DepthDist {
+    ///
+    /// @brief All depths between the minimum and maximum equally likely.
+    UNIFORM,
+    /// @brief Shallow stacks most likely, each deeper one a bit less,
+    /// capped at the maximum.
+    GEOMETRIC
+};
+
+/**
+ * @brief Options of a run of the tool.
+ */
+struct _GenOptions {
+    ///
+    /// @brief Path of the written trace file.
+    std::string output;
+    ///
+    /// @brief Number of CPUs.
+    uint32_t cpus{4};
+    ///
+    /// @brief Number of tasks, other than idle ones.
+    uint32_t tasks{64};
+    ///
+    /// @brief Traced time in seconds.
+    double duration{1.0};
+    ///
+    /// @brief Switches per CPU and second.
+    double switch_rate{2000};
+    ///
+    /// @brief Wakings per CPU and second.
+    double waking_rate{2000};
+    ///
+    /// @brief Minimal depth of kernel stacks.
+    uint32_t depth_min{6};
+    ///
+    /// @brief Maximal depth of kernel stacks.
+    uint32_t depth_max{24};
+    ///
+    /// @brief Shape of stack depths.
+    _DepthDist depth_dist{_DepthDist::UNIFORM};
+    ///
+    /// @brief Probability that a stack reuses an earlier one.
+    double repeat{0.8};
+    ///
+    /// @brief Probability that an event has no kernel stack.
+    double missing{0.01};
+    ///
+    /// @brief Probability that a kernel stack comes after the next event.
+    double misplaced{0.01};
+    ///
+    /// @brief Seed of the generator.
+    uint64_t seed{1};
+};
+
+/**
+ * @brief Counts of written records.
+ */
+struct _GenCounts {
+    ///
+    /// @brief Written `sched/sched_switch` events.
+    uint64_t switches{0};
+    ///
+    /// @brief Written `sched/sched_waking` events.
+    uint64_t wakings{0};
+    ///
+    /// @brief Written `ftrace/kernel_stack` events.
+    uint64_t stacks{0};
+    ///
+    /// @brief Events left without a kernel stack.
+    uint64_t missing{0};
+    ///
+    /// @brief Kernel stacks placed after the next event of their CPU.
+    uint64_t misplaced{0};
+};
+
+// Static functions
+
+/**
+ * @brief Appends a little-endian integer.
+ *
+ * @param out: buffer to append to
+ * @param value: the integer
+ */
+template<typename T>
+static void _put(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out += char(uint8_t(uint64_t(value) >> (8 * i)));
+    }
+}
+
+/**
+ * @brief Appends a fixed-size, zero-padded character array.
+ *
+ * @param out: buffer to append to
+ * @param text: text of the array, truncated if too long
+ * @param size: size of the array
+ */
+static void _put_chars(std::string& out, std::string_view text, size_t size) {
+    text = text.substr(0, size - 1);
+    out += text;
+    out.append(size - text.size(), '\0');
+}
+
+/**
+ * @brief Appends a section of a text file of the trace, its size first.
+ *
+ * @param out: buffer to append to
+ * @param text: content of the file
+ */
+template<typename SizeT>
+static void _put_file(std::string& out, std::string_view text) {
+    _put<SizeT>(out, SizeT(text.size()));
+    out += text;
+}
+
+/**
+ * @brief Gets the name of a task.
+ *
+ * @param pid: PID of the task, `0` for the idle task
+ * @param cpu: CPU of the task
+ *
+ * @returns Name of the task.
+ */
+static std::string _task_name(int32_t pid, uint32_t cpu) {
+    return (pid == 0) ? "swapper/" + std::to_string(cpu)
+                      : "sl-gen-" + std::to_string(pid);
+}
+
+/**
+ * @brief Writer of a CPU's events into ring buffer pages.
+ */
+class _PageWriter {
+private: // Data members
+    ///
+    /// @brief Trace file written to.
+    FILE* _out;
+    ///
+    /// @brief Page being filled, including its header.
+    std::string _page;
+    ///
+    /// @brief Timestamp of the last event on the page.
+    uint64_t _last_ts{0};
+    ///
+    /// @brief Whether the page has any event yet.
+    bool _started{false};
+    ///
+    /// @brief Whether all writes succeeded so far.
+    bool _ok{true};
+
+    /**
+     * @brief Writes the filled page out, with its commit set to the
+     * size of its events, and starts a new one.
+     */
+    void _flush() {
+        const uint64_t commit = _page.size() - PAGE_HEADER_SIZE;
+        for (size_t i = 0; i < 8; ++i) {
+            _page[8 + i] = char(uint8_t(commit >> (8 * i)));
+        }
+        _page.resize(PAGE_SIZE, '\0');
+        _ok = _ok && fwrite(_page.data(), 1, _page.size(), _out) == _page.size();
+        _page.clear();
+        _started = false;
+    }
+public: // Functions
+    /**
+     * @brief Prepares writing of pages into a file.
+     *
+     * @param out: trace file, positioned at the start of the CPU's data
+     */
+    explicit _PageWriter(FILE* out)
+        : _out(out) {
+        _page.reserve(PAGE_SIZE);
+    }
+
+    /**
+     * @brief Adds an event to the page, starting a new page if it doesn't fit.
+     *
+     * @param ts: timestamp of the event, not less than the previous one
+     * @param payload: the event's data, starting with its common fields
+     */
+    void add(uint64_t ts, std::string_view payload) {
+        const uint32_t length = uint32_t((payload.size() + 3) & ~size_t(3));
+        const bool small = (length <= MAX_SMALL_DATA);
+        uint32_t needed = 4 + length + (small ? 0 : 4);
+        uint64_t delta = _started ? ts - _last_ts : 0;
+        if (delta > MAX_DELTA)
+            needed += 8;
+
+        if (_started && _page.size() + needed > PAGE_SIZE)
+            _flush();
+
+        if (!_started) {
+            _page.clear();
+            _put<uint64_t>(_page, ts);
+            _put<uint64_t>(_page, 0);
+            _started = true;
+            delta = 0;
+        }
+
+        if (delta > MAX_DELTA) {
+            _put<uint32_t>(_page, TYPE_TIME_EXTEND | uint32_t(delta & MAX_DELTA) << 5);
+            _put<uint32_t>(_page, uint32_t(delta >> 27));
+            delta = 0;
+        }
+
+        if (small) {
+            _put<uint32_t>(_page, (length / 4) | uint32_t(delta) << 5);
+        } else {
+            _put<uint32_t>(_page, uint32_t(delta) << 5);
+            _put<uint32_t>(_page, length + 4);
+        }
+        _page += payload;
+        _page.append(length - payload.size(), '\0');
+        _last_ts = ts;
+    }
+
+    /**
+     * @brief Writes out the last page, if it has any events.
+     *
+     * @returns True if all pages were written, false otherwise.
+     */
+    bool finish() {
+        if (_started)
+            _flush();
+        return _ok;
+    }
+};
+
+/**
+ * @brief Kernel symbols of the trace and stacks made of them.
+ */
+class _StackMaker {
+private: // Data members
+    ///
+    /// @brief Names of all symbols, in the order of their addresses.
+    std::vector<std::string> _symbols;
+    ///
+    /// @brief Stacks of switches kept for reuse, as symbol indices.
+    std::vector<std::vector<uint32_t>> _switch_pool;
+    ///
+    /// @brief Stacks of wakings kept for reuse, as symbol indices.
+    std::vector<std::vector<uint32_t>> _waking_pool;
+    ///
+    /// @brief Options of the run.
+    const _GenOptions& _options;
+
+    /**
+     * @brief Gets the index of a named symbol.
+     *
+     * @param name: name of the symbol, which must exist
+     *
+     * @returns Index of the symbol.
+     */
+    uint32_t _symbol(std::string_view name) const {
+        return uint32_t(std::find(_symbols.begin(), _symbols.end(), name)
+                        - _symbols.begin());
+    }
+
+    /**
+     * @brief Draws a depth of a new stack.
+     *
+     * @param rng: random generator
+     *
+     * @returns The depth, at least the fixed leaf and root frames.
+     */
+    uint32_t _depth(std::mt19937_64& rng) const {
+        const uint32_t spread = _options.depth_max - _options.depth_min;
+        uint32_t depth;
+        if (_options.depth_dist == _DepthDist::UNIFORM) {
+            depth = _options.depth_min
+                    + std::uniform_int_distribution<uint32_t>{0, spread}(rng);
+        } else {
+            std::geometric_distribution<uint32_t> extra{1.0 / (1.0 + spread / 4.0)};
+            depth = _options.depth_min + std::min(spread, extra(rng));
+        }
+        return std::max<uint32_t>(depth, SWITCH_LEAF.size() + STACK_ROOT.size());
+    }
+public: // Functions
+    /**
+     * @brief Creates symbols of the trace.
+     *
+     * @param options: options of the run, which must outlive the maker
+     */
+    explicit _StackMaker(const _GenOptions& options)
+        : _options(options) {
+        for (const auto* names : {&SWITCH_LEAF, &WAKING_LEAF, &STACK_ROOT,
+                                  &NAMED_SYMBOLS}) {
+            _symbols.insert(_symbols.end(), names->begin(), names->end());
+        }
+        for (uint32_t i = 0; i < GENERATED_SYMBOLS; ++i) {
+            _symbols.push_back("sl_gen_func_" + std::to_string(i));
+        }
+    }
+
+    /**
+     * @brief Gets a stack for an event, either one used before or a new one.
+     *
+     * @param is_switch: whether the event is a switch or a waking
+     * @param rng: random generator
+     *
+     * @returns Frames of the stack as symbol indices, leaf first.
+     */
+    const std::vector<uint32_t>& stack(bool is_switch, std::mt19937_64& rng) {
+        auto& pool = is_switch ? _switch_pool : _waking_pool;
+        std::uniform_real_distribution<double> chance{0.0, 1.0};
+
+        if (!pool.empty() && chance(rng) < _options.repeat) {
+            // Squared, so that a few stacks are much hotter than others
+            const double pick = chance(rng);
+            return pool[size_t(pick * pick * double(pool.size()))];
+        }
+
+        const auto& leaf = is_switch ? SWITCH_LEAF : WAKING_LEAF;
+        const uint32_t depth = _depth(rng);
+        std::uniform_int_distribution<uint32_t> middle{
+            uint32_t(SWITCH_LEAF.size() + WAKING_LEAF.size() + STACK_ROOT.size()),
+            uint32_t(_symbols.size() - 1)};
+
+        std::vector<uint32_t> frames;
+        for (std::string_view name : leaf) {
+            frames.push_back(_symbol(name));
+        }
+        while (frames.size() + STACK_ROOT.size() < depth) {
+            frames.push_back(middle(rng));
+        }
+        for (std::string_view name : STACK_ROOT) {
+            frames.push_back(_symbol(name));
+        }
+
+        if (pool.size() < STACK_POOL_LIMIT) {
+            pool.push_back(std::move(frames));
+            return pool.back();
+        }
+        auto& replaced = pool[std::uniform_int_distribution<size_t>{0, pool.size() - 1}(rng)];
+        replaced = std::move(frames);
+        return replaced;
+    }
+
+    /**
+     * @brief Gets a return address inside of a symbol.
+     *
+     * @param symbol: index of the symbol
+     *
+     * @returns The address.
+     */
+    static uint64_t address(uint32_t symbol) {
+        return SYMBOLS_BASE + symbol * SYMBOL_SPAN + 0x2a;
+    }
+
+    /**
+     * @brief Gets symbols in the format of `/proc/kallsyms`.
+     *
+     * @returns Text of the symbols.
+     */
+    std::string kallsyms() const {
+        std::string text;
+        char line[128];
+        for (uint32_t i = 0; i < _symbols.size(); ++i) {
+            snprintf(line, sizeof(line), "%016llx T %s\n",
+                     (unsigned long long)(SYMBOLS_BASE + i * SYMBOL_SPAN),
+                     _symbols[i].c_str());
+            text += line;
+        }
+        return text;
+    }
+};
+
+/**
+ * @brief Makes the common fields of an event.
+ *
+ * @param id: event ID
+ * @param pid: PID of the task running on the CPU
+ *
+ * @returns Start of the event's payload.
+ */
+static std::string _common_fields(uint16_t id, int32_t pid) {
+    std::string payload;
+    _put<uint16_t>(payload, id);
+    _put<uint8_t>(payload, 0);
+    _put<uint8_t>(payload, 0);
+    _put<int32_t>(payload, pid);
+    return payload;
+}
+
+/**
+ * @brief Makes a `ftrace/kernel_stack` event.
+ *
+ * @param pid: PID of the task the stack belongs to
+ * @param frames: frames of the stack, leaf first
+ *
+ * @returns Payload of the event.
+ */
+static std::string _kstack_payload(int32_t pid, const std::vector<uint32_t>& frames) {
+    std::string payload = _common_fields(KSTACK_ID, pid);
+    _put<int32_t>(payload, int32_t(frames.size()));
+    _put<uint32_t>(payload, 0);
+    for (uint32_t symbol : frames) {
+        _put<uint64_t>(payload, _StackMaker::address(symbol));
+    }
+    return payload;
+}
+
+/**
+ * @brief Generates and writes events of one CPU.
+ *
+ * @param cpu: the CPU
+ * @param options: options of the run
+ * @param stacks: maker of kernel stacks
+ * @param rng: random generator
+ * @param out: trace file, positioned at the start of the CPU's data
+ * @param counts: counts of written records to update
+ *
+ * @returns True if all pages were written, false otherwise.
+ */
+static bool _generate_cpu(uint32_t cpu, const _GenOptions& options,
+                          _StackMaker& stacks, std::mt19937_64& rng,
+                          FILE* out, _GenCounts& counts) {
+    _PageWriter pages{out};
+    std::uniform_real_distribution<double> chance{0.0, 1.0};
+    const double rate = options.switch_rate + options.waking_rate;
+    if (rate <= 0)
+        return pages.finish();
+    std::exponential_distribution<double> gap{rate / 1e9};
+
+    // Tasks of the CPU, each one either running, runnable or sleeping
+    int32_t current = 0;
+    std::deque<int32_t> runnable;
+    std::vector<int32_t> sleeping;
+    for (uint32_t task = cpu; task < options.tasks; task += options.cpus) {
+        sleeping.push_back(int32_t(1000 + task));
+    }
+
+    std::optional<std::string> misplaced;
+    const uint64_t end = START_TS + uint64_t(options.duration * 1e9);
+
+    for (uint64_t ts = START_TS; ; ) {
+        ts += 1000 + uint64_t(gap(rng));
+        if (ts >= end)
+            break;
+
+        bool is_switch = chance(rng) * rate < options.switch_rate;
+        const bool can_switch = (current != 0 || !runnable.empty());
+        if (is_switch && !can_switch)
+            is_switch = false;
+        if (!is_switch && sleeping.empty()) {
+            if (!can_switch)
+                continue;
+            is_switch = true;
+        }
+
+        const int32_t owner = current;
+        std::string payload;
+        if (is_switch) {
+            // Running (preempted), sleeping or in uninterruptible sleep.
+            // Only preempted by another task, if there is one.
+            int64_t prev_state = 0;
+            if (current != 0) {
+                const double state = chance(rng);
+                prev_state = (state < 0.25 && !runnable.empty()) ? 0
+                             : (state < 0.85) ? 1 : 2;
+            }
+
+            const int32_t next = runnable.empty() ? 0 : runnable.front();
+            if (!runnable.empty())
+                runnable.pop_front();
+            if (current != 0 && prev_state == 0)
+                runnable.push_back(current);
+            else if (current != 0)
+                sleeping.push_back(current);
+
+            payload = _common_fields(SWITCH_ID, current);
+            _put_chars(payload, _task_name(current, cpu), 16);
+            _put<int32_t>(payload, current);
+            _put<int32_t>(payload, TASK_PRIO);
+            _put<int64_t>(payload, prev_state);
+            _put_chars(payload, _task_name(next, cpu), 16);
+            _put<int32_t>(payload, next);
+            _put<int32_t>(payload, TASK_PRIO);
+
+            current = next;
+            ++counts.switches;
+        } else {
+            const size_t woken_idx = std::uniform_int_distribution<size_t>{
+                0, sleeping.size() - 1}(rng);
+            const int32_t woken = sleeping[woken_idx];
+            sleeping[woken_idx] = sleeping.back();
+            sleeping.pop_back();
+            runnable.push_back(woken);
+
+            payload = _common_fields(WAKING_ID, current);
+            _put_chars(payload, _task_name(woken, cpu), 16);
+            _put<int32_t>(payload, woken);
+            _put<int32_t>(payload, TASK_PRIO);
+            _put<int32_t>(payload, int32_t(cpu));
+            ++counts.wakings;
+        }
+        pages.add(ts, payload);
+
+        // A stack misplaced by the previous event comes only now
+        if (misplaced) {
+            pages.add(ts + 50, *misplaced);
+            misplaced.reset();
+            ++counts.stacks;
+        }
+
+        const double placement = chance(rng);
+        if (placement < options.missing) {
+            ++counts.missing;
+            continue;
+        }
+
+        std::string stack = _kstack_payload(owner, stacks.stack(is_switch, rng));
+        if (placement < options.missing + options.misplaced) {
+            misplaced = std::move(stack);
+            ++counts.misplaced;
+        } else {
+            pages.add(ts + 100, stack);
+            ++counts.stacks;
+        }
+    }
+
+    if (misplaced) {
+        pages.add(end, *misplaced);
+        ++counts.stacks;
+    }
+
+    return pages.finish();
+}
+
+/**
+ * @brief Makes the part of the trace file before the CPU data: the
+ * identification, event formats, kallsyms, command lines and the
+ * number of CPUs.
+ *
+ * @param options: options of the run
+ * @param stacks: maker of kernel stacks, for its symbols
+ *
+ * @returns The headers.
+ */
+static std::string _headers(const _GenOptions& options, const _StackMaker& stacks) {
+    std::string out;
+    out += std::string_view("\x17\x08\x44tracing", 10);
+    out += std::string_view("6", 2);
+    _put<uint8_t>(out, 0);  // Little endian
+    _put<uint8_t>(out, 8);  // Size of long
+    _put<uint32_t>(out, PAGE_SIZE);
+
+    out += std::string_view("header_page", 12);
+    _put_file<uint64_t>(out, HEADER_PAGE_FORMAT);
+    out += std::string_view("header_event", 13);
+    _put_file<uint64_t>(out, HEADER_EVENT_FORMAT);
+
+    // Ftrace events
+    _put<uint32_t>(out, 1);
+    _put_file<uint64_t>(out, KSTACK_FORMAT);
+
+    // Event systems
+    _put<uint32_t>(out, 1);
+    out += std::string_view("sched", 6);
+    _put<uint32_t>(out, 2);
+    _put_file<uint64_t>(out, SWITCH_FORMAT);
+    _put_file<uint64_t>(out, WAKING_FORMAT);
+
+    _put_file<uint32_t>(out, stacks.kallsyms());
+    _put_file<uint32_t>(out, "");  // No printk formats
+
+    std::string cmdlines;
+    for (uint32_t task = 0; task < options.tasks; ++task) {
+        const int32_t pid = int32_t(1000 + task);
+        cmdlines += std::to_string(pid) + " " + _task_name(pid, 0) + "\n";
+    }
+    _put_file<uint64_t>(out, cmdlines);
+
+    _put<uint32_t>(out, options.cpus);
+    return out;
+}
+
+/**
+ * @brief Writes the whole trace file. Data of each CPU is written right
+ * after it is generated, their offsets and sizes are filled in last.
+ *
+ * @param options: options of the run
+ * @param counts: output location for counts of written records
+ *
+ * @returns True if the file was written, false otherwise.
+ */
+static bool _write_trace(const _GenOptions& options, _GenCounts& counts) {
+    FILE* out = fopen(options.output.c_str(), "wb");
+    if (out == nullptr) {
+        perror(options.output.c_str());
+        return false;
+    }
+    setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    std::mt19937_64 rng{options.seed};
+    _StackMaker stacks{options};
+
+    std::string headers = _headers(options, stacks);
+    headers += std::string_view("flyrecord", 10);
+    const long cpu_table = long(headers.size());
+    headers.append(size_t(options.cpus) * 16, '\0');
+    headers.append((PAGE_SIZE - headers.size() % PAGE_SIZE) % PAGE_SIZE, '\0');
+    bool ok = fwrite(headers.data(), 1, headers.size(), out) == headers.size();
+
+    std::string table;
+    for (uint32_t cpu = 0; ok && cpu < options.cpus; ++cpu) {
+        const long offset = ftell(out);
+        ok = _generate_cpu(cpu, options, stacks, rng, out, counts);
+        _put<uint64_t>(table, uint64_t(offset));
+        _put<uint64_t>(table, uint64_t(ftell(out) - offset));
+    }
+
+    ok = ok && fseek(out, cpu_table, SEEK_SET) == 0
+         && fwrite(table.data(), 1, table.size(), out) == table.size();
+    ok = (fclose(out) == 0) && ok;
+    if (!ok)
+        fprintf(stderr, "%s: writing the trace failed\n", options.output.c_str());
+    return ok;
+}
+
+/**
+ * @brief Parses a ratio argument.
+ *
+ * @param text: the argument
+ * @param ratio: output location for the ratio
+ *
+ * @returns True if the argument is a number between 0 and 1, false otherwise.
+ */
+static bool _parse_ratio(const char* text, double& ratio) {
+    char* end;
+    ratio = strtod(text, &end);
+    return *end == '\0' && ratio >= 0.0 && ratio <= 1.0;
+}
+
+/**
+ * @brief Parses command-line arguments.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ * @param options: output location for parsed options
+ *
+ * @returns `-1` if the tool should run, otherwise the exit status the tool
+ * should exit with right away.
+ */
+static int _parse_args(int argc, char** argv, _GenOptions& options) {
+    enum {
+        SWITCH_RATE_OPT = 256, WAKING_RATE_OPT, DEPTH_OPT, DEPTH_DIST_OPT,
+        REPEAT_OPT, MISSING_OPT, MISPLACED_OPT
+    };
+    static const option LONG_OPTIONS[] = {
+        {"output",      required_argument, nullptr, 'o'},
+        {"cpus",        required_argument, nullptr, 'c'},
+        {"tasks",       required_argument, nullptr, 't'},
+        {"duration",    required_argument, nullptr, 'd'},
+        {"switch-rate", required_argument, nullptr, SWITCH_RATE_OPT},
+        {"waking-rate", required_argument, nullptr, WAKING_RATE_OPT},
+        {"depth",       required_argument, nullptr, DEPTH_OPT},
+        {"depth-dist",  required_argument, nullptr, DEPTH_DIST_OPT},
+        {"repeat",      required_argument, nullptr, REPEAT_OPT},
+        {"missing",     required_argument, nullptr, MISSING_OPT},
+        {"misplaced",   required_argument, nullptr, MISPLACED_OPT},
+        {"seed",        required_argument, nullptr, 's'},
+        {"help",        no_argument,       nullptr, 'h'},
+        {nullptr,       0,                 nullptr, 0}
+    };
+
+    bool valid = true;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:c:t:d:s:h", LONG_OPTIONS,
+                              nullptr)) != -1) {
+        switch (opt) {
+            case 'o':
+                options.output = optarg;
+                break;
+            case 'c':
+                options.cpus = uint32_t(std::max(1, atoi(optarg)));
+                break;
+            case 't':
+                options.tasks = uint32_t(std::max(0, atoi(optarg)));
+                break;
+            case 'd':
+                options.duration = std::max(0.0, atof(optarg));
+                break;
+            case SWITCH_RATE_OPT:
+                options.switch_rate = std::max(0.0, atof(optarg));
+                break;
+            case WAKING_RATE_OPT:
+                options.waking_rate = std::max(0.0, atof(optarg));
+                break;
+            case DEPTH_OPT:
+                valid = sscanf(optarg, "%u:%u", &options.depth_min,
+                               &options.depth_max) == 2
+                        && options.depth_min <= options.depth_max
+                        && options.depth_max <= 256;
+                break;
+            case DEPTH_DIST_OPT:
+                if (strcmp(optarg, "uniform") == 0)
+                    options.depth_dist = _DepthDist::UNIFORM;
+                else if (strcmp(optarg, "geometric") == 0)
+                    options.depth_dist = _DepthDist::GEOMETRIC;
+                else
+                    valid = false;
+                break;
+            case REPEAT_OPT:
+                valid = _parse_ratio(optarg, options.repeat);
+                break;
+            case MISSING_OPT:
+                valid = _parse_ratio(optarg, options.missing);
+                break;
+            case MISPLACED_OPT:
+                valid = _parse_ratio(optarg, options.misplaced);
+                break;
+            case 's':
+                options.seed = strtoull(optarg, nullptr, 0);
+                break;
+            case 'h':
+                fputs(USAGE, stdout);
+                return EXIT_SUCCESS;
+            default:
+                valid = false;
+        }
+        if (!valid)
+            break;
+    }
+
+    if (!valid || optind != argc || options.output.empty()
+        || options.missing + options.misplaced > 1.0) {
+        fputs(USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+    return -1;
+}
+
+// Main
+
+/**
+ * @brief Generates the trace file and prints what it contains.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ *
+ * @returns `0` if the trace was written, `1` otherwise.
+ */
+int main(int argc, char** argv) {
+    _GenOptions options;
+    const int parse_status = _parse_args(argc, argv, options);
+    if (parse_status != -1)
+        return parse_status;
+
+    _GenCounts counts;
+    if (!_write_trace(options, counts))
+        return EXIT_FAILURE;
+
+    printf("%s: %u CPUs, %u tasks, %llu switches, %llu wakings, "
+           "%llu kernel stacks (%llu missing, %llu misplaced)\n",
+           options.output.c_str(), options.cpus, options.tasks,
+           (unsigned long long)counts.switches,
+           (unsigned long long)counts.wakings,
+           (unsigned long long)counts.stacks,
+           (unsigned long long)counts.missing,
+           (unsigned long long)counts.misplaced);
+    return EXIT_SUCCESS;
+}
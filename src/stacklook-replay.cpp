@@ -0,0 +1,400 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    stacklook-replay.cpp
+ * @brief   Headless replay of recorded draw calls of the plugin, for
+ *          comparing the plot performance of builds.
+ *
+ *          KernelShark records draw calls of a session when started with
+ *          the environment variable `SL_DRAW_RECORD` set to a file. The
+ *          replay opens the same traces, initializes the plugin for them
+ *          and, frame by frame, builds the histogram and the graphs the
+ *          calls were made for and calls the draw function again. A frame
+ *          is a run of calls with the same visible range and bins. Only
+ *          the draw function itself is timed and its allocations counted.
+*/
+
+// C
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+#include "libkshark-model.h"
+#include "libkshark-plugin.h"
+#include "KsPlugins.hpp"
+#include "KsPlotTools.hpp"
+
+// Plugin headers
+#include "stacklook.h"
+#include "SlDrawRecord.hpp"
+
+// Plugin's initializers, called directly, as the plugin is linked
+extern "C" {
+int KSHARK_PLOT_PLUGIN_INITIALIZER(struct kshark_data_stream* stream);
+int KSHARK_PLOT_PLUGIN_DEINITIALIZER(struct kshark_data_stream* stream);
+}
+
+// Static variables
+
+///
+/// @brief Usage text of the tool.
+static const char* USAGE =
+    "Usage: stacklook-replay [options] RECORDING\n"
+    "\n"
+    "Replays draw calls recorded with SL_DRAW_RECORD=RECORDING and prints\n"
+    "the time and allocations of each frame.\n"
+    "\n"
+    "Options:\n"
+    "  -t, --trace FILE    trace to replay on instead of the recorded one\n"
+    "                      (recordings of a single stream only)\n"
+    "  -r, --repeat N      replays of the recording, the best time of each\n"
+    "                      frame is printed (default: 1)\n"
+    "  -h, --help          print this help\n";
+
+///
+/// @brief Height of replayed graphs in pixels, as in KernelShark.
+static constexpr int GRAPH_HEIGHT = 45;
+
+///
+/// @brief Base of replayed graphs in pixels.
+static constexpr int GRAPH_BASE = 100;
+
+///
+/// @brief Number of C++ allocations made so far.
+static std::atomic<uint64_t> allocations{0};
+
+///
+/// @brief Bytes of C++ allocations made so far.
+static std::atomic<uint64_t> allocated_bytes{0};
+
+/**
+ * @brief Options of a run of the tool.
+ */
+struct _ReplayOptions {
+    ///
+    /// @brief Recording to replay.
+    std::string recording;
+    ///
+    /// @brief Trace replacing the recorded one, empty to keep it.
+    std::string trace;
+    ///
+    /// @brief Number of replays.
+    unsigned repeat{1};
+};
+
+/**
+ * @brief Calls of one frame and what they cost.
+ */
+struct _Frame {
+    ///
+    /// @brief Index of the frame's first call in the recording.
+    size_t first_call;
+    ///
+    /// @brief Number of the frame's calls.
+    size_t calls;
+    ///
+    /// @brief Best time of the frame's calls over all replays.
+    uint64_t best_ns{UINT64_MAX};
+    ///
+    /// @brief C++ allocations of the frame's calls in the last replay.
+    uint64_t allocations{0};
+    ///
+    /// @brief Bytes of the allocations.
+    uint64_t bytes{0};
+    ///
+    /// @brief Plot objects the calls made in the last replay.
+    uint64_t shapes{0};
+};
+
+// Allocation counting
+
+/**
+ * @brief Counting replacement of the global allocation function.
+ */
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{ return operator new(size); }
+
+void operator delete(void* memory) noexcept
+{ free(memory); }
+
+void operator delete[](void* memory) noexcept
+{ free(memory); }
+
+void operator delete(void* memory, size_t) noexcept
+{ free(memory); }
+
+void operator delete[](void* memory, size_t) noexcept
+{ free(memory); }
+
+// Static functions
+
+/**
+ * @brief Splits calls into frames - runs of calls with the same visible
+ * range and number of bins.
+ *
+ * @param calls: recorded calls
+ *
+ * @returns The frames in the order of the calls.
+ */
+static std::vector<_Frame> _split_frames(const std::vector<SlDrawCall>& calls) {
+    std::vector<_Frame> frames;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        const bool same = !frames.empty()
+            && calls[i - 1].min == calls[i].min
+            && calls[i - 1].max == calls[i].max
+            && calls[i - 1].n_bins == calls[i].n_bins;
+        if (same)
+            ++frames.back().calls;
+        else
+            frames.push_back({i, 1});
+    }
+    return frames;
+}
+
+/**
+ * @brief Replays the calls of a frame once, with the histogram already
+ * set to the frame's range.
+ *
+ * @param calls: recorded calls
+ * @param frame: the frame, its costs are updated
+ * @param histo: histogram of the frame
+ * @param streams: recorded stream identifiers to the replayed ones
+ */
+static void _replay_frame(const std::vector<SlDrawCall>& calls, _Frame& frame,
+                          kshark_trace_histo* histo,
+                          const std::map<int32_t, int>& streams) {
+    KsPlot::ColorTable colors;
+    uint64_t total_ns = 0;
+    frame.allocations = frame.bytes = frame.shapes = 0;
+
+    for (size_t i = frame.first_call; i < frame.first_call + frame.calls; ++i) {
+        const SlDrawCall& call = calls[i];
+        const int sd = streams.at(call.sd);
+
+        KsPlot::Graph graph(histo, &colors, &colors);
+        graph.setHeight(GRAPH_HEIGHT);
+        graph.setBase(GRAPH_BASE);
+        if (call.draw_action == KSHARK_CPU_DRAW)
+            graph.fillCPUGraph(sd, call.val);
+        else if (call.draw_action == KSHARK_TASK_DRAW)
+            graph.fillTaskGraph(sd, call.val);
+
+        KsPlot::PlotObjList shapes;
+        KsCppArgV argv;
+        argv._histo = histo;
+        argv._graph = &graph;
+        argv._shapes = &shapes;
+
+        const uint64_t allocs_before = allocations.load(std::memory_order_relaxed);
+        const uint64_t bytes_before = allocated_bytes.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+
+        draw_stacklook_objects(argv.toC(), sd, call.val, call.draw_action);
+
+        total_ns += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        frame.allocations += allocations.load(std::memory_order_relaxed) - allocs_before;
+        frame.bytes += allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+        for (KsPlot::PlotObject* shape : shapes) {
+            ++frame.shapes;
+            delete shape;
+        }
+    }
+
+    frame.best_ns = std::min(frame.best_ns, total_ns);
+}
+
+/**
+ * @brief Prints costs of all frames, then a summary.
+ *
+ * @param calls: recorded calls
+ * @param frames: replayed frames
+ */
+static void _print_frames(const std::vector<SlDrawCall>& calls,
+                          const std::vector<_Frame>& frames) {
+    printf("frame\tcalls\tbins\tmin\tmax\ttime_us\tallocs\tbytes\tshapes\n");
+
+    std::vector<uint64_t> times;
+    uint64_t total_ns = 0, total_allocs = 0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const _Frame& frame = frames[f];
+        const SlDrawCall& first = calls[frame.first_call];
+        printf("%zu\t%zu\t%d\t%lld\t%lld\t%.1f\t%llu\t%llu\t%llu\n", f, frame.calls,
+               first.n_bins, (long long)first.min, (long long)first.max,
+               double(frame.best_ns) / 1e3, (unsigned long long)frame.allocations,
+               (unsigned long long)frame.bytes, (unsigned long long)frame.shapes);
+        times.push_back(frame.best_ns);
+        total_ns += frame.best_ns;
+        total_allocs += frame.allocations;
+    }
+
+    if (times.empty())
+        return;
+    std::sort(times.begin(), times.end());
+    const auto percentile = [&times](double p) {
+        return double(times[size_t(p * double(times.size() - 1))]) / 1e3;
+    };
+    printf("Total: %zu frames, %zu calls, %.3f ms, frame p50 %.1f us, "
+           "p99 %.1f us, max %.1f us, %llu allocations\n", frames.size(),
+           calls.size(), double(total_ns) / 1e6, percentile(0.5),
+           percentile(0.99), double(times.back()) / 1e3,
+           (unsigned long long)total_allocs);
+}
+
+/**
+ * @brief Parses command-line arguments.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ * @param options: output location for parsed options
+ *
+ * @returns `-1` if the tool should run, otherwise the exit status the tool
+ * should exit with right away.
+ */
+static int _parse_args(int argc, char** argv, _ReplayOptions& options) {
+    static const option LONG_OPTIONS[] = {
+        {"trace",  required_argument, nullptr, 't'},
+        {"repeat", required_argument, nullptr, 'r'},
+        {"help",   no_argument,       nullptr, 'h'},
+        {nullptr,  0,                 nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "t:r:h", LONG_OPTIONS, nullptr)) != -1) {
+        switch (opt) {
+            case 't':
+                options.trace = optarg;
+                break;
+            case 'r':
+                options.repeat = unsigned(std::max(1, atoi(optarg)));
+                break;
+            case 'h':
+                fputs(USAGE, stdout);
+                return EXIT_SUCCESS;
+            default:
+                fputs(USAGE, stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        fputs(USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+    options.recording = argv[optind];
+    return -1;
+}
+
+// Main
+
+/**
+ * @brief Replays a recording and prints costs of its frames.
+ *
+ * @param argc: number of arguments
+ * @param argv: the arguments
+ *
+ * @returns `0` if the recording was replayed, `1` otherwise.
+ */
+int main(int argc, char** argv) {
+    _ReplayOptions options;
+    const int parse_status = _parse_args(argc, argv, options);
+    if (parse_status != -1)
+        return parse_status;
+
+    SlDrawRecording recording;
+    std::string error;
+    if (!read_draw_recording(options.recording, recording, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    if (!options.trace.empty() && recording.streams.size() > 1) {
+        fprintf(stderr, "%s: -t needs a recording of a single stream\n",
+                options.recording.c_str());
+        return EXIT_FAILURE;
+    }
+
+    kshark_context* kshark_ctx = nullptr;
+    if (!kshark_instance(&kshark_ctx))
+        return EXIT_FAILURE;
+
+    // Recorded stream -> replayed stream, plugin initialized before loading
+    std::map<int32_t, int> streams;
+    bool ok = true;
+    for (const auto& [recorded_sd, recorded_file] : recording.streams) {
+        const std::string& file = options.trace.empty() ? recorded_file
+                                                        : options.trace;
+        const int sd = kshark_open(kshark_ctx, file.c_str());
+        if (sd < 0) {
+            fprintf(stderr, "%s: can't open the trace\n", file.c_str());
+            ok = false;
+            break;
+        }
+        // Fails without the FreeSans font or without kernel stack events
+        kshark_data_stream* stream = kshark_get_data_stream(kshark_ctx, sd);
+        if (!KSHARK_PLOT_PLUGIN_INITIALIZER(stream)) {
+            fprintf(stderr, "%s: can't initialize Stacklook, is FreeSans installed"
+                    " and does the trace have ftrace/kernel_stack events?\n",
+                    file.c_str());
+            kshark_close(kshark_ctx, sd);
+            ok = false;
+            break;
+        }
+        streams.emplace(recorded_sd, sd);
+    }
+
+    kshark_entry** rows = nullptr;
+    const ssize_t rows_count = ok ? kshark_load_all_entries(kshark_ctx, &rows) : 0;
+
+    if (ok && rows_count > 0) {
+        std::vector<_Frame> frames = _split_frames(recording.calls);
+        kshark_trace_histo histo;
+        ksmodel_init(&histo);
+
+        for (unsigned r = 0; r < options.repeat; ++r) {
+            for (_Frame& frame : frames) {
+                const SlDrawCall& first = recording.calls[frame.first_call];
+                ksmodel_set_bining(&histo, first.n_bins, first.min, first.max);
+                ksmodel_fill(&histo, rows, size_t(rows_count));
+                _replay_frame(recording.calls, frame, &histo, streams);
+            }
+        }
+
+        ksmodel_clear(&histo);
+        _print_frames(recording.calls, frames);
+    } else if (ok) {
+        fprintf(stderr, "%s: no entries to replay on\n", options.recording.c_str());
+        ok = false;
+    }
+
+    for (ssize_t i = 0; i < rows_count; ++i) {
+        free(rows[i]);
+    }
+    free(rows);
+    for (const auto& [recorded_sd, sd] : streams) {
+        KSHARK_PLOT_PLUGIN_DEINITIALIZER(kshark_get_data_stream(kshark_ctx, sd));
+        kshark_close(kshark_ctx, sd);
+    }
+    kshark_free(kshark_ctx);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,591 @@
+/** Copyright (C) 2026, David Jaromír Šebánek <djsebofficial@gmail.com> **/
+
+/**
+ * @file    stacklook-test.cpp
+ * @brief   Checks of the Qt-free core library, run by CTest.
+ *
+ *          Without arguments, it checks parts which need no trace -
+ *          posting lists, Space-Saving summaries, latency histograms,
+ *          pending wakeups, stack frame parsing and kernel symbols. Given
+ *          a trace (e.g. one written by `stacklook-gen`), it checks range
+ *          counts and their sampling against the trace's events.
+ *
+ *          Each failed check is printed, the exit status tells whether
+ *          any failed.
+*/
+
+// C
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// KernelShark
+#include "libkshark.h"
+
+// Plugin
+#include "SlAssociation.hpp"
+#include "SlEventRegistry.hpp"
+#include "SlHeavyHitters.hpp"
+#include "SlKallsyms.hpp"
+#include "SlLatency.hpp"
+#include "SlPrevState.hpp"
+#include "SlRangeCounts.hpp"
+#include "SlStreamIndex.hpp"
+#include "SlSymbolIndex.hpp"
+
+// Static variables
+
+///
+/// @brief Usage text of the tool.
+static const char* USAGE =
+    "Usage: stacklook-test [TRACE.dat]\n"
+    "\n"
+    "Checks the core library. With a trace, checks range counts and\n"
+    "sampling on it instead.\n";
+
+///
+/// @brief Number of failed checks.
+static int failed_checks = 0;
+
+///
+/// @brief Checks a condition, printing it along with its line if it fails.
+#define SL_CHECK(cond) _check((cond), #cond, __LINE__)
+
+// Static functions
+
+/**
+ * @brief Records the result of one check.
+ *
+ * @param ok: whether the checked condition holds
+ * @param what: text of the condition
+ * @param line: line of the check
+ */
+static void _check(bool ok, const char* what, int line) {
+    if (ok)
+        return;
+
+    ++failed_checks;
+    fprintf(stderr, "stacklook-test.cpp:%d: check failed: %s\n", line, what);
+}
+
+/**
+ * @brief Checks that posting lists decode to the indices appended to
+ * them, with both long runs and scattered indices, and that runs are
+ * compressed.
+ */
+static void _test_posting_lists() {
+    std::mt19937 rng{7};
+    std::vector<uint32_t> expected;
+    SlPostingList list;
+
+    // Runs of varied lengths separated by gaps spanning 1-4 varint bytes
+    const uint32_t gaps[] = {1, 2, 127, 128, 16'383, 16'384, 2'097'152};
+    uint32_t next = 0;
+    for (int run = 0; run < 500; ++run) {
+        const uint32_t length = 1 + rng() % 50;
+        for (uint32_t i = 0; i < length; ++i) {
+            expected.push_back(next);
+            list.append(next++);
+        }
+        next += gaps[rng() % std::size(gaps)];
+    }
+    list.finish();
+
+    std::vector<uint32_t> decoded;
+    list.decode(decoded);
+    SL_CHECK(list.count() == expected.size());
+    SL_CHECK(decoded == expected);
+
+    // A single run of a million indices takes a few bytes
+    SlPostingList dense;
+    for (uint32_t i = 0; i < 1'000'000; ++i) {
+        dense.append(i + 5);
+    }
+    dense.finish();
+    // Decoding appends
+    decoded.clear();
+    dense.decode(decoded);
+    SL_CHECK(dense.count() == 1'000'000);
+    SL_CHECK(dense.byte_size() <= 8);
+    SL_CHECK(decoded.size() == 1'000'000 && decoded.front() == 5
+             && decoded.back() == 1'000'004);
+
+    SlPostingList empty;
+    empty.finish();
+    decoded.clear();
+    empty.decode(decoded);
+    SL_CHECK(empty.count() == 0 && decoded.empty());
+}
+
+/**
+ * @brief Checks Space-Saving's guarantees on a skewed stream - every
+ * counter overestimates its key by at most its error, and every key more
+ * frequent than the stream's length divided by the capacity is kept.
+ */
+static void _test_space_saving() {
+    constexpr size_t CAPACITY = 32;
+    constexpr size_t STREAM_LENGTH = 200'000;
+
+    std::mt19937 rng{11};
+    // Zipf-like, a few keys are heavy and a long tail isn't
+    std::vector<double> weights;
+    for (int k = 1; k <= 2000; ++k) {
+        weights.push_back(1.0 / k);
+    }
+    std::discrete_distribution<uint64_t> zipf{weights.begin(), weights.end()};
+
+    SlSpaceSaving summary{CAPACITY};
+    std::map<uint64_t, uint64_t> exact;
+    for (size_t i = 0; i < STREAM_LENGTH; ++i) {
+        const uint64_t key = zipf(rng);
+        summary.add(key, ssize_t(i));
+        ++exact[key];
+    }
+
+    SL_CHECK(summary.size() == CAPACITY);
+
+    uint64_t total = 0;
+    for (const SlHitterCounter& counter : summary.counters()) {
+        const uint64_t real = exact[counter.key];
+        SL_CHECK(counter.count >= real);
+        SL_CHECK(counter.count - counter.error <= real);
+        SL_CHECK(counter.error <= STREAM_LENGTH / CAPACITY);
+        total += counter.count;
+    }
+    // Counts always sum up to the stream's length
+    SL_CHECK(total == STREAM_LENGTH);
+
+    for (const auto& [key, count] : exact) {
+        if (count <= STREAM_LENGTH / CAPACITY)
+            continue;
+        const auto& counters = summary.counters();
+        SL_CHECK(std::any_of(counters.begin(), counters.end(),
+            [key](const SlHitterCounter& counter) { return counter.key == key; }));
+    }
+}
+
+/**
+ * @brief Checks latency percentiles against exact ones - reported values
+ * are never below the real value and at most one sub-bucket above it.
+ */
+static void _test_latency_histogram() {
+    SlLatencyHistogram empty;
+    SL_CHECK(empty.count() == 0 && empty.value_at_percentile(50) == 0);
+
+    // Values below the linear limit are exact
+    SlLatencyHistogram small;
+    for (uint64_t value = 0; value < SlLatencyHistogram::LINEAR_LIMIT; ++value) {
+        small.record(value);
+    }
+    SL_CHECK(small.value_at_percentile(0) == 0);
+    SL_CHECK(small.value_at_percentile(100) == SlLatencyHistogram::LINEAR_LIMIT - 1);
+
+    std::mt19937_64 rng{13};
+    std::lognormal_distribution<double> delays{10.0, 2.0};
+    std::vector<uint64_t> values;
+    SlLatencyHistogram histogram;
+    for (int i = 0; i < 100'000; ++i) {
+        const uint64_t value = uint64_t(delays(rng));
+        values.push_back(value);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    SL_CHECK(histogram.count() == values.size());
+    SL_CHECK(histogram.max() == values.back());
+    SL_CHECK(histogram.value_at_percentile(100) == values.back());
+
+    const double relative_error = 1.0 / double(1 << SlLatencyHistogram::SUB_BUCKET_BITS);
+    for (double percentile : {1.0, 10.0, 50.0, 90.0, 99.0, 99.9}) {
+        const size_t rank = size_t(std::max(1.0,
+            std::ceil(percentile / 100.0 * double(values.size())))) - 1;
+        const uint64_t real = values[rank];
+        const uint64_t reported = histogram.value_at_percentile(percentile);
+        SL_CHECK(reported >= real);
+        SL_CHECK(double(reported) <= double(real) * (1.0 + relative_error) + 1.0);
+    }
+
+    // Huge values share the last bucket, the maximum stays exact
+    SlLatencyHistogram huge;
+    huge.record(uint64_t(1) << 50);
+    huge.record(uint64_t(1) << 45);
+    SL_CHECK(huge.value_at_percentile(50) == (uint64_t(1) << 50));
+}
+
+/**
+ * @brief Checks that pending wakeups stay reachable after removals shift
+ * colliding entries back, against a map, in a table filled up to its
+ * capacity.
+ */
+static void _test_pending_wakeups() {
+    // Entries stand for wakings, only their addresses are compared
+    static kshark_entry entries[64];
+
+    SlPendingWakeups table{16};
+    std::map<int32_t, const kshark_entry*> expected;
+    std::mt19937 rng{17};
+
+    for (int step = 0; step < 20'000; ++step) {
+        // Few PIDs, so that slots collide and wrap around the table
+        const int32_t pid = int32_t(rng() % 40);
+        if (rng() % 2 == 0) {
+            const kshark_entry* waking = &entries[rng() % std::size(entries)];
+            const bool inserted = table.insert(pid, waking);
+            if (expected.count(pid) != 0) {
+                // The earlier waking is kept
+                SL_CHECK(inserted);
+            } else if (inserted) {
+                expected[pid] = waking;
+            } else {
+                // Only a full table drops wakeups, one slot stays free
+                SL_CHECK(table.size() == 15);
+            }
+        } else {
+            auto found = expected.find(pid);
+            const kshark_entry* taken = table.take(pid);
+            SL_CHECK(taken == ((found != expected.end()) ? found->second : nullptr));
+            if (found != expected.end())
+                expected.erase(found);
+        }
+        SL_CHECK(table.size() == expected.size());
+    }
+
+    for (const auto& [pid, waking] : expected) {
+        SL_CHECK(table.take(pid) == waking);
+    }
+    SL_CHECK(table.size() == 0);
+}
+
+/**
+ * @brief Checks splitting of kernel and user stack texts into frames.
+ */
+static void _test_stack_frames() {
+    std::vector<std::string_view> frames;
+
+    parse_stack_frames("<stack trace >\n"
+                       "=> __schedule+0x2a3/0x8b0\n"
+                       "=> schedule (ffffffff81a2b3c4)\n"
+                       "=>  do_nanosleep+0x5e/0x170 \n"
+                       "=> ffffffff81000abc\n", frames);
+    SL_CHECK((frames == std::vector<std::string_view>{
+        "__schedule", "schedule", "do_nanosleep", "ffffffff81000abc"}));
+
+    parse_stack_frames("<user stack trace>\n"
+                       "=> <00007f12345678ab>\n"
+                       "=> 0x00007f12345678ab\n"
+                       "=> libc.so.6[+0x2a1c9]\n"
+                       "=> ??\n"
+                       "=> <0000000000000000>\n", frames);
+    SL_CHECK((frames == std::vector<std::string_view>{
+        "7f12345678ab", "7f12345678ab", "libc.so.6[+0x2a1c9]"}));
+
+    parse_stack_frames(nullptr, frames);
+    SL_CHECK(frames.empty());
+}
+
+/**
+ * @brief Checks raw address parsing and symbol resolution from a small
+ * kallsyms file.
+ */
+static void _test_kallsyms() {
+    uint64_t address = 0;
+    SL_CHECK(parse_raw_address("ffffffff81000abc", address)
+             && address == 0xffffffff81000abcull);
+    SL_CHECK(parse_raw_address("DEADBEEF", address) && address == 0xdeadbeef);
+    // Short hexadecimal words are function names
+    SL_CHECK(!parse_raw_address("deadbee", address));
+    SL_CHECK(!parse_raw_address("ffffffff8100zabc", address));
+    SL_CHECK(!parse_raw_address("1ffffffff81000abc", address));
+
+    char path[] = "/tmp/stacklook-test-XXXXXX";
+    const int fd = mkstemp(path);
+    SL_CHECK(fd >= 0);
+    if (fd < 0)
+        return;
+
+    FILE* file = fdopen(fd, "w");
+    fputs("ffffffff81000000 T _stext\n"
+          "ffffffff81000000 T _text\n"
+          "ffffffff81000100 t do_one_thing\n"
+          "ffffffff81000200 D some_data\n"
+          "ffffffff81000300 W weak_thing\n"
+          "ffffffff81000400 t module_func\t[some_module]\n"
+          "garbage line\n", file);
+    fclose(file);
+
+    SlKallsyms kallsyms;
+    std::string error;
+    const bool loaded = kallsyms.load(path, error);
+    unlink(path);
+    SL_CHECK(loaded);
+    SL_CHECK(kallsyms.size() == 4);
+
+    // Aliases keep the first listed name, data symbols are skipped
+    SL_CHECK(kallsyms.resolve(0xffffffff81000000ull) == "_stext");
+    SL_CHECK(kallsyms.resolve(0xffffffff810000ffull) == "_stext");
+    SL_CHECK(kallsyms.resolve(0xffffffff81000100ull) == "do_one_thing");
+    SL_CHECK(kallsyms.resolve(0xffffffff81000250ull) == "do_one_thing");
+    SL_CHECK(kallsyms.resolve(0xffffffff81000300ull) == "weak_thing");
+    SL_CHECK(kallsyms.resolve(0xffffffff81000404ull) == "module_func");
+    // Below the first symbol and far past the last one stay raw
+    SL_CHECK(kallsyms.resolve(0xffffffff80ffffffull).empty());
+    SL_CHECK(kallsyms.resolve(0xffffffff90000000ull).empty());
+    SL_CHECK(kallsyms.resolve(0x7f12345678abull).empty());
+
+    SlKallsyms missing;
+    SL_CHECK(!missing.load("/nonexistent/kallsyms", error) && !error.empty());
+}
+
+/**
+ * @brief Counts events of one CPU or task by brute force, as range counts
+ * should.
+ *
+ * @param events: container of collected events
+ * @param registry: event registry, only enabled events are counted
+ * @param ids: event ids of the stream
+ * @param cpu: CPU of the events, `-1` for any
+ * @param pid: PID of the events, `-1` for any
+ * @param t0: start of the range, inclusive
+ * @param t1: end of the range, inclusive
+ *
+ * @returns Counts of the events by kind.
+ */
+static SlKindCounts _scan_counts(const kshark_data_container* events,
+                                 const SlEventRegistry& registry,
+                                 const SlEventIds& ids, int cpu, int pid,
+                                 int64_t t0, int64_t t1) {
+    SlKindCounts counts{};
+    for (ssize_t i = 0; i < events->size; ++i) {
+        const kshark_entry* entry = events->data[i]->entry;
+        const SlEventDescriptor* descriptor = registry.find(entry->event_id);
+        if (events->data[i]->field == -1 || descriptor == nullptr
+            || !descriptor->enabled || entry->ts < t0 || entry->ts > t1
+            || (cpu >= 0 && entry->cpu != cpu) || (pid >= 0 && entry->pid != pid))
+            continue;
+
+        SlCountKind kind = SlCountKind::OTHER_EVENT;
+        if (entry->event_id == ids.sswitch) {
+            kind = count_kind_of_state(get_switch_prev_state(entry)[0]);
+        } else if (entry->event_id == ids.swaking) {
+            kind = SlCountKind::WAKING;
+        }
+        ++counts[size_t(kind)];
+    }
+    return counts;
+}
+
+/**
+ * @brief Checks range counts and sampling against the collected events of
+ * a trace, with all events enabled and with wakings disabled.
+ *
+ * @param events: container of collected events with associated stacks
+ * @param stream: data stream of the trace
+ * @param ids: event ids of the stream
+ */
+static void _test_range_counts(const kshark_data_container* events,
+                               kshark_data_stream* stream,
+                               const SlEventIds& ids) {
+    const int64_t first_ts = events->data[0]->entry->ts;
+    const int64_t last_ts = events->data[events->size - 1]->entry->ts;
+
+    std::vector<SlEventDescriptor> descriptors{
+        {"sched/sched_switch", "", SlInfoDecoder::PREV_STATE, true},
+        {"sched/sched_waking", "", SlInfoDecoder::WAKEUP, true}
+    };
+    SlEventRegistry registry{stream, descriptors, 1};
+
+    SlRangeCounts counts;
+    counts.build(events, registry, ids.sswitch, ids.swaking);
+    SL_CHECK(counts.generation() == 1);
+
+    // Whole trace and a few random ranges of every CPU and some tasks
+    std::mt19937_64 rng{19};
+    std::uniform_int_distribution<int64_t> times{first_ts, last_ts};
+    std::vector<int> cpus;
+    std::vector<int> pids;
+    for (ssize_t i = 0; i < events->size; ++i) {
+        cpus.push_back(events->data[i]->entry->cpu);
+        pids.push_back(events->data[i]->entry->pid);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    std::sort(pids.begin(), pids.end());
+    pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+    pids.resize(std::min<size_t>(pids.size(), 8));
+
+    for (int range = 0; range < 8; ++range) {
+        int64_t t0 = (range == 0) ? first_ts : times(rng);
+        int64_t t1 = (range == 0) ? last_ts : times(rng);
+        if (t1 < t0)
+            std::swap(t0, t1);
+
+        for (int cpu : cpus) {
+            SL_CHECK(counts.count_cpu(int16_t(cpu), t0, t1)
+                     == _scan_counts(events, registry, ids, cpu, -1, t0, t1));
+        }
+        for (int pid : pids) {
+            SL_CHECK(counts.count_task(pid, t0, t1)
+                     == _scan_counts(events, registry, ids, -1, pid, t0, t1));
+        }
+    }
+
+    // Bins add up to the counts of their whole range
+    constexpr size_t N_BINS = 200;
+    const int64_t bin_size = std::max<int64_t>(1, (last_ts - first_ts) / N_BINS + 1);
+    std::vector<SlKindCounts> bins;
+    for (int cpu : cpus) {
+        counts.count_cpu_bins(int16_t(cpu), first_ts, bin_size, N_BINS, bins);
+        SlKindCounts summed{};
+        for (size_t b = 0; b < N_BINS; ++b) {
+            const int64_t bin_start = first_ts + int64_t(b) * bin_size;
+            SL_CHECK(bins[b] == counts.count_cpu(int16_t(cpu), bin_start,
+                                                 bin_start + bin_size - 1));
+            for (size_t k = 0; k < SL_COUNT_KINDS; ++k) {
+                summed[k] += bins[b][k];
+            }
+        }
+        SL_CHECK(summed == counts.count_cpu(int16_t(cpu), first_ts, last_ts));
+    }
+
+    // Sampling doesn't depend on earlier calls or on the counts' instance
+    constexpr size_t MAX_SAMPLES = 16;
+    const SlRangeCounts::accept_t accept_all = [] (uint32_t) { return true; };
+    const SlRangeCounts::accept_t accept_even = [] (uint32_t i) { return i % 2 == 0; };
+    SlRangeCounts rebuilt;
+    rebuilt.build(events, registry, ids.sswitch, ids.swaking);
+
+    std::vector<uint32_t> samples;
+    std::vector<uint32_t> again;
+    for (int cpu : cpus) {
+        counts.sample_cpu_bins(int16_t(cpu), first_ts, bin_size, N_BINS,
+                               MAX_SAMPLES, accept_all, samples);
+        SL_CHECK(!samples.empty() && samples.size() <= MAX_SAMPLES);
+        SL_CHECK(std::is_sorted(samples.begin(), samples.end()));
+        for (uint32_t event_idx : samples) {
+            SL_CHECK(events->data[event_idx]->entry->cpu == cpu);
+            SL_CHECK(events->data[event_idx]->field != -1);
+        }
+
+        counts.sample_cpu_bins(int16_t(cpu), first_ts + bin_size, bin_size,
+                               N_BINS / 2, MAX_SAMPLES, accept_even, again);
+        for (uint32_t event_idx : again) {
+            SL_CHECK(event_idx % 2 == 0);
+        }
+
+        rebuilt.sample_cpu_bins(int16_t(cpu), first_ts, bin_size, N_BINS,
+                                MAX_SAMPLES, accept_all, again);
+        SL_CHECK(again == samples);
+        counts.sample_cpu_bins(int16_t(cpu), first_ts, bin_size, N_BINS,
+                               MAX_SAMPLES, accept_all, again);
+        SL_CHECK(again == samples);
+    }
+
+    // Disabled events aren't counted
+    descriptors[1].enabled = false;
+    registry.update(descriptors, 2);
+    counts.build(events, registry, ids.sswitch, ids.swaking);
+    SL_CHECK(counts.generation() == 2);
+    for (int cpu : cpus) {
+        const SlKindCounts without_wakings = counts.count_cpu(int16_t(cpu),
+                                                              first_ts, last_ts);
+        SL_CHECK(without_wakings[size_t(SlCountKind::WAKING)] == 0);
+        SL_CHECK(without_wakings == _scan_counts(events, registry, ids, cpu, -1,
+                                                 first_ts, last_ts));
+    }
+}
+
+/**
+ * @brief Loads a trace, associates its kernel stacks and checks range
+ * counts on its collected events.
+ *
+ * @param trace: path of the trace file
+ *
+ * @returns True if the trace could be checked, false otherwise.
+ */
+static bool _test_trace(const char* trace) {
+    kshark_context* kshark_ctx = nullptr;
+    if (!kshark_instance(&kshark_ctx)) {
+        fprintf(stderr, "%s: couldn't initialize libkshark\n", trace);
+        return false;
+    }
+
+    const int sd = kshark_open(kshark_ctx, trace);
+    if (sd < 0) {
+        fprintf(stderr, "%s: couldn't open the trace\n", trace);
+        kshark_free(kshark_ctx);
+        return false;
+    }
+
+    kshark_entry** rows = nullptr;
+    const ssize_t rows_count = kshark_load_entries(kshark_ctx, sd, &rows);
+    kshark_data_stream* stream = kshark_get_data_stream(kshark_ctx, sd);
+    const SlEventIds ids = find_event_ids(stream, {"sched/sched_switch",
+                                                   "sched/sched_waking"});
+
+    kshark_data_container* collected = (rows_count > 0) ?
+        collect_events(rows, size_t(rows_count), ids) : nullptr;
+    const bool checkable = collected != nullptr && collected->size > 0
+        && ids.kstack >= 0 && associate_kstacks(collected, ids.kstack);
+
+    if (checkable) {
+        _test_range_counts(collected, stream, ids);
+    } else {
+        fprintf(stderr, "%s: no collected events with kernel stacks\n", trace);
+    }
+
+    if (collected != nullptr)
+        kshark_free_data_container(collected);
+    for (ssize_t i = 0; i < rows_count; ++i) {
+        free(rows[i]);
+    }
+    free(rows);
+    kshark_close(kshark_ctx, sd);
+    kshark_free(kshark_ctx);
+
+    return checkable;
+}
+
+// Global functions
+
+/**
+ * @brief Runs the checks.
+ *
+ * @param argc: number of arguments
+ * @param argv: arguments, an optional trace file
+ *
+ * @returns `EXIT_SUCCESS` if all checks passed, `EXIT_FAILURE` otherwise.
+ */
+int main(int argc, char** argv) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fputs(USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (argc == 2) {
+        if (!_test_trace(argv[1]))
+            return EXIT_FAILURE;
+    } else {
+        _test_posting_lists();
+        _test_space_saving();
+        _test_latency_histogram();
+        _test_pending_wakeups();
+        _test_stack_frames();
+        _test_kallsyms();
+    }
+
+    if (failed_checks > 0) {
+        fprintf(stderr, "%d checks failed\n", failed_checks);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
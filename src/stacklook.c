@@ -21,6 +21,7 @@
 
 // Plugin header
 #include "stacklook.h"
+#include "SlSelfTrace.h"
 
 // Static variables
 
@@ -40,18 +41,10 @@ static char* font_file = NULL;
 /// @brief Path to the bold font file.
 static char* bold_font_path = NULL;
 
-///
-/// @brief Integer ID of the `sched/sched_switch` event.
-static int sched_switch_id;
-
 ///
 /// @brief Integer ID of the `ftrace/kernel_stack` event.
 static int kstack_id;
 
-///
-/// @brief Integer ID of the `sched/sched_waking` event.
-static int sched_wake_id;
-
 // Header file definitions
 
 /**
@@ -98,11 +91,31 @@ static void _sl_free_ctx(struct plugin_stacklook_ctx* sl_ctx)
 		return;
     }
 
+    // Loading which nothing was drawn after is traced too
+    trace_loading(sl_ctx);
+
+    // Tasks may still work on the container, stop them before anything
+    free_task_group(sl_ctx->task_group);
+    sl_ctx->task_group = NULL;
+
+    // The index, latencies and counts refer to the container, free them first
+    free_stream_index(sl_ctx->stream_index);
+    sl_ctx->stream_index = NULL;
+    free_latency_stats(sl_ctx->latency_stats);
+    sl_ctx->latency_stats = NULL;
+    free_range_counts(sl_ctx->range_counts);
+    sl_ctx->range_counts = NULL;
+    free_event_registry(sl_ctx->event_registry);
+    sl_ctx->event_registry = NULL;
+    free_user_stacks(sl_ctx->user_stacks);
+    sl_ctx->user_stacks = NULL;
+
 	kshark_free_data_container(sl_ctx->collected_events);
 
     sl_ctx->sswitch_event_id = -1;
     sl_ctx->kstack_event_id = -1;
     sl_ctx->swaking_event_id = -1;
+    sl_ctx->ustack_event_id = -1;
 }
 
 /// @cond Doxygen_Suppress
@@ -121,8 +134,8 @@ KS_DEFINE_PLUGIN_CONTEXT(struct plugin_stacklook_ctx, _sl_free_ctx);
  * @param rec: Tep record structure holding data collected by trace-cmd
  * @param entry: KernelShark entry to be processed
  * 
- * @note Supported events are: `sched/sched_switch`,
- *                             `sched/sched_waking`.
+ * @note Supported events are those in the stream's event registry, the
+ * handler is registered for them only.
 */
 static void _select_events(struct kshark_data_stream* stream,
                            [[maybe_unused]] void* rec, struct kshark_entry* entry) {
@@ -132,17 +145,35 @@ static void _select_events(struct kshark_data_stream* stream,
     struct kshark_data_container* sl_ctx_collected_events = sl_ctx->collected_events;
     if (!sl_ctx_collected_events) return;
 
-    const bool is_supported_event = entry->event_id == sched_switch_id ||
-        entry->event_id == sched_wake_id;
-
-    if (is_supported_event) {
-        // -1 is nonsensical, but ensures the container isn't empty
-        // It will be later replaced by a pointer to the kernel stack entry
-        // if it is found.
-        kshark_data_container_append(sl_ctx_collected_events, entry, (int64_t)-1);
+    // -1 is nonsensical, but ensures the container isn't empty
+    // It will be later replaced by a pointer to the kernel stack entry
+    // if it is found.
+    kshark_data_container_append(sl_ctx_collected_events, entry, (int64_t)-1);
+
+    // A span per event would flood the ring, loading is traced as one
+    if (sl_self_trace_active) {
+        const uint64_t now = sl_self_trace_now();
+        if (!sl_ctx->load_trace_start)
+            sl_ctx->load_trace_start = now;
+        sl_ctx->load_trace_end = now;
     }
 }
 
+/**
+ * @brief Traces loading of the stream's events as one span, from the first
+ * to the last selected event, if any event was selected since the last call.
+ * 
+ * @param sl_ctx: plugin's context of the stream
+*/
+void trace_loading(struct plugin_stacklook_ctx* sl_ctx) {
+    if (!sl_ctx->load_trace_start)
+        return;
+
+    sl_self_trace_span("select_events", sl_ctx->load_trace_start,
+                       sl_ctx->load_trace_end);
+    sl_ctx->load_trace_start = 0;
+}
+
 /** 
  * @brief Initializes the plugin's context and registers handlers of the
  * plugin.
@@ -173,6 +204,12 @@ int KSHARK_PLOT_PLUGIN_INITIALIZER(struct kshark_data_stream* stream) {
 	}
 
     sl_ctx->collected_events = kshark_init_data_container();
+    sl_ctx->stream_index = NULL;
+    sl_ctx->latency_stats = NULL;
+    sl_ctx->range_counts = NULL;
+    sl_ctx->task_group = NULL;
+    sl_ctx->load_trace_start = 0;
+    sl_ctx->load_trace_end = 0;
 
     sl_ctx->kstacks_exist = false;
     sl_ctx->searched_for_kstacks = false;
@@ -180,15 +217,18 @@ int KSHARK_PLOT_PLUGIN_INITIALIZER(struct kshark_data_stream* stream) {
     // event ID might be present in the trace file.
     sl_ctx->kstack_event_id = kstack_id;
 
-    sched_switch_id = kshark_find_event_id(stream, "sched/sched_switch");
-    sl_ctx->sswitch_event_id = sched_switch_id;
-
+    sl_ctx->sswitch_event_id = kshark_find_event_id(stream, "sched/sched_switch");
     sl_ctx->swaking_event_id = kshark_find_event_id(stream, "sched/sched_waking");
-    sched_wake_id = sl_ctx->swaking_event_id;
-
-
-    kshark_register_event_handler(stream, sched_switch_id, _select_events);
-    kshark_register_event_handler(stream, sched_wake_id, _select_events);
+    // Optional, user stacks are shown along with kernel stacks if present
+    sl_ctx->ustack_event_id = kshark_find_event_id(stream, "ftrace/user_stack");
+
+    // Events to collect come from the configuration
+    sl_ctx->event_registry = make_event_registry(stream);
+    const size_t events_count = event_registry_size(sl_ctx->event_registry);
+    for (size_t i = 0; i < events_count; ++i) {
+        kshark_register_event_handler(stream,
+            event_registry_event_id(sl_ctx->event_registry, i), _select_events);
+    }
     kshark_register_draw_handler(stream, draw_stacklook_objects);
 
     return 1;
@@ -209,8 +249,11 @@ int KSHARK_PLOT_PLUGIN_DEINITIALIZER(struct kshark_data_stream* stream) {
     int retval = 0;
 
     if (sl_ctx) {
-        kshark_unregister_event_handler(stream, sched_switch_id, _select_events);
-        kshark_unregister_event_handler(stream, sched_wake_id, _select_events);
+        const size_t events_count = event_registry_size(sl_ctx->event_registry);
+        for (size_t i = 0; i < events_count; ++i) {
+            kshark_unregister_event_handler(stream,
+                event_registry_event_id(sl_ctx->event_registry, i), _select_events);
+        }
         kshark_unregister_draw_handler(stream, draw_stacklook_objects);
         retval = 1;
     }
@@ -218,6 +261,9 @@ int KSHARK_PLOT_PLUGIN_DEINITIALIZER(struct kshark_data_stream* stream) {
     if (stream->stream_id >= 0)
         __close(stream->stream_id);
 
+    // Spans of the closed stream are kept, even if KernelShark crashes later
+    sl_self_trace_flush();
+
     return retval;
 }
 
@@ -14,6 +14,8 @@
 
 // C
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // KernelShark
 #include "libkshark.h"
@@ -23,6 +25,14 @@
 extern "C" {
 #endif
 
+// Defined in C++, C only ever holds a pointer to it
+struct SlStreamIndex;
+struct SlLatencyStats;
+struct SlRangeCounts;
+struct SlTaskGroup;
+struct SlEventRegistry;
+struct SlUserStacks;
+
 ///
 /// @brief Chosen font size for plugin's font.
 #define FONT_SIZE 8
@@ -58,11 +68,62 @@ struct plugin_stacklook_ctx {
      * couplebreak/sched_waking[target] event.
     */
     int swaking_event_id;
+    /**
+     * @brief Numerical id of ftrace/user_stack event, -1 if the
+     * stream doesn't have it.
+    */
+    int ustack_event_id;
 
     /** 
      * @brief Collected switch or wakeup events.
     */
     struct kshark_data_container* collected_events;
+
+    /**
+     * @brief User stacks of the collected events, associated along with
+     * their kernel stacks. NULL if the stream has no user stack event.
+    */
+    struct SlUserStacks* user_stacks;
+
+    /**
+     * @brief Index of interned kernel stacks of the collected events.
+     * Built lazily, when a feature first needs contents of the stacks.
+    */
+    struct SlStreamIndex* stream_index;
+
+    /**
+     * @brief Scheduling latencies measured over the collected events.
+     * Measured lazily, when they are first shown.
+    */
+    struct SlLatencyStats* latency_stats;
+
+    /**
+     * @brief Per-CPU and per-task counts of collected events with
+     * kernel stacks in time ranges. Built lazily from the stream index.
+    */
+    struct SlRangeCounts* range_counts;
+
+    /**
+     * @brief Group of the stream's tasks on the shared thread pool.
+     * Created when the stream first submits a task.
+    */
+    struct SlTaskGroup* task_group;
+
+    /**
+     * @brief Descriptors of the collected events, indexed by their ids.
+     * Collection handlers are registered for exactly these events.
+    */
+    struct SlEventRegistry* event_registry;
+
+    /**
+     * @brief Self-tracing time of the first event selected during
+     * loading, 0 if none was selected since loading was last traced.
+    */
+    uint64_t load_trace_start;
+    /**
+     * @brief Self-tracing time of the last event selected during loading.
+    */
+    uint64_t load_trace_end;
 };
 
 // Some magic by KernelShark that makes it simpler to integrate the plugin.
@@ -72,14 +133,29 @@ KS_DECLARE_PLUGIN_CONTEXT_METHODS(struct plugin_stacklook_ctx)
 
 struct ksplot_font* get_font_ptr();
 struct ksplot_font* get_bold_font_ptr();
+void trace_loading(struct plugin_stacklook_ctx* sl_ctx);
 
 // Global functions, defined in C++
 
 const struct kshark_entry* get_kstack_entry(
     const struct kshark_entry* kstack_owner);
+const struct kshark_entry* get_ustack_entry(
+    const struct kshark_entry* kstack_entry);
 void draw_stacklook_objects(struct kshark_cpp_argv* argv_c, int sd,
                             int val, int draw_action);
 void* plugin_set_gui_ptr(void* gui_ptr);
+struct SlStreamIndex* get_stream_index(int sd);
+void free_stream_index(struct SlStreamIndex* index);
+struct SlLatencyStats* get_latency_stats(int sd);
+void free_latency_stats(struct SlLatencyStats* stats);
+struct SlRangeCounts* get_range_counts(int sd);
+void free_range_counts(struct SlRangeCounts* counts);
+void free_task_group(struct SlTaskGroup* group);
+struct SlEventRegistry* make_event_registry(struct kshark_data_stream* stream);
+void free_event_registry(struct SlEventRegistry* registry);
+void free_user_stacks(struct SlUserStacks* user_stacks);
+size_t event_registry_size(const struct SlEventRegistry* registry);
+int event_registry_event_id(const struct SlEventRegistry* registry, size_t i);
 
 #ifdef __cplusplus
 }